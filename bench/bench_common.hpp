@@ -0,0 +1,506 @@
+/*
+    * bench_common.hpp
+    *
+    * Shared harness for the config_manager benchmark targets.
+    * Times batches of operations and reports ns/op, allocations/op and latency percentiles.
+    *
+    * Key Components:
+    * - Global operator new/delete replacements that count allocations.
+    * - Runner class: Parses command line options, runs cases and prints the result table.
+    * - LatencyHistogram class: Per-operation latency recording for multi-threaded runs.
+    * - Helpers: do_not_optimize(), percentile(), peak_rss_bytes().
+    *
+    * Include this header from exactly one translation unit per benchmark executable,
+    * since it replaces the global allocation functions.
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Common options (every benchmark executable):
+  --filter <substring>   Only run cases whose name contains the substring.
+  --samples <n>          Number of timed batches per case (default 200).
+  --min-time-ms <n>      Minimum time spent per case (default 50).
+  --json <path>          Also write the results as a JSON array to <path>.
+  --list                 Print the case names and exit.
+*/
+
+// File: bench_common.hpp
+
+
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <nlohmann/json.hpp>
+
+namespace bench
+{
+    // Allocation counters, updated by the operator new replacements below
+    inline std::atomic<std::uint64_t> &allocation_count()
+    {
+        static std::atomic<std::uint64_t> count{0};
+        return count;
+    }
+
+    inline std::atomic<std::uint64_t> &allocated_bytes()
+    {
+        static std::atomic<std::uint64_t> bytes{0};
+        return bytes;
+    }
+
+    inline void *counted_alloc(std::size_t size)
+    {
+        allocation_count().fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes().fetch_add(size, std::memory_order_relaxed);
+        if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    // Prevent the optimizer from discarding a computed value
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    inline void clobber_memory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    // Nearest-rank percentile of an unsorted sample set (p in [0, 100])
+    inline double percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        std::sort(samples.begin(), samples.end());
+        std::size_t rank = static_cast<std::size_t>((p / 100.0) * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    }
+
+    // Peak resident set size of the process so far
+    inline std::uint64_t peak_rss_bytes()
+    {
+        struct rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // ru_maxrss is in KiB on Linux
+    }
+
+    // Log-linear latency histogram (16 sub-buckets per power of two), cheap enough to record every operation
+    class LatencyHistogram
+    {
+    public:
+        void record(std::uint64_t ns)
+        {
+            ++buckets_[bucket_for(ns)];
+            ++count_;
+            max_ = std::max(max_, ns);
+        }
+
+        void merge(const LatencyHistogram &other)
+        {
+            for (std::size_t i = 0; i < kBuckets; ++i)
+            {
+                buckets_[i] += other.buckets_[i];
+            }
+            count_ += other.count_;
+            max_ = std::max(max_, other.max_);
+        }
+
+        std::uint64_t count() const { return count_; }
+        double max() const { return static_cast<double>(max_); }
+
+        // Upper bound of the bucket holding the p-th percentile (p in [0, 100])
+        double percentile(double p) const
+        {
+            if (count_ == 0)
+            {
+                return 0.0;
+            }
+            std::uint64_t rank = static_cast<std::uint64_t>((p / 100.0) * static_cast<double>(count_ - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i)
+            {
+                seen += buckets_[i];
+                if (seen >= rank)
+                {
+                    return std::min(static_cast<double>(upper_bound(i)), static_cast<double>(max_));
+                }
+            }
+            return static_cast<double>(max_);
+        }
+
+    private:
+        static constexpr std::size_t kSubBits = 4;
+        static constexpr std::size_t kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+        static std::size_t bucket_for(std::uint64_t ns)
+        {
+            if (ns < (std::uint64_t{1} << kSubBits))
+            {
+                return static_cast<std::size_t>(ns);
+            }
+            std::size_t exponent = 63 - static_cast<std::size_t>(__builtin_clzll(ns));
+            std::size_t sub = static_cast<std::size_t>(ns >> (exponent - kSubBits)) & ((1u << kSubBits) - 1);
+            return ((exponent - kSubBits + 1) << kSubBits) + sub;
+        }
+
+        static std::uint64_t upper_bound(std::size_t bucket)
+        {
+            if (bucket < (std::size_t{1} << kSubBits))
+            {
+                return bucket;
+            }
+            std::size_t exponent = (bucket >> kSubBits) + kSubBits - 1;
+            std::uint64_t sub = bucket & ((1u << kSubBits) - 1);
+            return ((std::uint64_t{1} << kSubBits) + sub + 1) << (exponent - kSubBits);
+        }
+
+        std::vector<std::uint64_t> buckets_ = std::vector<std::uint64_t>(kBuckets, 0);
+        std::uint64_t count_ = 0;
+        std::uint64_t max_ = 0;
+    };
+
+    struct Result
+    {
+        std::string name;
+        std::uint64_t ops = 0;
+        double ns_per_op = 0.0;
+        double allocs_per_op = 0.0;
+        double bytes_per_op = 0.0;  // Heap bytes allocated per operation
+        double p50_ns = 0.0;
+        double p90_ns = 0.0;
+        double p99_ns = 0.0;
+        double p999_ns = 0.0;
+        double max_ns = 0.0;
+        double payload_bytes_per_op = 0.0; // Set by throughput cases; 0 when not meaningful
+        unsigned threads = 0;              // Set by multi-threaded cases; ns_per_op is then wall time / total ops
+        std::uint64_t peak_rss_bytes = 0;  // Set by cases that measure memory; 0 when not measured
+
+        nlohmann::json to_json() const
+        {
+            nlohmann::json j = {
+                {"name", name},
+                {"ops", ops},
+                {"ns_per_op", ns_per_op},
+                {"allocs_per_op", allocs_per_op},
+                {"alloc_bytes_per_op", bytes_per_op},
+                {"p50_ns", p50_ns},
+                {"p90_ns", p90_ns},
+                {"p99_ns", p99_ns},
+                {"p999_ns", p999_ns},
+                {"max_ns", max_ns}
+            };
+            if (payload_bytes_per_op > 0.0)
+            {
+                j["mb_per_s"] = megabytes_per_second();
+            }
+            if (peak_rss_bytes > 0)
+            {
+                j["peak_rss_bytes"] = peak_rss_bytes;
+            }
+            if (threads > 0)
+            {
+                j["threads"] = threads;
+                j["ops_per_s"] = ns_per_op > 0.0 ? 1e9 / ns_per_op : 0.0;
+            }
+            return j;
+        }
+
+        double megabytes_per_second() const
+        {
+            return ns_per_op > 0.0 ? (payload_bytes_per_op / ns_per_op) * 1e9 / (1024.0 * 1024.0) : 0.0;
+        }
+    };
+
+    class Runner
+    {
+    public:
+        Runner(int argc, char **argv)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                std::string arg = argv[i];
+                auto next = [&]() -> std::string {
+                    if (i + 1 >= argc)
+                    {
+                        throw std::invalid_argument("Missing value for " + arg);
+                    }
+                    return argv[++i];
+                };
+                if (arg == "--filter")
+                {
+                    filter_ = next();
+                }
+                else if (arg == "--samples")
+                {
+                    samples_ = std::max<std::size_t>(1, std::stoul(next()));
+                }
+                else if (arg == "--min-time-ms")
+                {
+                    min_time_ = std::chrono::milliseconds(std::stoul(next()));
+                }
+                else if (arg == "--json")
+                {
+                    json_path_ = next();
+                }
+                else if (arg == "--list")
+                {
+                    list_only_ = true;
+                }
+                else
+                {
+                    extra_args_.push_back(arg);
+                }
+            }
+        }
+
+        ~Runner()
+        {
+            if (!json_path_.empty())
+            {
+                nlohmann::json j = nlohmann::json::array();
+                for (const auto &result : results_)
+                {
+                    j.push_back(result.to_json());
+                }
+                std::ofstream out(json_path_);
+                out << j.dump(2) << "\n";
+            }
+        }
+
+        // Arguments not consumed by the common options, for benchmark specific flags
+        const std::vector<std::string> &extra_args() const { return extra_args_; }
+
+        bool enabled(const std::string &name) const
+        {
+            return filter_.empty() || name.find(filter_) != std::string::npos;
+        }
+
+        bool list_only() const { return list_only_; }
+
+        // Runs `op` repeatedly; each call performs one operation. Returns the recorded result.
+        // `setup` runs before each timed batch, outside of the timing and allocation counts.
+        template <typename Op>
+        const Result *run(const std::string &name, Op &&op,
+                          const std::function<void()> &setup = nullptr, double payload_bytes = 0.0)
+        {
+            if (!enabled(name))
+            {
+                return nullptr;
+            }
+            if (list_only_)
+            {
+                std::cout << name << "\n";
+                return nullptr;
+            }
+
+            // Calibrate the batch size so a batch takes roughly min_time / samples
+            std::size_t batch = 1;
+            auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(min_time_) / samples_;
+            for (;;)
+            {
+                if (setup)
+                {
+                    setup();
+                }
+                auto start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < batch; ++i)
+                {
+                    op();
+                }
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                if (elapsed >= target || batch >= (std::size_t{1} << 20))
+                {
+                    break;
+                }
+                batch *= 2;
+            }
+
+            std::vector<double> per_op;
+            per_op.reserve(samples_);
+            double total_ns = 0.0;
+            std::uint64_t allocs = 0;
+            std::uint64_t bytes = 0;
+            for (std::size_t s = 0; s < samples_; ++s)
+            {
+                if (setup)
+                {
+                    setup();
+                }
+                std::uint64_t allocs_before = allocation_count().load(std::memory_order_relaxed);
+                std::uint64_t bytes_before = allocated_bytes().load(std::memory_order_relaxed);
+                auto start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < batch; ++i)
+                {
+                    op();
+                }
+                clobber_memory();
+                auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                allocs += allocation_count().load(std::memory_order_relaxed) - allocs_before;
+                bytes += allocated_bytes().load(std::memory_order_relaxed) - bytes_before;
+                per_op.push_back(elapsed / static_cast<double>(batch));
+                total_ns += elapsed;
+            }
+
+            Result result;
+            result.name = name;
+            result.ops = static_cast<std::uint64_t>(batch) * samples_;
+            result.ns_per_op = total_ns / static_cast<double>(result.ops);
+            result.allocs_per_op = static_cast<double>(allocs) / static_cast<double>(result.ops);
+            result.bytes_per_op = static_cast<double>(bytes) / static_cast<double>(result.ops);
+            result.p50_ns = percentile(per_op, 50.0);
+            result.p90_ns = percentile(per_op, 90.0);
+            result.p99_ns = percentile(per_op, 99.0);
+            result.p999_ns = percentile(per_op, 99.9);
+            result.max_ns = percentile(per_op, 100.0);
+            result.payload_bytes_per_op = payload_bytes;
+            record(result);
+            return &results_.back();
+        }
+
+        // Records a result measured by the caller (e.g. multi-threaded runs)
+        void record(const Result &result)
+        {
+            if (results_.empty())
+            {
+                print_header();
+            }
+            results_.push_back(result);
+            print_row(result);
+        }
+
+    private:
+        static void print_header()
+        {
+            std::cout << std::left << std::setw(44) << "benchmark"
+                      << std::right << std::setw(15) << "ns/op"
+                      << std::setw(12) << "allocs/op"
+                      << std::setw(13) << "bytes/op"
+                      << std::setw(13) << "p50"
+                      << std::setw(13) << "p90"
+                      << std::setw(13) << "p99"
+                      << std::setw(13) << "p99.9"
+                      << std::setw(10) << "MB/s"
+                      << std::setw(10) << "RSS MB" << "\n";
+            std::cout << std::string(156, '-') << "\n";
+        }
+
+        static void print_row(const Result &r)
+        {
+            std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed
+                      << std::setw(15) << std::setprecision(1) << r.ns_per_op
+                      << std::setw(12) << std::setprecision(2) << r.allocs_per_op
+                      << std::setw(13) << std::setprecision(0) << r.bytes_per_op
+                      << std::setw(13) << r.p50_ns
+                      << std::setw(13) << r.p90_ns
+                      << std::setw(13) << r.p99_ns
+                      << std::setw(13) << r.p999_ns;
+            if (r.payload_bytes_per_op > 0.0)
+            {
+                std::cout << std::setw(10) << std::setprecision(1) << r.megabytes_per_second();
+            }
+            else
+            {
+                std::cout << std::setw(10) << "-";
+            }
+            if (r.peak_rss_bytes > 0)
+            {
+                std::cout << std::setw(10) << std::setprecision(1) << static_cast<double>(r.peak_rss_bytes) / (1024.0 * 1024.0);
+            }
+            else
+            {
+                std::cout << std::setw(10) << "-";
+            }
+            std::cout << "\n" << std::defaultfloat;
+        }
+
+        std::string filter_;
+        std::size_t samples_ = 200;
+        std::chrono::milliseconds min_time_{50};
+        std::string json_path_;
+        bool list_only_ = false;
+        std::vector<std::string> extra_args_;
+        std::vector<Result> results_;
+    };
+
+} // namespace bench
+
+// Global allocation function replacements used for the allocations/op column
+void *operator new(std::size_t size)
+{
+    return bench::counted_alloc(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return bench::counted_alloc(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return bench::counted_alloc(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return bench::counted_alloc(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#endif // BENCH_COMMON_HPP
@@ -0,0 +1,407 @@
+/*  File: bench_config.cpp
+
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Microbenchmarks for the Config core API: get, set, exists, inspect, update_multiple,
+    * get_all, listener dispatch, typed reads (get_duration, get_bytes), columnar array reads and
+    * copying versus moving set/emplace/update_multiple, bulk inserts with and without reserve(),
+    * over several key counts and value shapes.
+    * Reports ns/op, allocations/op and per-batch latency percentiles.
+    *
+    * Usage: bench_config [--keys 16,1024,65536] [common options, see bench_common.hpp]
+    *
+*/
+
+#include "../include/configuration.hpp"
+#include "../include/config_flags.hpp"
+#include "bench_common.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using config::Config;
+
+    struct ValueShape
+    {
+        std::string name;
+        nlohmann::json value;
+    };
+
+    std::vector<ValueShape> value_shapes()
+    {
+        nlohmann::json array = nlohmann::json::array();
+        for (int i = 0; i < 64; ++i)
+        {
+            array.push_back(i * 7);
+        }
+        return {
+            {"int", 42},
+            {"str16", std::string(16, 'x')},
+            {"str256", std::string(256, 'x')},
+            {"object", {{"host", "db.internal"}, {"port", 5432}, {"tls", true}, {"timeout", "250ms"}, {"pool", {{"min", 1}, {"max", 32}}}}},
+            {"array64", array}
+        };
+    }
+
+    std::vector<std::size_t> parse_key_counts(const std::vector<std::string> &args)
+    {
+        std::vector<std::size_t> counts = {16, 1024, 65536};
+        for (std::size_t i = 0; i + 1 < args.size(); ++i)
+        {
+            if (args[i] == "--keys")
+            {
+                counts.clear();
+                std::stringstream ss(args[i + 1]);
+                std::string item;
+                while (std::getline(ss, item, ','))
+                {
+                    counts.push_back(std::stoul(item));
+                }
+            }
+        }
+        return counts;
+    }
+
+    std::vector<std::string> make_keys(std::size_t count)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            keys.push_back("service.section" + std::to_string(i % 97) + ".key" + std::to_string(i));
+        }
+        return keys;
+    }
+
+    void fill(Config &config, const std::vector<std::string> &keys, const nlohmann::json &value)
+    {
+        for (const auto &key : keys)
+        {
+            config.set(key, value);
+        }
+    }
+
+    void run_key_benchmarks(bench::Runner &runner, std::size_t key_count, const ValueShape &shape)
+    {
+        const std::string suffix = "/" + std::to_string(key_count) + "/" + shape.name;
+        const std::vector<std::string> keys = make_keys(key_count);
+        Config config;
+        fill(config, keys, shape.value);
+
+        std::size_t i = 0;
+        runner.run("get" + suffix, [&] {
+            bench::do_not_optimize(config.get(keys[i++ % keys.size()]));
+        });
+
+        runner.run("set" + suffix, [&] {
+            config.set(keys[i++ % keys.size()], shape.value);
+        });
+
+        runner.run("exists/hit" + suffix, [&] {
+            bench::do_not_optimize(config.exists(keys[i++ % keys.size()]));
+        });
+
+        std::vector<std::string> inspect_keys(keys.begin(), keys.begin() + std::min<std::size_t>(8, keys.size()));
+        runner.run("inspect8" + suffix, [&] {
+            bench::do_not_optimize(config.inspect(inspect_keys));
+        });
+
+        std::unordered_map<std::string, nlohmann::json> batch;
+        for (std::size_t k = 0; k < std::min<std::size_t>(8, keys.size()); ++k)
+        {
+            batch[keys[k]] = shape.value;
+        }
+        runner.run("update_multiple8" + suffix, [&] {
+            config.update_multiple(batch);
+        });
+
+        if (key_count <= 1024)
+        {
+            runner.run("get_all" + suffix, [&] {
+                bench::do_not_optimize(config.get_all());
+            });
+        }
+    }
+
+    void run_shape_independent_benchmarks(bench::Runner &runner, std::size_t key_count)
+    {
+        const std::string suffix = "/" + std::to_string(key_count);
+        const std::vector<std::string> keys = make_keys(key_count);
+        Config config;
+        fill(config, keys, 1);
+
+        std::size_t i = 0;
+        runner.run("exists/miss" + suffix, [&] {
+            bench::do_not_optimize(config.exists("missing.key" + std::to_string(i++ & 7)));
+        });
+
+        runner.run("get/miss" + suffix, [&] {
+            try
+            {
+                bench::do_not_optimize(config.get("missing.key"));
+            }
+            catch (const std::invalid_argument &)
+            {
+            }
+        });
+
+        // One of 97 sections: filtering a get_all() copy versus the ordered key index
+        const std::string prefix = "service.section7.";
+        runner.run("prefix/get_all_filter" + suffix, [&] {
+            std::vector<std::string> matches;
+            for (const auto &[key, value] : config.get_all())
+            {
+                if (key.compare(0, prefix.size(), prefix) == 0)
+                {
+                    matches.push_back(key);
+                }
+            }
+            bench::do_not_optimize(matches);
+        });
+        runner.run("prefix/keys_with_prefix" + suffix, [&] {
+            bench::do_not_optimize(config.keys_with_prefix(prefix));
+        });
+        const config::KeyMatcher glob = config::KeyMatcher::glob("service.section*.key*7");
+        const std::regex pattern("^service\\.section\\d+\\.key\\d*7$");
+        runner.run("find/get_all_regex" + suffix, [&] {
+            std::vector<std::string> matches;
+            for (const auto &[key, value] : config.get_all())
+            {
+                if (std::regex_match(key, pattern))
+                {
+                    matches.push_back(key);
+                }
+            }
+            bench::do_not_optimize(matches);
+        });
+        runner.run("find/find_keys_glob" + suffix, [&] {
+            bench::do_not_optimize(config.find_keys(glob));
+        });
+        runner.run("set/indexed" + suffix, [&] {
+            config.set(keys[i++ % keys.size()], 2);
+        });
+    }
+
+    // Typed reads: parsing the string on every call versus the cached get_duration/get_bytes
+    void run_typed_read_benchmarks(bench::Runner &runner)
+    {
+        Config config;
+        config.set("timeout", "250ms");
+        config.set("cache_size", "64MiB");
+
+        runner.run("typed/duration/parse_each_call", [&] {
+            bench::do_not_optimize(config::parse_duration(config.get("timeout").get<std::string>()));
+        });
+        runner.run("typed/duration/get_duration", [&] {
+            bench::do_not_optimize(config.get_duration("timeout"));
+        });
+        runner.run("typed/bytes/parse_each_call", [&] {
+            bench::do_not_optimize(config::parse_byte_size(config.get("cache_size").get<std::string>()));
+        });
+        runner.run("typed/bytes/get_bytes", [&] {
+            bench::do_not_optimize(config.get_bytes("cache_size"));
+        });
+    }
+
+    // Reading a 100k element numeric table as a json array versus a columnar view
+    void run_array_benchmarks(bench::Runner &runner)
+    {
+        std::vector<double> table(100000, 0.25);
+        Config config;
+        config.set("table/json", nlohmann::json(table));
+        config.set_array("table/columnar", table);
+
+        runner.run("array/get/100000", [&] {
+            bench::do_not_optimize(config.get("table/json"));
+        });
+        runner.run("array/get_array/100000", [&] {
+            bench::do_not_optimize(config.get_array<double>("table/columnar"));
+        });
+    }
+
+    // A deep lookup inside a 256-route object: get() plus a manual walk versus a compiled, cached query
+    void run_query_benchmarks(bench::Runner &runner)
+    {
+        nlohmann::json routes = nlohmann::json::array();
+        for (int i = 0; i < 256; ++i)
+        {
+            routes.push_back({{"name", "route" + std::to_string(i)}, {"backends", {{{"host", "10.0.0.1"}, {"port", 8000 + i}}}}});
+        }
+        Config config;
+        config.set("routes", routes);
+        const config::CompiledQuery port("/routes/200/backends/0/port");
+        const config::CompiledQuery all_ports("$.routes[*].backends[*].port");
+
+        runner.run("query/get_and_walk", [&] {
+            bench::do_not_optimize(config.get("routes")[200]["backends"][0]["port"]);
+        });
+        runner.run("query/pointer", [&] {
+            bench::do_not_optimize(config.query(port));
+        });
+        runner.run("query/wildcard/256", [&] {
+            bench::do_not_optimize(config.query(all_ports));
+        });
+    }
+
+    // Memoized ${key} expansion, and the cost of re-expanding after a referenced key changes
+    void run_interpolation_benchmarks(bench::Runner &runner)
+    {
+        Config config;
+        config.set("db_host", "db.internal");
+        config.set("db_port", 5432);
+        config.set("db_url", "postgres://${db_host}:${db_port}/app?sslmode=require");
+
+        runner.run("interpolate/get_interpolated", [&] {
+            bench::do_not_optimize(config.get_interpolated("db_url"));
+        });
+        int port = 5432;
+        runner.run("interpolate/set_then_get_interpolated", [&] {
+            config.set("db_port", ++port);
+            bench::do_not_optimize(config.get_interpolated("db_url"));
+        });
+    }
+
+    // Flag evaluation on the request path: by handle, by name, and with rules plus a rollout
+    void run_flag_benchmarks(bench::Runner &runner)
+    {
+        Config config;
+        config.set("feature_flags", nlohmann::json::parse(R"({
+            "simple": true,
+            "checkout_v2": {
+                "rules": [
+                    {"attribute": "tenant", "in": ["acme", "globex", "initech"], "serve": true},
+                    {"attribute": "country", "not_in": ["US", "CA"], "rollout": 50}
+                ],
+                "rollout": 10
+            }
+        })"));
+        auto flags = config::FeatureFlags::bind(config);
+        const config::FlagHandle simple = flags->handle("simple");
+        const config::FlagHandle checkout = flags->handle("checkout_v2");
+        const config::FlagAttribute attributes[] = {{"tenant", "umbrella"}, {"country", "US"}};
+        const std::string user = "user-0123456789";
+
+        runner.run("flags/handle/simple", [&] {
+            bench::do_not_optimize(flags->enabled(simple, config::FlagContext(user)));
+        });
+        runner.run("flags/name/simple", [&] {
+            bench::do_not_optimize(flags->enabled("simple", config::FlagContext(user)));
+        });
+        runner.run("flags/handle/rules_rollout", [&] {
+            bench::do_not_optimize(flags->enabled(checkout, config::FlagContext(user, attributes)));
+        });
+    }
+
+    // Filling a fresh instance key by key, letting the table grow versus reserving it first
+    void run_bulk_insert_benchmarks(bench::Runner &runner, std::size_t key_count)
+    {
+        const std::vector<std::string> keys = make_keys(key_count);
+        const std::string suffix = "/" + std::to_string(key_count);
+        runner.run("bulk_set/grow" + suffix, [&] {
+            Config config;
+            for (const auto &key : keys)
+            {
+                config.set(key, 1);
+            }
+        });
+        runner.run("bulk_set/reserved" + suffix, [&] {
+            Config config;
+            config.reserve(keys.size());
+            for (const auto &key : keys)
+            {
+                config.set(key, 1);
+            }
+        });
+    }
+
+    // Storing a freshly built value: lvalue set copies it again, rvalue set and emplace move it in
+    void run_move_benchmarks(bench::Runner &runner)
+    {
+        nlohmann::json proto = nlohmann::json::object();
+        for (int i = 0; i < 32; ++i)
+        {
+            proto["route_" + std::to_string(i)] = {{"host", "backend-" + std::to_string(i) + ".internal.example.com"}, {"weight", i}};
+        }
+        Config config;
+
+        runner.run("move/set_copy/object", [&] {
+            nlohmann::json value = proto;
+            config.set("routes", value);
+        });
+        runner.run("move/set_move/object", [&] {
+            nlohmann::json value = proto;
+            config.set("routes", std::move(value));
+        });
+        const std::string pem(4096, 'p');
+        runner.run("move/emplace/string4k", [&] {
+            std::string value = pem;
+            config.emplace("certificate", std::move(value));
+        });
+
+        std::unordered_map<std::string, nlohmann::json> batch;
+        for (int i = 0; i < 16; ++i)
+        {
+            batch["section_" + std::to_string(i)] = proto;
+        }
+        runner.run("move/update_multiple_copy/16", [&] {
+            std::unordered_map<std::string, nlohmann::json> values = batch;
+            config.update_multiple(values);
+        });
+        runner.run("move/update_multiple_move/16", [&] {
+            std::unordered_map<std::string, nlohmann::json> values = batch;
+            config.update_multiple(std::move(values));
+        });
+    }
+
+    void run_listener_benchmarks(bench::Runner &runner)
+    {
+        const std::vector<std::string> keys = make_keys(1024);
+        for (std::size_t listener_count : {0, 1, 8, 32})
+        {
+            Config config;
+            fill(config, keys, 1);
+            std::uint64_t calls = 0;
+            for (std::size_t l = 0; l < listener_count; ++l)
+            {
+                config.add_change_listener([&calls](const std::string &, const nlohmann::json &) { ++calls; });
+            }
+            std::size_t i = 0;
+            runner.run("set_with_listeners/" + std::to_string(listener_count), [&] {
+                config.set(keys[i++ % keys.size()], 7);
+            });
+            bench::do_not_optimize(calls);
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+    std::vector<std::size_t> key_counts = parse_key_counts(runner.extra_args());
+
+    for (std::size_t key_count : key_counts)
+    {
+        for (const auto &shape : value_shapes())
+        {
+            run_key_benchmarks(runner, key_count, shape);
+        }
+        run_shape_independent_benchmarks(runner, key_count);
+        run_bulk_insert_benchmarks(runner, key_count);
+    }
+    run_listener_benchmarks(runner);
+    run_typed_read_benchmarks(runner);
+    run_array_benchmarks(runner);
+    run_query_benchmarks(runner);
+    run_interpolation_benchmarks(runner);
+    run_flag_benchmarks(runner);
+    run_move_benchmarks(runner);
+    return 0;
+}
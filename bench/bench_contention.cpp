@@ -0,0 +1,291 @@
+/*  File: bench_contention.cpp
+
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Multi-threaded contention and scaling benchmark.
+    * Runs mixed get/set workloads against one shared storage instance from 1 to N threads,
+    * for several read:write ratios and key distributions (uniform or Zipfian), and reports
+    * throughput and per-operation tail latency for each thread count.
+    *
+    * The workload only uses the IConfigStorage interface, so an alternative storage backend
+    * can be measured by changing make_storage().
+    *
+    * Usage: bench_contention [--threads 1,2,4,8] [--ratios 100:0,99:1,90:10] [--skew uniform,zipf]
+    *                         [--keys 10000] [--zipf-theta 0.99] [--duration-ms 250]
+    *                         [common options, see bench_common.hpp]
+    *
+*/
+
+#include "../include/configuration.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        std::vector<unsigned> threads;
+        std::vector<unsigned> read_percents = {100, 99, 90};
+        std::vector<std::string> skews = {"uniform", "zipf"};
+        std::size_t keys = 10000;
+        double zipf_theta = 0.99;
+        std::chrono::milliseconds duration{250};
+    };
+
+    std::vector<std::string> split(const std::string &list)
+    {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    Options parse_options(const std::vector<std::string> &args)
+    {
+        Options options;
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 1; t <= std::max(4u, hw); t *= 2)
+        {
+            options.threads.push_back(t);
+        }
+        for (std::size_t i = 0; i + 1 < args.size(); ++i)
+        {
+            const std::string &value = args[i + 1];
+            if (args[i] == "--threads")
+            {
+                options.threads.clear();
+                for (const auto &item : split(value))
+                {
+                    options.threads.push_back(static_cast<unsigned>(std::stoul(item)));
+                }
+            }
+            else if (args[i] == "--ratios")
+            {
+                options.read_percents.clear();
+                for (const auto &item : split(value))
+                {
+                    options.read_percents.push_back(static_cast<unsigned>(std::stoul(item.substr(0, item.find(':')))));
+                }
+            }
+            else if (args[i] == "--skew")
+            {
+                options.skews = split(value);
+            }
+            else if (args[i] == "--keys")
+            {
+                options.keys = std::max<std::size_t>(1, std::stoul(value));
+            }
+            else if (args[i] == "--zipf-theta")
+            {
+                options.zipf_theta = std::stod(value);
+            }
+            else if (args[i] == "--duration-ms")
+            {
+                options.duration = std::chrono::milliseconds(std::stoul(value));
+            }
+        }
+        return options;
+    }
+
+    // xorshift64*: small, fast and good enough for picking keys
+    class Rng
+    {
+    public:
+        explicit Rng(std::uint64_t seed) : state_(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+        std::uint64_t next()
+        {
+            state_ ^= state_ >> 12;
+            state_ ^= state_ << 25;
+            state_ ^= state_ >> 27;
+            return state_ * 0x2545F4914F6CDD1Dull;
+        }
+        double next_unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    // Key index sampler: uniform, or Zipfian via inverse CDF lookup
+    class KeySampler
+    {
+    public:
+        KeySampler(std::size_t keys, bool zipf, double theta) : keys_(keys), zipf_(zipf)
+        {
+            if (zipf_)
+            {
+                cdf_.reserve(keys);
+                double sum = 0.0;
+                for (std::size_t i = 1; i <= keys; ++i)
+                {
+                    sum += 1.0 / std::pow(static_cast<double>(i), theta);
+                    cdf_.push_back(sum);
+                }
+                for (auto &c : cdf_)
+                {
+                    c /= sum;
+                }
+            }
+        }
+
+        std::size_t next(Rng &rng) const
+        {
+            if (!zipf_)
+            {
+                return static_cast<std::size_t>(rng.next() % keys_);
+            }
+            auto it = std::lower_bound(cdf_.begin(), cdf_.end(), rng.next_unit());
+            return std::min(static_cast<std::size_t>(it - cdf_.begin()), keys_ - 1);
+        }
+
+    private:
+        std::size_t keys_;
+        bool zipf_;
+        std::vector<double> cdf_;
+    };
+
+    std::unique_ptr<config::IConfigStorage> make_storage()
+    {
+        return std::make_unique<config::Config>();
+    }
+
+    struct ThreadResult
+    {
+        bench::LatencyHistogram latency;
+        std::uint64_t ops = 0;
+    };
+
+    void run_case(bench::Runner &runner, const Options &options, unsigned threads, unsigned read_percent, const std::string &skew)
+    {
+        std::string name = "mixed/r" + std::to_string(read_percent) + "w" + std::to_string(100 - read_percent) +
+                           "/" + skew + "/t" + std::to_string(threads);
+        if (!runner.enabled(name))
+        {
+            return;
+        }
+        if (runner.list_only())
+        {
+            std::cout << name << "\n";
+            return;
+        }
+
+        std::vector<std::string> keys;
+        keys.reserve(options.keys);
+        for (std::size_t i = 0; i < options.keys; ++i)
+        {
+            keys.push_back("service.key" + std::to_string(i));
+        }
+        auto storage = make_storage();
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            storage->set(keys[i], static_cast<int>(i));
+        }
+        KeySampler sampler(options.keys, skew == "zipf", options.zipf_theta);
+
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> start{false};
+        std::atomic<bool> stop{false};
+        std::vector<ThreadResult> results(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                Rng rng(0x1234567ull * (t + 1));
+                ThreadResult &local = results[t];
+                ready.fetch_add(1);
+                while (!start.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    const std::string &key = keys[sampler.next(rng)];
+                    bool is_read = (rng.next() % 100) < read_percent;
+                    auto begin = std::chrono::steady_clock::now();
+                    if (is_read)
+                    {
+                        bench::do_not_optimize(storage->get(key));
+                    }
+                    else
+                    {
+                        storage->set(key, static_cast<int>(local.ops));
+                    }
+                    auto end = std::chrono::steady_clock::now();
+                    local.latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+                    ++local.ops;
+                }
+            });
+        }
+        while (ready.load() < threads)
+        {
+            std::this_thread::yield();
+        }
+        std::uint64_t allocs_before = bench::allocation_count().load();
+        std::uint64_t bytes_before = bench::allocated_bytes().load();
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(options.duration);
+        stop.store(true);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        double wall_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        std::uint64_t allocs = bench::allocation_count().load() - allocs_before;
+        std::uint64_t bytes = bench::allocated_bytes().load() - bytes_before;
+
+        bench::LatencyHistogram merged;
+        std::uint64_t total_ops = 0;
+        for (const auto &r : results)
+        {
+            merged.merge(r.latency);
+            total_ops += r.ops;
+        }
+
+        bench::Result result;
+        result.name = name;
+        result.threads = threads;
+        result.ops = total_ops;
+        result.ns_per_op = total_ops ? wall_ns / static_cast<double>(total_ops) : 0.0;
+        result.allocs_per_op = total_ops ? static_cast<double>(allocs) / static_cast<double>(total_ops) : 0.0;
+        result.bytes_per_op = total_ops ? static_cast<double>(bytes) / static_cast<double>(total_ops) : 0.0;
+        result.p50_ns = merged.percentile(50.0);
+        result.p90_ns = merged.percentile(90.0);
+        result.p99_ns = merged.percentile(99.0);
+        result.p999_ns = merged.percentile(99.9);
+        result.max_ns = merged.max();
+        runner.record(result);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+    Options options = parse_options(runner.extra_args());
+
+    for (const auto &skew : options.skews)
+    {
+        for (unsigned read_percent : options.read_percents)
+        {
+            for (unsigned threads : options.threads)
+            {
+                run_case(runner, options, threads, read_percent, skew);
+            }
+        }
+    }
+    return 0;
+}
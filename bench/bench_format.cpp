@@ -0,0 +1,186 @@
+/*  File: bench_format.cpp
+
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Serialization and conversion throughput benchmark for format_manager.hpp.
+    * Covers SerializerFactory::serialize for every OutputFormat and data shape
+    * (std::string, nlohmann::json, std::unordered_map, std::vector<T>) plus json_to_yaml and
+    * yaml_to_json round trips. Reports output MB/s and allocations per operation.
+    *
+    * Usage: bench_format [--entries 16,1024] [common options, see bench_common.hpp]
+    *
+*/
+
+#include "../include/format_manager.hpp"
+#include "bench_common.hpp"
+#include <cctype>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using namespace output_format;
+
+    // Discards output but counts the bytes, so only serialization cost is measured
+    class CountingBuffer : public std::streambuf
+    {
+    public:
+        std::uint64_t bytes() const { return bytes_; }
+        void reset() { bytes_ = 0; }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                ++bytes_;
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char *, std::streamsize count) override
+        {
+            bytes_ += static_cast<std::uint64_t>(count);
+            return count;
+        }
+
+    private:
+        std::uint64_t bytes_ = 0;
+    };
+
+    std::vector<std::size_t> parse_entry_counts(const std::vector<std::string> &args)
+    {
+        std::vector<std::size_t> counts = {16, 1024};
+        for (std::size_t i = 0; i + 1 < args.size(); ++i)
+        {
+            if (args[i] == "--entries")
+            {
+                counts.clear();
+                std::stringstream ss(args[i + 1]);
+                std::string item;
+                while (std::getline(ss, item, ','))
+                {
+                    counts.push_back(std::stoul(item));
+                }
+            }
+        }
+        return counts;
+    }
+
+    std::string format_name(OutputFormat format)
+    {
+        std::string name(format_to_string(format));
+        for (auto &c : name)
+        {
+            c = c == ' ' ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return name;
+    }
+
+    nlohmann::json make_document(std::size_t entries)
+    {
+        nlohmann::json doc = nlohmann::json::object();
+        for (std::size_t i = 0; i < entries; ++i)
+        {
+            std::string key = "key" + std::to_string(i);
+            switch (i % 4)
+            {
+            case 0:
+                doc[key] = "value-" + std::to_string(i);
+                break;
+            case 1:
+                doc[key] = static_cast<int>(i * 31);
+                break;
+            case 2:
+                doc[key] = static_cast<double>(i) / 8.0;
+                break;
+            default:
+                doc[key] = {{"host", "node" + std::to_string(i)}, {"port", 8000 + static_cast<int>(i % 1000)}, {"tags", {"a", "b"}}};
+                break;
+            }
+        }
+        return doc;
+    }
+
+    template <typename T>
+    void bench_serialize(bench::Runner &runner, const std::string &shape, const T &data)
+    {
+        CountingBuffer buffer;
+        std::ostream stream(&buffer);
+        for (OutputFormat format : list_output_formats())
+        {
+            // Measure the output size once so MB/s reflects bytes produced per operation
+            buffer.reset();
+            SerializerFactory::serialize(stream, data, format);
+            double payload = static_cast<double>(buffer.bytes());
+            runner.run("serialize/" + format_name(format) + "/" + shape, [&] {
+                SerializerFactory::serialize(stream, data, format);
+            }, nullptr, payload);
+        }
+    }
+
+    void bench_conversions(bench::Runner &runner, const std::string &suffix, const nlohmann::json &doc)
+    {
+        double payload = static_cast<double>(doc.dump().size());
+        runner.run("json_to_yaml" + suffix, [&] {
+            bench::do_not_optimize(json_to_yaml(doc));
+        }, nullptr, payload);
+
+        YAML::Node node = json_to_yaml(doc);
+        runner.run("yaml_to_json" + suffix, [&] {
+            bench::do_not_optimize(yaml_to_json(node));
+        }, nullptr, payload);
+
+        runner.run("round_trip/json_yaml_json" + suffix, [&] {
+            bench::do_not_optimize(yaml_to_json(json_to_yaml(doc)));
+        }, nullptr, payload);
+
+        // Text round trip as done by save/load: emit YAML text, parse it back, convert to JSON
+        runner.run("round_trip/yaml_text" + suffix, [&] {
+            YAML::Emitter out;
+            out << json_to_yaml(doc);
+            bench::do_not_optimize(yaml_to_json(YAML::Load(out.c_str())));
+        }, nullptr, payload);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+
+    bench_serialize(runner, "string", std::string("The quick brown fox jumps over the lazy dog"));
+
+    for (std::size_t entries : parse_entry_counts(runner.extra_args()))
+    {
+        const std::string suffix = "/" + std::to_string(entries);
+        nlohmann::json doc = make_document(entries);
+        std::unordered_map<std::string, nlohmann::json> map;
+        for (auto it = doc.begin(); it != doc.end(); ++it)
+        {
+            map[it.key()] = it.value();
+        }
+        std::vector<int> ints(entries);
+        std::vector<std::string> strings(entries);
+        for (std::size_t i = 0; i < entries; ++i)
+        {
+            ints[i] = static_cast<int>(i * 7);
+            strings[i] = "item-" + std::to_string(i);
+        }
+
+        bench_serialize(runner, "json" + suffix, doc);
+        bench_serialize(runner, "map" + suffix, map);
+        bench_serialize(runner, "vector_int" + suffix, ints);
+        bench_serialize(runner, "vector_string" + suffix, strings);
+        bench_conversions(runner, suffix, doc);
+    }
+    return 0;
+}
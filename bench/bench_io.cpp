@@ -0,0 +1,445 @@
+/*  File: bench_io.cpp
+
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Startup and I/O benchmark.
+    * Generates synthetic JSON and YAML configs (see config_generator.hpp) and times
+    * load_from_file, load_partial_from_file, lazy loads, save_to_file and backup_to_file on them,
+    * reporting MB/s, allocations/op and peak RSS. Each case runs in a forked child process
+    * so the peak RSS belongs to that case alone. The load_fragments cases load many small files,
+    * one load_from_file at a time or as one load_from_files batch per backend, with the page cache
+    * warm or dropped (cold) before every load; read_fragments times the batched read alone.
+    *
+    * Usage: bench_io [--sizes 1KB,64KB,1MB,16MB] [--formats json,yaml] [--iterations 5]
+    *                 [--dir /tmp] [--depth 2] [--string-ratio 0.5]
+    *                 [--fragments 64] [--fragment-size 4KB]
+    *                 [common options, see bench_common.hpp]
+    *
+*/
+
+#include "../include/configuration.hpp"
+#include "bench_common.hpp"
+#include "config_generator.hpp"
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Options
+    {
+        std::vector<std::uint64_t> sizes = {1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+        std::vector<bench::GeneratedFormat> formats = {bench::GeneratedFormat::JSON, bench::GeneratedFormat::YAML};
+        unsigned iterations = 5;
+        std::string dir = "/tmp";
+        bench::GeneratorOptions generator;
+        std::size_t fragments = 64;
+        std::uint64_t fragment_size = 4 * 1024;
+    };
+
+    std::vector<std::string> split(const std::string &list)
+    {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    Options parse_options(const std::vector<std::string> &args)
+    {
+        Options options;
+        for (std::size_t i = 0; i + 1 < args.size(); ++i)
+        {
+            const std::string &value = args[i + 1];
+            if (args[i] == "--sizes")
+            {
+                options.sizes.clear();
+                for (const auto &item : split(value))
+                {
+                    options.sizes.push_back(bench::parse_size(item));
+                }
+            }
+            else if (args[i] == "--formats")
+            {
+                options.formats.clear();
+                for (const auto &item : split(value))
+                {
+                    options.formats.push_back(item == "yaml" ? bench::GeneratedFormat::YAML : bench::GeneratedFormat::JSON);
+                }
+            }
+            else if (args[i] == "--iterations")
+            {
+                options.iterations = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            }
+            else if (args[i] == "--dir")
+            {
+                options.dir = value;
+            }
+            else if (args[i] == "--depth")
+            {
+                options.generator.depth = static_cast<unsigned>(std::stoul(value));
+            }
+            else if (args[i] == "--string-ratio")
+            {
+                options.generator.string_ratio = std::stod(value);
+            }
+            else if (args[i] == "--fragments")
+            {
+                options.fragments = std::stoul(value);
+            }
+            else if (args[i] == "--fragment-size")
+            {
+                options.fragment_size = bench::parse_size(value);
+            }
+        }
+        return options;
+    }
+
+    // Fixed-layout summary passed from the forked child back to the parent
+    struct CaseSample
+    {
+        int ok = 0;
+        std::uint64_t ops = 0;
+        double ns_per_op = 0.0;
+        double allocs_per_op = 0.0;
+        double bytes_per_op = 0.0;
+        double p50_ns = 0.0;
+        double p90_ns = 0.0;
+        double p99_ns = 0.0;
+        double max_ns = 0.0;
+        double payload_bytes = 0.0;
+        std::uint64_t peak_rss_bytes = 0;
+    };
+
+    // Runs `op` (one timed operation returning its payload bytes, or -1 on failure) in a child process
+    template <typename Prepare, typename Op>
+    void run_isolated(bench::Runner &runner, const std::string &name, unsigned iterations, Prepare prepare, Op op)
+    {
+        if (!runner.enabled(name))
+        {
+            return;
+        }
+        if (runner.list_only())
+        {
+            std::cout << name << "\n";
+            return;
+        }
+        std::cout.flush();
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            std::cerr << "pipe() failed for " << name << std::endl;
+            return;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            CaseSample sample;
+            prepare();
+            double warmup = op(); // Warms the page cache and the allocator
+            std::vector<double> times;
+            std::uint64_t allocs = 0;
+            std::uint64_t bytes = 0;
+            double payload = warmup;
+            bool ok = warmup >= 0.0;
+            for (unsigned i = 0; ok && i < iterations; ++i)
+            {
+                std::uint64_t allocs_before = bench::allocation_count().load();
+                std::uint64_t bytes_before = bench::allocated_bytes().load();
+                auto start = std::chrono::steady_clock::now();
+                payload = op();
+                times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+                allocs += bench::allocation_count().load() - allocs_before;
+                bytes += bench::allocated_bytes().load() - bytes_before;
+                ok = payload >= 0.0;
+            }
+            if (ok)
+            {
+                double total = 0.0;
+                for (double t : times)
+                {
+                    total += t;
+                }
+                sample.ok = 1;
+                sample.ops = times.size();
+                sample.ns_per_op = total / static_cast<double>(times.size());
+                sample.allocs_per_op = static_cast<double>(allocs) / static_cast<double>(times.size());
+                sample.bytes_per_op = static_cast<double>(bytes) / static_cast<double>(times.size());
+                sample.p50_ns = bench::percentile(times, 50.0);
+                sample.p90_ns = bench::percentile(times, 90.0);
+                sample.p99_ns = bench::percentile(times, 99.0);
+                sample.max_ns = bench::percentile(times, 100.0);
+                sample.payload_bytes = payload;
+            }
+            sample.peak_rss_bytes = bench::peak_rss_bytes();
+            ssize_t written = write(fds[1], &sample, sizeof(sample));
+            close(fds[1]);
+            _exit(written == static_cast<ssize_t>(sizeof(sample)) ? 0 : 1);
+        }
+        close(fds[1]);
+        CaseSample sample;
+        ssize_t got = read(fds[0], &sample, sizeof(sample));
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (got != static_cast<ssize_t>(sizeof(sample)) || !sample.ok)
+        {
+            std::cerr << name << ": failed" << std::endl;
+            return;
+        }
+
+        bench::Result result;
+        result.name = name;
+        result.ops = sample.ops;
+        result.ns_per_op = sample.ns_per_op;
+        result.allocs_per_op = sample.allocs_per_op;
+        result.bytes_per_op = sample.bytes_per_op;
+        result.p50_ns = sample.p50_ns;
+        result.p90_ns = sample.p90_ns;
+        result.p99_ns = sample.p99_ns;
+        result.p999_ns = sample.max_ns;
+        result.max_ns = sample.max_ns;
+        result.payload_bytes_per_op = sample.payload_bytes;
+        result.peak_rss_bytes = sample.peak_rss_bytes;
+        runner.record(result);
+    }
+
+    std::string generate_input(const Options &options, std::uint64_t size, bench::GeneratedFormat format, std::uint64_t &top_level_keys)
+    {
+        std::string extension = format == bench::GeneratedFormat::JSON ? "json" : "yaml";
+        std::string path = options.dir + "/bench_io_" + bench::format_size(size) + "." + extension;
+        bench::GeneratorOptions generator = options.generator;
+        generator.format = format;
+        generator.target_bytes = size;
+        std::ofstream out(path, std::ios::binary);
+        top_level_keys = bench::generate_config(out, generator).top_level_keys;
+        return path;
+    }
+
+    void run_size(bench::Runner &runner, const Options &options, std::uint64_t size, bench::GeneratedFormat format)
+    {
+        std::string extension = format == bench::GeneratedFormat::JSON ? "json" : "yaml";
+        std::string suffix = "/" + extension + "/" + bench::format_size(size);
+        std::uint64_t top_level_keys = 0;
+        std::string path = runner.list_only() ? std::string() : generate_input(options, size, format, top_level_keys);
+        std::string out_path = options.dir + "/bench_io_out_" + bench::format_size(size) + "." + extension;
+        std::string backup_path = options.dir + "/bench_io_backup_" + bench::format_size(size) + ".json";
+
+        run_isolated(runner, "load_from_file" + suffix, options.iterations, [] {}, [&] {
+            config::Config config;
+            config::IoResult result = config.load_from_file(path);
+            return result ? static_cast<double>(result.bytes) : -1.0;
+        });
+
+        // Partial load of every tenth top-level key
+        std::vector<std::string> partial_keys;
+        for (std::uint64_t i = 0; i < top_level_keys; i += 10)
+        {
+            partial_keys.push_back("section_" + std::to_string(i));
+        }
+        run_isolated(runner, "load_partial_from_file" + suffix, options.iterations, [] {}, [&] {
+            config::Config config;
+            config::IoResult result = config.load_partial_from_file(path, partial_keys);
+            return result ? static_cast<double>(result.bytes) : -1.0;
+        });
+
+        if (format == bench::GeneratedFormat::JSON)
+        {
+            // Lazy load, then reading one top-level key out of every ten
+            run_isolated(runner, "load_lazy" + suffix, options.iterations, [] {}, [&] {
+                config::Config config;
+                config.set_lazy_loading(true);
+                config::IoResult result = config.load_from_file(path);
+                return result ? static_cast<double>(result.bytes) : -1.0;
+            });
+            run_isolated(runner, "load_lazy_read_tenth" + suffix, options.iterations, [] {}, [&] {
+                config::Config config;
+                config.set_lazy_loading(true);
+                config::IoResult result = config.load_from_file(path);
+                for (const auto &key : partial_keys)
+                {
+                    bench::do_not_optimize(config.get(key));
+                }
+                return result ? static_cast<double>(result.bytes) : -1.0;
+            });
+        }
+
+        config::Config loaded;
+        run_isolated(runner, "save_to_file" + suffix, options.iterations, [&] { loaded.load_from_file(path); }, [&] {
+            config::IoResult result = loaded.save_to_file(out_path);
+            return result ? static_cast<double>(result.bytes) : -1.0;
+        });
+
+        if (format == bench::GeneratedFormat::JSON)
+        {
+            run_isolated(runner, "backup_to_file" + suffix, options.iterations, [&] { loaded.load_from_file(path); }, [&] {
+                loaded.backup_to_file(backup_path);
+                std::error_code ec;
+                auto bytes = std::filesystem::file_size(backup_path, ec);
+                return ec ? -1.0 : static_cast<double>(bytes);
+            });
+        }
+
+        if (!runner.list_only())
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            std::filesystem::remove(out_path, ec);
+            std::filesystem::remove(backup_path, ec);
+        }
+    }
+
+    // Drops the files' pages from the page cache, so the next read goes to the device
+    void evict(const std::vector<std::string> &paths)
+    {
+        for (const auto &path : paths)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+        }
+    }
+
+    void run_fragments(bench::Runner &runner, const Options &options)
+    {
+        std::string suffix = "/" + std::to_string(options.fragments) + "x" + bench::format_size(options.fragment_size);
+        std::vector<std::string> paths;
+        for (std::size_t i = 0; i < options.fragments; ++i)
+        {
+            paths.push_back(options.dir + "/bench_io_fragment_" + std::to_string(i) + ".json");
+            if (!runner.list_only())
+            {
+                bench::GeneratorOptions generator = options.generator;
+                generator.target_bytes = options.fragment_size;
+                generator.seed += i;
+                std::ofstream out(paths.back(), std::ios::binary);
+                bench::generate_config(out, generator);
+            }
+        }
+
+        auto batch = [&paths](config::FileIoBackend backend, bool registered) {
+            config::Config config;
+            std::vector<config::IoResult> results = config.load_from_files(paths, config::BatchLoadOptions{backend, registered, 0});
+            double bytes = 0.0;
+            for (const auto &result : results)
+            {
+                if (!result)
+                {
+                    return -1.0;
+                }
+                bytes += static_cast<double>(result.bytes);
+            }
+            return bytes;
+        };
+        for (bool cold : {false, true})
+        {
+            std::string temperature = cold ? "cold/" : "warm/";
+            // The read phase alone, without parsing
+            for (auto [name, backend, registered] : {std::make_tuple("posix", config::FileIoBackend::POSIX, false),
+                                                     std::make_tuple("io_uring", config::FileIoBackend::IO_URING, false),
+                                                     std::make_tuple("io_uring_registered", config::FileIoBackend::IO_URING, true)})
+            {
+                run_isolated(runner, "read_fragments/" + temperature + name + suffix, options.iterations, [] {}, [&, backend = backend, registered = registered] {
+                    if (cold)
+                    {
+                        evict(paths);
+                    }
+                    double bytes = 0.0;
+                    for (const auto &file : config::read_files(paths, config::BatchLoadOptions{backend, registered, 0}))
+                    {
+                        if (file.error)
+                        {
+                            return -1.0;
+                        }
+                        bytes += static_cast<double>(file.contents.size());
+                    }
+                    return bytes;
+                });
+            }
+            run_isolated(runner, "load_fragments/" + temperature + "loop" + suffix, options.iterations, [] {}, [&] {
+                if (cold)
+                {
+                    evict(paths);
+                }
+                config::Config config;
+                double bytes = 0.0;
+                for (const auto &path : paths)
+                {
+                    config::IoResult result = config.load_from_file(path);
+                    if (!result)
+                    {
+                        return -1.0;
+                    }
+                    bytes += static_cast<double>(result.bytes);
+                }
+                return bytes;
+            });
+            run_isolated(runner, "load_fragments/" + temperature + "posix" + suffix, options.iterations, [] {}, [&] {
+                if (cold)
+                {
+                    evict(paths);
+                }
+                return batch(config::FileIoBackend::POSIX, false);
+            });
+            run_isolated(runner, "load_fragments/" + temperature + "io_uring" + suffix, options.iterations, [] {}, [&] {
+                if (cold)
+                {
+                    evict(paths);
+                }
+                return batch(config::FileIoBackend::IO_URING, false);
+            });
+            run_isolated(runner, "load_fragments/" + temperature + "io_uring_registered" + suffix, options.iterations, [] {}, [&] {
+                if (cold)
+                {
+                    evict(paths);
+                }
+                return batch(config::FileIoBackend::IO_URING, true);
+            });
+        }
+
+        if (!runner.list_only())
+        {
+            std::error_code ec;
+            for (const auto &path : paths)
+            {
+                std::filesystem::remove(path, ec);
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+    Options options = parse_options(runner.extra_args());
+
+    for (auto format : options.formats)
+    {
+        for (std::uint64_t size : options.sizes)
+        {
+            run_size(runner, options, size, format);
+        }
+    }
+    run_fragments(runner, options);
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*
+    * config_generator.hpp
+    *
+    * Synthetic configuration generator for the I/O benchmarks and the gen_config tool.
+    * Streams realistic JSON or YAML documents of a requested size (1 KB to 1 GB and beyond)
+    * without building them in memory.
+    *
+    * Key Components:
+    * - GeneratorOptions struct: Target size, top-level key count, nesting depth, string/number mix.
+    * - generate_config(): Writes a document to an ostream and returns the generated statistics.
+    * - parse_size(): Parses sizes such as "64KB", "16MB" or "1GB".
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Document shape:
+  Each top-level key ("section_<n>") holds a nested object `depth` levels deep with `fanout`
+  children per level. The innermost objects hold `leaves` fields; each leaf is a string with
+  probability `string_ratio`, otherwise an integer or a float. Sections are written until the
+  target size is reached, or exactly `keys` sections when a key count is given.
+*/
+
+// File: config_generator.hpp
+
+
+#ifndef CONFIG_GENERATOR_HPP
+#define CONFIG_GENERATOR_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace bench
+{
+    enum class GeneratedFormat
+    {
+        JSON,
+        YAML
+    };
+
+    struct GeneratorOptions
+    {
+        GeneratedFormat format = GeneratedFormat::JSON;
+        std::uint64_t target_bytes = 1024 * 1024;
+        std::uint64_t keys = 0;         // Top-level keys; 0 writes sections until target_bytes is reached
+        unsigned depth = 2;             // Nesting levels below each top-level key
+        unsigned fanout = 4;            // Children per nested level
+        unsigned leaves = 8;            // Leaf fields per innermost object
+        double string_ratio = 0.5;      // Fraction of leaves that are strings
+        unsigned string_length = 24;    // Average string leaf length
+        std::uint64_t seed = 42;
+    };
+
+    struct GeneratorStats
+    {
+        std::uint64_t bytes = 0;
+        std::uint64_t top_level_keys = 0;
+        std::uint64_t leaves = 0;
+    };
+
+    // Parses "4096", "64KB", "16MB", "1GB" (binary multiples; KiB/MiB/GiB also accepted)
+    inline std::uint64_t parse_size(const std::string &text)
+    {
+        std::size_t pos = 0;
+        double value = std::stod(text, &pos);
+        std::string unit = text.substr(pos);
+        for (auto &c : unit)
+        {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        double multiplier = 1.0;
+        if (unit.empty() || unit == "B")
+        {
+            multiplier = 1.0;
+        }
+        else if (unit == "K" || unit == "KB" || unit == "KIB")
+        {
+            multiplier = 1024.0;
+        }
+        else if (unit == "M" || unit == "MB" || unit == "MIB")
+        {
+            multiplier = 1024.0 * 1024.0;
+        }
+        else if (unit == "G" || unit == "GB" || unit == "GIB")
+        {
+            multiplier = 1024.0 * 1024.0 * 1024.0;
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown size unit: " + text);
+        }
+        return static_cast<std::uint64_t>(value * multiplier);
+    }
+
+    inline std::string format_size(std::uint64_t bytes)
+    {
+        if (bytes >= (1ull << 30) && bytes % (1ull << 30) == 0)
+        {
+            return std::to_string(bytes >> 30) + "GB";
+        }
+        if (bytes >= (1ull << 20) && bytes % (1ull << 20) == 0)
+        {
+            return std::to_string(bytes >> 20) + "MB";
+        }
+        if (bytes >= (1ull << 10) && bytes % (1ull << 10) == 0)
+        {
+            return std::to_string(bytes >> 10) + "KB";
+        }
+        return std::to_string(bytes) + "B";
+    }
+
+    class ConfigGenerator
+    {
+    public:
+        ConfigGenerator(std::ostream &out, const GeneratorOptions &options)
+            : out_(out), options_(options), state_(options.seed ? options.seed : 1) {}
+
+        GeneratorStats run()
+        {
+            if (options_.format == GeneratedFormat::JSON)
+            {
+                write("{\n");
+            }
+            for (std::uint64_t i = 0;; ++i)
+            {
+                write_section(i);
+                ++stats_.top_level_keys;
+                bool done = options_.keys != 0 ? stats_.top_level_keys >= options_.keys : stats_.bytes >= options_.target_bytes;
+                if (done)
+                {
+                    break;
+                }
+            }
+            if (options_.format == GeneratedFormat::JSON)
+            {
+                write("\n}\n");
+            }
+            out_.flush();
+            return stats_;
+        }
+
+    private:
+        std::uint64_t next_random()
+        {
+            state_ ^= state_ >> 12;
+            state_ ^= state_ << 25;
+            state_ ^= state_ >> 27;
+            return state_ * 0x2545F4914F6CDD1Dull;
+        }
+
+        void write(const std::string &text)
+        {
+            out_ << text;
+            stats_.bytes += text.size();
+        }
+
+        void indent(unsigned level)
+        {
+            write(std::string(level * 2, ' '));
+        }
+
+        std::string make_string()
+        {
+            static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-_./";
+            unsigned length = std::max(1u, options_.string_length / 2 + static_cast<unsigned>(next_random() % (options_.string_length + 1)));
+            std::string s;
+            s.reserve(length);
+            for (unsigned i = 0; i < length; ++i)
+            {
+                s.push_back(alphabet[next_random() % (sizeof(alphabet) - 1)]);
+            }
+            return s;
+        }
+
+        std::string make_leaf_value()
+        {
+            ++stats_.leaves;
+            double pick = static_cast<double>(next_random() % 10000) / 10000.0;
+            if (pick < options_.string_ratio)
+            {
+                return "\"" + make_string() + "\"";
+            }
+            if (next_random() % 2 == 0)
+            {
+                return std::to_string(static_cast<std::int64_t>(next_random() % 1000000));
+            }
+            return std::to_string(static_cast<double>(next_random() % 1000000) / 1000.0);
+        }
+
+        void write_object(unsigned remaining_depth, unsigned level)
+        {
+            bool json = options_.format == GeneratedFormat::JSON;
+            unsigned children = remaining_depth == 0 ? options_.leaves : options_.fanout;
+            for (unsigned c = 0; c < children; ++c)
+            {
+                std::string name = remaining_depth == 0 ? "field_" + std::to_string(c) : "group_" + std::to_string(c);
+                indent(level);
+                if (json)
+                {
+                    write("\"" + name + "\": ");
+                }
+                else
+                {
+                    write(name + ":");
+                }
+                if (remaining_depth == 0)
+                {
+                    write((json ? "" : " ") + make_leaf_value());
+                }
+                else
+                {
+                    write(json ? "{\n" : "\n");
+                    write_object(remaining_depth - 1, level + 1);
+                    if (json)
+                    {
+                        indent(level);
+                        write("}");
+                    }
+                }
+                if (json && c + 1 < children)
+                {
+                    write(",");
+                }
+                if (json || remaining_depth == 0)
+                {
+                    write("\n");
+                }
+            }
+        }
+
+        void write_section(std::uint64_t index)
+        {
+            std::string name = "section_" + std::to_string(index);
+            if (options_.format == GeneratedFormat::JSON)
+            {
+                write(index == 0 ? "  \"" : ",\n  \"");
+                write(name + "\": {\n");
+                write_object(options_.depth, 2);
+                write("  }");
+            }
+            else
+            {
+                write(name + ":\n");
+                write_object(options_.depth, 1);
+            }
+        }
+
+        std::ostream &out_;
+        GeneratorOptions options_;
+        std::uint64_t state_;
+        GeneratorStats stats_;
+    };
+
+    inline GeneratorStats generate_config(std::ostream &out, const GeneratorOptions &options)
+    {
+        ConfigGenerator generator(out, options);
+        return generator.run();
+    }
+
+} // namespace bench
+
+#endif // CONFIG_GENERATOR_HPP
@@ -0,0 +1,257 @@
+/*
+    * config_array.hpp
+    *
+    * Header-only columnar storage for large numeric arrays.
+    * Numeric arrays stored as nlohmann::json spend 16 bytes plus a type tag per element and are copied
+    * on every read. Columnar arrays keep the values in one contiguous, 64-byte aligned buffer of double
+    * or std::int64_t, shared between the Config and its readers, so reads hand out a view without
+    * copying and vectorized consumers can use aligned loads.
+    *
+    * Key Components:
+    * - AlignedAllocator / AlignedBuffer: std::vector with cache-line (64-byte) aligned storage.
+    * - ArrayView class: Read-only view that keeps its buffer alive; a std::span in C++20 builds.
+    * - ColumnarArray class: Type-erased double or int64 buffer stored by Config, with json conversion.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+config.set_array("thresholds", std::vector<double>(100000, 0.5));
+ArrayView<double> thresholds = config.get_array<double>("thresholds"); // No copy
+double first = thresholds[0];
+std::span<const double> span = thresholds.span(); // C++20
+
+config.set_array_promotion_threshold(1024); // Numeric json arrays of 1024+ elements are stored columnar
+
+A view stays valid after the key is overwritten or removed; it keeps the old buffer alive.
+*/
+
+// File: config_array.hpp
+
+
+#ifndef CONFIG_ARRAY_HPP
+#define CONFIG_ARRAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <nlohmann/json.hpp>
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#define CONFIG_ARRAY_HAS_SPAN 1
+#endif
+
+namespace config
+{
+    constexpr std::size_t kArrayAlignment = 64;
+
+    template <typename T, std::size_t Alignment = kArrayAlignment>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(std::size_t count)
+        {
+            if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *pointer, std::size_t) noexcept
+        {
+            ::operator delete(pointer, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+    };
+
+    template <typename T>
+    using AlignedBuffer = std::vector<T, AlignedAllocator<T>>;
+
+    template <typename T>
+    struct is_columnar_type : std::bool_constant<std::is_same_v<T, double> || std::is_same_v<T, std::int64_t>> {};
+
+    template <typename T>
+    class ArrayView
+    {
+        static_assert(is_columnar_type<T>::value, "ArrayView supports double and std::int64_t");
+
+    public:
+        ArrayView() = default;
+        explicit ArrayView(std::shared_ptr<const AlignedBuffer<T>> buffer) : buffer_(std::move(buffer)) {}
+
+        const T *data() const { return buffer_ ? buffer_->data() : nullptr; }
+        std::size_t size() const { return buffer_ ? buffer_->size() : 0; }
+        bool empty() const { return size() == 0; }
+        const T &operator[](std::size_t index) const { return (*buffer_)[index]; }
+        const T *begin() const { return data(); }
+        const T *end() const { return data() + size(); }
+
+#ifdef CONFIG_ARRAY_HAS_SPAN
+        std::span<const T> span() const { return std::span<const T>(data(), size()); }
+        operator std::span<const T>() const { return span(); }
+#endif
+
+        nlohmann::json to_json() const
+        {
+            nlohmann::json array = nlohmann::json::array();
+            array.get_ref<nlohmann::json::array_t &>().reserve(size());
+            for (const T &value : *this)
+            {
+                array.push_back(value);
+            }
+            return array;
+        }
+
+    private:
+        std::shared_ptr<const AlignedBuffer<T>> buffer_;
+    };
+
+    class ColumnarArray
+    {
+    public:
+        enum class Type
+        {
+            DOUBLE,
+            INT64
+        };
+
+        explicit ColumnarArray(AlignedBuffer<double> values)
+            : type_(Type::DOUBLE), doubles_(std::make_shared<const AlignedBuffer<double>>(std::move(values))) {}
+        explicit ColumnarArray(AlignedBuffer<std::int64_t> values)
+            : type_(Type::INT64), ints_(std::make_shared<const AlignedBuffer<std::int64_t>>(std::move(values))) {}
+
+        // Lossless conversion only: arrays of integers that fit std::int64_t become INT64, arrays of floats
+        // DOUBLE. Mixed arrays and larger unsigned integers would read back differently, so they are not columnar
+        static std::optional<ColumnarArray> from_json(const nlohmann::json &value)
+        {
+            if (!value.is_array())
+            {
+                return std::nullopt;
+            }
+            if (!value.empty() && value.front().is_number_float())
+            {
+                AlignedBuffer<double> values;
+                values.reserve(value.size());
+                for (const auto &element : value)
+                {
+                    if (!element.is_number_float())
+                    {
+                        return std::nullopt;
+                    }
+                    values.push_back(element.get<double>());
+                }
+                return ColumnarArray(std::move(values));
+            }
+            AlignedBuffer<std::int64_t> values;
+            values.reserve(value.size());
+            for (const auto &element : value)
+            {
+                if (!element.is_number_integer()
+                    || (element.is_number_unsigned() && element.get<std::uint64_t>() > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())))
+                {
+                    return std::nullopt;
+                }
+                values.push_back(element.get<std::int64_t>());
+            }
+            return ColumnarArray(std::move(values));
+        }
+
+        // Any all-number array as DOUBLE, for callers that asked for doubles
+        static std::optional<ColumnarArray> doubles_from_json(const nlohmann::json &value)
+        {
+            if (!value.is_array())
+            {
+                return std::nullopt;
+            }
+            AlignedBuffer<double> values;
+            values.reserve(value.size());
+            for (const auto &element : value)
+            {
+                if (!element.is_number())
+                {
+                    return std::nullopt;
+                }
+                values.push_back(element.get<double>());
+            }
+            return ColumnarArray(std::move(values));
+        }
+
+        Type type() const { return type_; }
+        std::size_t size() const { return type_ == Type::DOUBLE ? doubles_->size() : ints_->size(); }
+
+        // Shares the buffer when T matches the stored type. INT64 data converts into a new double buffer;
+        // DOUBLE data throws std::invalid_argument for std::int64_t, since fractions would be truncated
+        template <typename T>
+        ArrayView<T> view() const
+        {
+            if constexpr (std::is_same_v<T, double>)
+            {
+                if (type_ == Type::DOUBLE)
+                {
+                    return ArrayView<T>(doubles_);
+                }
+                return ArrayView<T>(std::make_shared<const AlignedBuffer<T>>(ints_->begin(), ints_->end()));
+            }
+            else
+            {
+                if (type_ == Type::INT64)
+                {
+                    return ArrayView<T>(ints_);
+                }
+                throw std::invalid_argument("Columnar array holds doubles, not 64-bit integers");
+            }
+        }
+
+        nlohmann::json to_json() const
+        {
+            return type_ == Type::DOUBLE ? ArrayView<double>(doubles_).to_json() : ArrayView<std::int64_t>(ints_).to_json();
+        }
+
+        const char *type_name() const { return type_ == Type::DOUBLE ? "double_array" : "int64_array"; }
+
+        // Buffer capacity in bytes, excluding allocator and control block overhead
+        std::size_t buffer_bytes() const
+        {
+            return type_ == Type::DOUBLE ? doubles_->capacity() * sizeof(double) : ints_->capacity() * sizeof(std::int64_t);
+        }
+
+    private:
+        Type type_;
+        std::shared_ptr<const AlignedBuffer<double>> doubles_;
+        std::shared_ptr<const AlignedBuffer<std::int64_t>> ints_;
+    };
+
+} // namespace config
+
+#endif // CONFIG_ARRAY_HPP
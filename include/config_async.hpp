@@ -0,0 +1,292 @@
+/*
+    * config_async.hpp
+    *
+    * Header-only asynchronous load, save and backup for any IConfigStorage.
+    * async_load, async_save and async_backup queue the blocking file operation on an executor and report
+    * its IoResult through a std::future or a completion handler, so event-loop threads never wait on
+    * config disk I/O. Requests carry a priority and an optional cancellation token.
+    *
+    * Key Components:
+    * - ConfigExecutor interface: Where queued operations run; ThreadPoolExecutor is the default.
+    * - ThreadPoolExecutor class: Worker threads serving a priority queue (FIFO within a priority).
+    * - CancellationToken class: Cancels requests that have not started yet.
+    * - AsyncOptions struct: Priority, cancellation token and executor of one request.
+    * - async_load / async_save / async_backup: Future and completion-handler forms.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage:
+
+std::future<IoResult> loaded = async_load(config, "service.json");
+...
+if (!loaded.get()) { ... }
+
+auto cancel = std::make_shared<CancellationToken>();
+async_save(config, "service.yaml", [](const IoResult &result) {
+    log(result.to_json());
+}, AsyncOptions{AsyncPriority::LOW, cancel});
+cancel->cancel();   // Completes with IoError::CANCELLED if the save has not started
+
+Rules:
+- The storage must outlive every request queued for it.
+- Cancellation only affects requests still waiting in the queue; a started operation runs to the end.
+- Completion handlers run on the executor's thread; exceptions they throw are reported on std::cerr.
+- ThreadPoolExecutor's destructor runs the requests already queued, then joins its threads.
+- default_executor() is a process-wide pool with two threads, created on first use.
+*/
+
+// File: config_async.hpp
+
+
+#ifndef CONFIG_ASYNC_HPP
+#define CONFIG_ASYNC_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "configuration.hpp"
+
+namespace config
+{
+    enum class AsyncPriority
+    {
+        HIGH,
+        NORMAL,
+        LOW
+    };
+
+    class ConfigExecutor
+    {
+    public:
+        virtual ~ConfigExecutor() = default;
+        virtual void submit(AsyncPriority priority, std::function<void()> task) = 0;
+    };
+
+    class ThreadPoolExecutor : public ConfigExecutor
+    {
+    public:
+        explicit ThreadPoolExecutor(unsigned threads = 1)
+        {
+            for (unsigned i = 0; i < std::max(1u, threads); ++i)
+            {
+                workers_.emplace_back([this] { run(); });
+            }
+        }
+
+        ~ThreadPoolExecutor() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            ready_.notify_all();
+            for (auto &worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        ThreadPoolExecutor(const ThreadPoolExecutor &) = delete;
+        ThreadPoolExecutor &operator=(const ThreadPoolExecutor &) = delete;
+
+        void submit(AsyncPriority priority, std::function<void()> task) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push({priority, next_sequence_++, std::move(task)});
+            }
+            ready_.notify_one();
+        }
+
+        // Requests queued and not yet started
+        std::size_t pending() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size();
+        }
+
+    private:
+        struct Task
+        {
+            AsyncPriority priority;
+            std::uint64_t sequence;
+            std::function<void()> fn;
+        };
+
+        // std::priority_queue pops the largest element: higher priority first, then the earliest submitted
+        struct Later
+        {
+            bool operator()(const Task &a, const Task &b) const
+            {
+                return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+            }
+        };
+
+        void run()
+        {
+            while (true)
+            {
+                std::function<void()> fn;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                    if (queue_.empty())
+                    {
+                        return;
+                    }
+                    fn = std::move(const_cast<Task &>(queue_.top()).fn);
+                    queue_.pop();
+                }
+                fn();
+            }
+        }
+
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        std::priority_queue<Task, std::vector<Task>, Later> queue_;
+        std::uint64_t next_sequence_ = 0;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+    };
+
+    inline std::shared_ptr<ConfigExecutor> default_executor()
+    {
+        static std::shared_ptr<ConfigExecutor> executor = std::make_shared<ThreadPoolExecutor>(2);
+        return executor;
+    }
+
+    class CancellationToken
+    {
+    public:
+        void cancel() { cancelled_.store(true, std::memory_order_release); }
+        bool cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+    private:
+        std::atomic<bool> cancelled_{false};
+    };
+
+    struct AsyncOptions
+    {
+        AsyncPriority priority = AsyncPriority::NORMAL;
+        std::shared_ptr<const CancellationToken> cancel; // Optional
+        std::shared_ptr<ConfigExecutor> executor;        // nullptr uses default_executor()
+    };
+
+    using IoCompletion = std::function<void(const IoResult &)>;
+
+    namespace async_detail
+    {
+        // Queues `op` (returning an IoResult) and hands its result, or a CANCELLED/failed result, to `on_complete`
+        template <typename Op>
+        void submit_io(const std::string &file_path, IoError failure, Op op, IoCompletion on_complete, const AsyncOptions &options)
+        {
+            std::shared_ptr<ConfigExecutor> executor = options.executor ? options.executor : default_executor();
+            executor->submit(options.priority, [file_path, failure, op = std::move(op), on_complete = std::move(on_complete), cancel = options.cancel]() {
+                IoResult result;
+                result.file_path = file_path;
+                if (cancel && cancel->cancelled())
+                {
+                    result.error = IoError::CANCELLED;
+                    result.message = "Cancelled before it started: " + file_path;
+                }
+                else
+                {
+                    try
+                    {
+                        result = op();
+                    }
+                    catch (const std::exception &e)
+                    {
+                        result.error = failure;
+                        result.message = e.what();
+                    }
+                    catch (...)
+                    {
+                        result.error = failure;
+                        result.message = "Unknown exception during " + file_path;
+                    }
+                }
+                if (!on_complete)
+                {
+                    return;
+                }
+                try
+                {
+                    on_complete(result);
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "Error in async completion handler for " << file_path << ": " << e.what() << std::endl;
+                }
+                catch (...)
+                {
+                    std::cerr << "Unknown exception in async completion handler for " << file_path << std::endl;
+                }
+            });
+        }
+
+        inline std::future<IoResult> to_future(const std::function<void(IoCompletion)> &start)
+        {
+            auto promise = std::make_shared<std::promise<IoResult>>();
+            std::future<IoResult> future = promise->get_future();
+            start([promise](const IoResult &result) { promise->set_value(result); });
+            return future;
+        }
+    } // namespace async_detail
+
+    inline void async_load(IConfigStorage &config, const std::string &file_path, IoCompletion on_complete, const AsyncOptions &options = AsyncOptions{})
+    {
+        async_detail::submit_io(file_path, IoError::READ_FAILED, [&config, file_path] { return config.load_from_file(file_path); },
+                                std::move(on_complete), options);
+    }
+
+    inline void async_save(IConfigStorage &config, const std::string &file_path, IoCompletion on_complete, const AsyncOptions &options = AsyncOptions{})
+    {
+        async_detail::submit_io(file_path, IoError::WRITE_FAILED, [&config, file_path] { return config.save_to_file(file_path); },
+                                std::move(on_complete), options);
+    }
+
+    inline void async_backup(IConfigStorage &config, const std::string &file_path, IoCompletion on_complete, const AsyncOptions &options = AsyncOptions{})
+    {
+        async_detail::submit_io(file_path, IoError::WRITE_FAILED, [&config, file_path] { return config.backup_to_file(file_path); },
+                                std::move(on_complete), options);
+    }
+
+    inline std::future<IoResult> async_load(IConfigStorage &config, const std::string &file_path, const AsyncOptions &options = AsyncOptions{})
+    {
+        return async_detail::to_future([&](IoCompletion done) { async_load(config, file_path, std::move(done), options); });
+    }
+
+    inline std::future<IoResult> async_save(IConfigStorage &config, const std::string &file_path, const AsyncOptions &options = AsyncOptions{})
+    {
+        return async_detail::to_future([&](IoCompletion done) { async_save(config, file_path, std::move(done), options); });
+    }
+
+    inline std::future<IoResult> async_backup(IConfigStorage &config, const std::string &file_path, const AsyncOptions &options = AsyncOptions{})
+    {
+        return async_detail::to_future([&](IoCompletion done) { async_backup(config, file_path, std::move(done), options); });
+    }
+
+} // namespace config
+
+#endif // CONFIG_ASYNC_HPP
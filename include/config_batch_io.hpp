@@ -0,0 +1,629 @@
+/*
+    * config_batch_io.hpp
+    *
+    * Header-only batched reads of many whole files.
+    * read_files() opens and reads a list of files with as few system calls as it can. On Linux it drives
+    * an io_uring directly through its system calls: every open and size lookup of a batch goes to the
+    * kernel in one submission, then every read, then every close, and the reads can land in buffers
+    * registered with the ring. Where io_uring is missing or refused, the same files are read one by one
+    * with open/fstat/read/close. Config::load_from_files parses the buffers this returns in parallel.
+    *
+    * Key Components:
+    * - FileIoBackend enum: AUTO, IO_URING or POSIX.
+    * - BatchLoadOptions struct: Backend, registered buffers and parse threads of a multi-file load.
+    * - FileBuffer struct: One file's contents, or the errno of the step that failed.
+    * - BatchReadStats struct: Backend used, files, bytes, system calls and phase times of a batch.
+    * - read_files(): Reads a batch with the selected backend.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    * - Linux io_uring (optional; used through raw system calls, liburing is not needed)
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+std::vector<std::string> fragments = {"conf.d/10-base.json", "conf.d/20-db.yaml", ...};
+BatchReadStats stats;
+std::vector<IoResult> results = config.load_from_files(fragments, BatchLoadOptions{}, &stats);
+std::cout << file_io_backend_to_string(stats.backend) << ": " << stats.syscalls << " system calls\n";
+
+Rules:
+- AUTO uses io_uring for batches of at least kMinUringBatch files when the kernel supports the
+  opcodes involved, and POSIX reads otherwise. IO_URING falls back to POSIX the same way, so a load
+  never fails because of the backend. BatchReadStats::backend is IO_URING only when the ring read every
+  file; after a fallback part way it is POSIX, and uring_files counts the files the ring read first.
+- Registered buffers are opt-in. Each buffer is read into once, so pinning it rarely pays for itself;
+  if the ring refuses them (for example over RLIMIT_MEMLOCK), the batch uses plain reads.
+- io_uring batches hold up to 128 files; longer lists are read in several batches.
+*/
+
+// File: config_batch_io.hpp
+
+
+#ifndef CONFIG_BATCH_IO_HPP
+#define CONFIG_BATCH_IO_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(IORING_FEAT_FAST_POLL) && defined(__NR_io_uring_setup) // Headers new enough for OPENAT, STATX, CLOSE and probing
+#define CONFIG_MANAGER_HAS_IO_URING 1
+#endif
+#endif
+
+namespace config
+{
+    enum class FileIoBackend
+    {
+        AUTO,
+        IO_URING,
+        POSIX
+    };
+
+    constexpr std::string_view file_io_backend_to_string(FileIoBackend backend) noexcept
+    {
+        switch (backend)
+        {
+        case FileIoBackend::AUTO: return "auto";
+        case FileIoBackend::IO_URING: return "io_uring";
+        case FileIoBackend::POSIX: return "posix";
+        }
+        return "unknown";
+    }
+
+    // Smallest batch AUTO reads through io_uring; below it, setting up a ring costs more than it saves
+    constexpr std::size_t kMinUringBatch = 4;
+
+    struct BatchLoadOptions
+    {
+        FileIoBackend backend = FileIoBackend::AUTO;
+        bool registered_buffers = false; // io_uring: read into buffers registered with the ring
+        unsigned parse_threads = 0;     // Threads parsing the buffers; 0 uses the hardware concurrency
+    };
+
+    struct FileBuffer
+    {
+        std::string path;
+        std::string contents;
+        int error = 0;       // errno of the failed step, 0 on success
+        bool opened = false; // Whether the open succeeded (an error after it is a read error)
+        // This file's own phase times with POSIX calls; io_uring opens and reads files in shared
+        // submissions, so they stay zero for files it read
+        std::chrono::nanoseconds open{0};
+        std::chrono::nanoseconds read{0};
+    };
+
+    struct BatchReadStats
+    {
+        FileIoBackend backend = FileIoBackend::POSIX; // IO_URING only if the ring read every file
+        std::size_t files = 0;
+        std::size_t uring_files = 0;     // Files read through io_uring before any fallback to POSIX
+        std::size_t bytes = 0;
+        std::size_t syscalls = 0;        // io_uring_setup/enter/register calls, or open/fstat/read/close calls
+        bool registered_buffers = false; // Whether every io_uring batch read into registered buffers
+        std::chrono::nanoseconds open{0}; // Opening and sizing the files
+        std::chrono::nanoseconds read{0}; // Reading and closing them
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"backend", std::string(file_io_backend_to_string(backend))},
+                {"files", files},
+                {"uring_files", uring_files},
+                {"bytes", bytes},
+                {"syscalls", syscalls},
+                {"registered_buffers", registered_buffers},
+                {"open_ns", open.count()},
+                {"read_ns", read.count()}
+            };
+        }
+    };
+
+    namespace batch_io
+    {
+        constexpr std::size_t kUnknownSizeCapacity = 64 * 1024;
+
+        // Reads one file to EOF into `file.contents`, growing it when full
+        inline void posix_read(FileBuffer &file, BatchReadStats &stats)
+        {
+            auto started = std::chrono::steady_clock::now();
+            int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+            ++stats.syscalls;
+            if (fd < 0)
+            {
+                file.error = errno;
+                file.open = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+                stats.open += file.open;
+                return;
+            }
+            file.opened = true;
+            struct stat info;
+            ++stats.syscalls;
+            // Procfs and sysfs files are regular but report size 0 and return a page per read, so only a known size
+            // lets a short read end the file
+            bool sized = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0;
+            std::size_t capacity = sized ? static_cast<std::size_t>(info.st_size) + 1 : kUnknownSizeCapacity;
+            auto opened = std::chrono::steady_clock::now();
+            file.open = std::chrono::duration_cast<std::chrono::nanoseconds>(opened - started);
+            file.contents.resize(capacity);
+            std::size_t filled = 0;
+            while (true)
+            {
+                ssize_t n = ::read(fd, file.contents.data() + filled, capacity - filled);
+                ++stats.syscalls;
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    file.error = errno;
+                    break;
+                }
+                if (n == 0)
+                {
+                    break;
+                }
+                filled += static_cast<std::size_t>(n);
+                if (sized && filled < capacity)
+                {
+                    break; // A short read of a file of known size is its end
+                }
+                if (filled == capacity)
+                {
+                    capacity *= 2;
+                    file.contents.resize(capacity);
+                }
+            }
+            ::close(fd);
+            ++stats.syscalls;
+            file.contents.resize(file.error ? 0 : filled);
+            file.read = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - opened);
+            stats.open += file.open;
+            stats.read += file.read;
+        }
+
+#ifdef CONFIG_MANAGER_HAS_IO_URING
+        // Minimal single-producer io_uring: one submission queue filled and drained by the owning thread
+        class Ring
+        {
+        public:
+            explicit Ring(unsigned entries)
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if (fd_ < 0)
+                {
+                    return;
+                }
+                sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                {
+                    sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+                }
+                sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+                cq_ring_ = single_mmap ? sq_ring_ : map(cq_size_, IORING_OFF_CQ_RING);
+                sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+                void *sqes = map(sqes_size_, IORING_OFF_SQES);
+                if (!sq_ring_ || !cq_ring_ || !sqes)
+                {
+                    if (sqes)
+                    {
+                        ::munmap(sqes, sqes_size_);
+                    }
+                    release();
+                    return;
+                }
+                char *sq = static_cast<char *>(sq_ring_);
+                char *cq = static_cast<char *>(cq_ring_);
+                sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+                sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+                sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+                sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+                cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+                cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+                cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+                sqes_ = static_cast<io_uring_sqe *>(sqes);
+                entries_ = params.sq_entries;
+                local_tail_ = *sq_tail_;
+            }
+
+            ~Ring()
+            {
+                if (sqes_)
+                {
+                    ::munmap(sqes_, sqes_size_);
+                }
+                release();
+            }
+
+            Ring(const Ring &) = delete;
+            Ring &operator=(const Ring &) = delete;
+
+            bool ok() const { return sqes_ != nullptr; }
+            unsigned entries() const { return entries_; }
+            std::size_t syscalls() const { return syscalls_; }
+
+            // Whether the kernel implements every opcode in `ops`
+            bool supports(std::initializer_list<unsigned> ops)
+            {
+                std::vector<unsigned char> buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+                auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+                ++syscalls_;
+                if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, 256) < 0)
+                {
+                    return false;
+                }
+                for (unsigned op : ops)
+                {
+                    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // A zeroed submission entry, or nullptr when the queue is full
+            io_uring_sqe *next_sqe(std::uint64_t user_data)
+            {
+                if (local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_)
+                {
+                    return nullptr;
+                }
+                unsigned index = local_tail_ & sq_mask_;
+                io_uring_sqe *sqe = &sqes_[index];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->user_data = user_data;
+                sq_array_[index] = index;
+                ++local_tail_;
+                return sqe;
+            }
+
+            // Submits the queued entries and waits for `expected` completions, passing each (user_data, res)
+            // to `on_complete`. Returns false if the ring itself fails
+            template <typename OnComplete>
+            bool submit_and_wait(unsigned expected, OnComplete on_complete)
+            {
+                unsigned to_submit = local_tail_ - *sq_tail_;
+                __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+                unsigned completed = 0;
+                while (completed < expected)
+                {
+                    ++syscalls_;
+                    long submitted = ::syscall(__NR_io_uring_enter, fd_, to_submit, expected - completed, IORING_ENTER_GETEVENTS, nullptr, 0);
+                    if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                    {
+                        return false;
+                    }
+                    if (submitted > 0)
+                    {
+                        to_submit -= static_cast<unsigned>(submitted);
+                    }
+                    unsigned head = *cq_head_;
+                    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                    for (; head != tail; ++head)
+                    {
+                        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+                        on_complete(cqe.user_data, cqe.res);
+                        ++completed;
+                    }
+                    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                }
+                return true;
+            }
+
+            bool register_buffers(const std::vector<iovec> &buffers)
+            {
+                ++syscalls_;
+                return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) == 0;
+            }
+
+            void unregister_buffers()
+            {
+                ++syscalls_;
+                ::syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            }
+
+        private:
+            void *map(std::size_t size, std::uint64_t offset)
+            {
+                void *ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, static_cast<off_t>(offset));
+                return ptr == MAP_FAILED ? nullptr : ptr;
+            }
+
+            void release()
+            {
+                if (cq_ring_ && cq_ring_ != sq_ring_)
+                {
+                    ::munmap(cq_ring_, cq_size_);
+                }
+                if (sq_ring_)
+                {
+                    ::munmap(sq_ring_, sq_size_);
+                }
+                if (fd_ >= 0)
+                {
+                    ::close(fd_);
+                }
+                sq_ring_ = cq_ring_ = nullptr;
+                sqes_ = nullptr;
+                fd_ = -1;
+            }
+
+            int fd_ = -1;
+            void *sq_ring_ = nullptr;
+            void *cq_ring_ = nullptr;
+            std::size_t sq_size_ = 0;
+            std::size_t cq_size_ = 0;
+            std::size_t sqes_size_ = 0;
+            unsigned *sq_head_ = nullptr;
+            unsigned *sq_tail_ = nullptr;
+            unsigned *sq_array_ = nullptr;
+            unsigned *cq_head_ = nullptr;
+            unsigned *cq_tail_ = nullptr;
+            unsigned sq_mask_ = 0;
+            unsigned cq_mask_ = 0;
+            io_uring_sqe *sqes_ = nullptr;
+            io_uring_cqe *cqes_ = nullptr;
+            unsigned entries_ = 0;
+            unsigned local_tail_ = 0;
+            std::size_t syscalls_ = 0;
+        };
+
+        constexpr unsigned kRingEntries = 256; // Two entries per file in the open phase: 128 files per batch
+
+        // Reads files[begin, end) in three submissions: open + statx, reads, closes. Returns false if the ring
+        // failed part way, leaving the caller to read the batch again with POSIX calls
+        inline bool uring_read_batch(Ring &ring, std::vector<FileBuffer> &files, std::size_t begin, std::size_t end,
+                                     bool use_registered, BatchReadStats &stats)
+        {
+            std::size_t count = end - begin;
+            std::vector<int> fds(count, -1);
+            std::vector<struct statx> sizes(count);
+            std::vector<std::size_t> filled(count, 0);
+            auto started = std::chrono::steady_clock::now();
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                io_uring_sqe *open = ring.next_sqe(i << 1);
+                open->opcode = IORING_OP_OPENAT;
+                open->fd = AT_FDCWD;
+                open->addr = reinterpret_cast<std::uint64_t>(files[begin + i].path.c_str());
+                open->open_flags = O_RDONLY | O_CLOEXEC;
+                io_uring_sqe *size = ring.next_sqe((i << 1) | 1);
+                size->opcode = IORING_OP_STATX;
+                size->fd = AT_FDCWD;
+                size->addr = reinterpret_cast<std::uint64_t>(files[begin + i].path.c_str());
+                size->len = STATX_TYPE | STATX_SIZE;
+                size->off = reinterpret_cast<std::uint64_t>(&sizes[i]);
+            }
+            std::vector<int> statx_result(count, -1);
+            bool ok = ring.submit_and_wait(static_cast<unsigned>(count * 2), [&](std::uint64_t user_data, int res) {
+                std::size_t i = static_cast<std::size_t>(user_data >> 1);
+                if (user_data & 1)
+                {
+                    statx_result[i] = res;
+                }
+                else
+                {
+                    fds[i] = res;
+                }
+            });
+            auto opened = std::chrono::steady_clock::now();
+            stats.open += std::chrono::duration_cast<std::chrono::nanoseconds>(opened - started);
+            if (!ok)
+            {
+                for (int fd : fds)
+                {
+                    if (fd >= 0)
+                    {
+                        ::close(fd);
+                    }
+                }
+                return false;
+            }
+
+            // Size each buffer to the file plus one byte, so a complete read comes back short and ends the file
+            std::vector<iovec> registered;
+            std::vector<std::size_t> slot(count, 0);
+            std::vector<std::size_t> active;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                FileBuffer &file = files[begin + i];
+                if (fds[i] < 0)
+                {
+                    file.error = -fds[i];
+                    continue;
+                }
+                file.opened = true;
+                bool sized = statx_result[i] == 0 && S_ISREG(sizes[i].stx_mode) && sizes[i].stx_size > 0;
+                file.contents.resize(sized ? static_cast<std::size_t>(sizes[i].stx_size) + 1 : kUnknownSizeCapacity);
+                slot[i] = registered.size();
+                registered.push_back({file.contents.data(), file.contents.size()});
+                active.push_back(i);
+            }
+            bool fixed = use_registered && !registered.empty() && ring.register_buffers(registered);
+            stats.registered_buffers = stats.registered_buffers && (fixed || registered.empty());
+
+            bool first_round = true;
+            while (ok && !active.empty())
+            {
+                for (std::size_t i : active)
+                {
+                    FileBuffer &file = files[begin + i];
+                    io_uring_sqe *read = ring.next_sqe(i);
+                    read->opcode = fixed && first_round ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                    read->fd = fds[i];
+                    read->addr = reinterpret_cast<std::uint64_t>(file.contents.data() + filled[i]);
+                    read->len = static_cast<unsigned>(std::min<std::size_t>(file.contents.size() - filled[i], 1u << 30));
+                    read->off = filled[i];
+                    read->buf_index = static_cast<std::uint16_t>(slot[i]);
+                }
+                std::vector<std::size_t> again;
+                ok = ring.submit_and_wait(static_cast<unsigned>(active.size()), [&](std::uint64_t user_data, int res) {
+                    std::size_t i = static_cast<std::size_t>(user_data);
+                    FileBuffer &file = files[begin + i];
+                    if (res == -EINTR || res == -EAGAIN)
+                    {
+                        again.push_back(i);
+                        return;
+                    }
+                    if (res < 0)
+                    {
+                        file.error = -res;
+                        return;
+                    }
+                    std::size_t requested = file.contents.size() - filled[i];
+                    filled[i] += static_cast<std::size_t>(res);
+                    bool sized = statx_result[i] == 0 && S_ISREG(sizes[i].stx_mode) && sizes[i].stx_size > 0;
+                    if (res == 0 || (sized && static_cast<std::size_t>(res) < requested))
+                    {
+                        return;
+                    }
+                    if (filled[i] == file.contents.size())
+                    {
+                        file.contents.resize(file.contents.size() * 2); // The file grew since statx
+                    }
+                    again.push_back(i);
+                });
+                if (fixed && first_round)
+                {
+                    ring.unregister_buffers();
+                }
+                first_round = false;
+                active.swap(again);
+            }
+
+            // A ring that failed during the reads may hold unsubmitted entries, so its files are closed directly
+            unsigned closes = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (fds[i] < 0)
+                {
+                    continue;
+                }
+                if (!ok)
+                {
+                    ::close(fds[i]);
+                    continue;
+                }
+                io_uring_sqe *close = ring.next_sqe(i);
+                close->opcode = IORING_OP_CLOSE;
+                close->fd = fds[i];
+                ++closes;
+            }
+            bool closed = closes == 0 || ring.submit_and_wait(closes, [](std::uint64_t, int) {});
+            stats.read += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - opened);
+            if (!ok || !closed)
+            {
+                return false;
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                FileBuffer &file = files[begin + i];
+                file.contents.resize(file.error ? 0 : filled[i]);
+            }
+            return true;
+        }
+#endif
+    } // namespace batch_io
+
+    // Reads every file in `paths` in full. Failures are reported per file; the call itself never fails
+    inline std::vector<FileBuffer> read_files(const std::vector<std::string> &paths, const BatchLoadOptions &options = BatchLoadOptions{},
+                                              BatchReadStats *stats = nullptr)
+    {
+        std::vector<FileBuffer> files(paths.size());
+        for (std::size_t i = 0; i < paths.size(); ++i)
+        {
+            files[i].path = paths[i];
+        }
+        BatchReadStats local;
+        BatchReadStats &out = stats ? *stats : local;
+        out = BatchReadStats{};
+        out.files = files.size();
+        std::size_t done = 0;
+
+#ifdef CONFIG_MANAGER_HAS_IO_URING
+        bool want_uring = options.backend == FileIoBackend::IO_URING ||
+                          (options.backend == FileIoBackend::AUTO && files.size() >= kMinUringBatch);
+        if (want_uring && !files.empty())
+        {
+            batch_io::Ring ring(batch_io::kRingEntries);
+            ++out.syscalls;
+            bool supported = ring.ok() && ring.supports({IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE});
+            if (supported)
+            {
+                out.backend = FileIoBackend::IO_URING;
+                out.registered_buffers = options.registered_buffers;
+                std::size_t batch = ring.entries() / 2;
+                while (done < files.size())
+                {
+                    std::size_t end = std::min(files.size(), done + batch);
+                    if (!batch_io::uring_read_batch(ring, files, done, end, options.registered_buffers, out))
+                    {
+                        for (std::size_t i = done; i < end; ++i)
+                        {
+                            files[i] = FileBuffer{files[i].path, std::string(), 0, false};
+                        }
+                        break; // The rest is read with POSIX calls
+                    }
+                    done = end;
+                }
+                out.uring_files = done;
+            }
+            out.syscalls += ring.syscalls();
+        }
+#else
+        (void)options;
+#endif
+
+        if (done < files.size())
+        {
+            out.backend = FileIoBackend::POSIX;
+            if (done == 0)
+            {
+                out.registered_buffers = false;
+            }
+            for (std::size_t i = done; i < files.size(); ++i)
+            {
+                batch_io::posix_read(files[i], out);
+            }
+        }
+        for (const auto &file : files)
+        {
+            out.bytes += file.contents.size();
+        }
+        return files;
+    }
+
+} // namespace config
+
+#endif // CONFIG_BATCH_IO_HPP
@@ -0,0 +1,315 @@
+/*
+    * config_convert.hpp
+    *
+    * Header-only typed conversions for configuration values.
+    * Parsers turn stored nlohmann::json values into typed values such as durations ("250ms", "1h30m")
+    * and byte sizes ("64MiB", "1.5GB"). Config::get_as, get_duration and get_bytes run a parser once
+    * per key and cache the result until the key is written again.
+    *
+    * Key Components:
+    * - parse_duration(): Parses a duration string into std::chrono::nanoseconds.
+    * - parse_byte_size(): Parses a byte size string into a byte count.
+    * - JsonParser, DurationParser, ByteSizeParser: Parser objects for Config::get_as.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Accepted formats:
+- Durations: one or more <number><unit> pairs, e.g. "250ms", "1.5s", "1h30m". Units: ns, us (or µs),
+  ms, s, m (or min), h, d. A plain JSON number is taken as milliseconds.
+- Byte sizes: <number>[unit], e.g. "512", "64MiB", "1.5GB". Decimal units: kB/KB, MB, GB, TB.
+  Binary units: KiB, MiB, GiB, TiB, and the short forms K, M, G, T (and Ki, Mi, Gi, Ti).
+  Units are case-insensitive. A plain JSON number is a byte count.
+- Parsers throw std::invalid_argument on malformed input. Byte sizes are exact up to 2^64 - 1 bytes
+  and throw std::out_of_range beyond it.
+*/
+
+// File: config_convert.hpp
+
+
+#ifndef CONFIG_CONVERT_HPP
+#define CONFIG_CONVERT_HPP
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    namespace convert
+    {
+        inline std::string lowercase(std::string_view text)
+        {
+            std::string lower(text);
+            for (auto &c : lower)
+            {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return lower;
+        }
+
+        inline std::string_view trim(std::string_view text)
+        {
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+            {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+            {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        // Takes the digits and at most one '.' at the start of `text`; empty unless a digit was seen
+        inline std::string_view read_number_text(std::string_view &text)
+        {
+            std::size_t length = 0;
+            bool digits = false;
+            bool dot = false;
+            while (length < text.size())
+            {
+                char c = text[length];
+                if (std::isdigit(static_cast<unsigned char>(c)))
+                {
+                    digits = true;
+                }
+                else if (c == '.' && !dot)
+                {
+                    dot = true;
+                }
+                else
+                {
+                    break;
+                }
+                ++length;
+            }
+            if (!digits)
+            {
+                return {};
+            }
+            std::string_view number = text.substr(0, length);
+            text.remove_prefix(length);
+            return number;
+        }
+
+        // Reads a non-negative decimal number at the start of `text`, advancing past it
+        inline bool read_number(std::string_view &text, double &value)
+        {
+            std::string_view number = read_number_text(text);
+            if (number.empty())
+            {
+                return false;
+            }
+            value = std::stod(std::string(number));
+            return true;
+        }
+
+        inline std::string_view read_unit(std::string_view &text)
+        {
+            std::size_t length = 0;
+            while (length < text.size() && !std::isdigit(static_cast<unsigned char>(text[length])) && text[length] != '.'
+                   && !std::isspace(static_cast<unsigned char>(text[length])))
+            {
+                ++length;
+            }
+            std::string_view unit = text.substr(0, length);
+            text.remove_prefix(length);
+            return unit;
+        }
+    } // namespace convert
+
+    inline std::chrono::nanoseconds parse_duration(std::string_view text)
+    {
+        std::string_view rest = convert::trim(text);
+        if (rest.empty())
+        {
+            throw std::invalid_argument("Empty duration");
+        }
+        double total_ns = 0.0;
+        while (!rest.empty())
+        {
+            double value = 0.0;
+            if (!convert::read_number(rest, value))
+            {
+                throw std::invalid_argument("Invalid duration: " + std::string(text));
+            }
+            std::string unit = convert::lowercase(convert::read_unit(rest));
+            double scale = 0.0;
+            if (unit == "ns")
+            {
+                scale = 1.0;
+            }
+            else if (unit == "us" || unit == "\xC2\xB5s")
+            {
+                scale = 1e3;
+            }
+            else if (unit == "ms")
+            {
+                scale = 1e6;
+            }
+            else if (unit == "s")
+            {
+                scale = 1e9;
+            }
+            else if (unit == "m" || unit == "min")
+            {
+                scale = 60e9;
+            }
+            else if (unit == "h")
+            {
+                scale = 3600e9;
+            }
+            else if (unit == "d")
+            {
+                scale = 86400e9;
+            }
+            else
+            {
+                throw std::invalid_argument("Invalid duration unit '" + unit + "' in: " + std::string(text));
+            }
+            total_ns += value * scale;
+            rest = convert::trim(rest);
+        }
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(std::llround(total_ns)));
+    }
+
+    inline std::uint64_t parse_byte_size(std::string_view text)
+    {
+        std::string_view rest = convert::trim(text);
+        std::string_view number = convert::read_number_text(rest);
+        if (number.empty())
+        {
+            throw std::invalid_argument("Invalid byte size: " + std::string(text));
+        }
+        std::string unit = convert::lowercase(convert::trim(rest));
+        std::uint64_t scale = 0;
+        if (unit.empty() || unit == "b")
+        {
+            scale = 1;
+        }
+        else if (unit == "kb")
+        {
+            scale = 1000;
+        }
+        else if (unit == "mb")
+        {
+            scale = 1000 * 1000;
+        }
+        else if (unit == "gb")
+        {
+            scale = 1000 * 1000 * 1000;
+        }
+        else if (unit == "tb")
+        {
+            scale = 1000ull * 1000 * 1000 * 1000;
+        }
+        else if (unit == "k" || unit == "ki" || unit == "kib")
+        {
+            scale = 1024;
+        }
+        else if (unit == "m" || unit == "mi" || unit == "mib")
+        {
+            scale = 1024 * 1024;
+        }
+        else if (unit == "g" || unit == "gi" || unit == "gib")
+        {
+            scale = 1024ull * 1024 * 1024;
+        }
+        else if (unit == "t" || unit == "ti" || unit == "tib")
+        {
+            scale = 1024ull * 1024 * 1024 * 1024;
+        }
+        else
+        {
+            throw std::invalid_argument("Invalid byte size unit '" + unit + "' in: " + std::string(text));
+        }
+        // The integer part is exact; only a fraction goes through a double, and it adds less than `scale`
+        std::size_t dot = number.find('.');
+        std::uint64_t whole = 0;
+        if (dot != 0)
+        {
+            std::string_view digits = number.substr(0, dot);
+            if (std::from_chars(digits.data(), digits.data() + digits.size(), whole).ec != std::errc())
+            {
+                throw std::out_of_range("Byte size out of range: " + std::string(text));
+            }
+        }
+        if (whole > std::numeric_limits<std::uint64_t>::max() / scale)
+        {
+            throw std::out_of_range("Byte size out of range: " + std::string(text));
+        }
+        std::uint64_t bytes = whole * scale;
+        if (dot != std::string_view::npos && dot + 1 < number.size())
+        {
+            double fraction = std::stod("0" + std::string(number.substr(dot)));
+            auto extra = static_cast<std::uint64_t>(std::llround(fraction * static_cast<double>(scale)));
+            if (extra > std::numeric_limits<std::uint64_t>::max() - bytes)
+            {
+                throw std::out_of_range("Byte size out of range: " + std::string(text));
+            }
+            bytes += extra;
+        }
+        return bytes;
+    }
+
+    // Default parser for get_as: nlohmann's own conversion
+    template <typename T>
+    struct JsonParser
+    {
+        T operator()(const nlohmann::json &value) const
+        {
+            return value.get<T>();
+        }
+    };
+
+    struct DurationParser
+    {
+        std::chrono::nanoseconds operator()(const nlohmann::json &value) const
+        {
+            if (value.is_number())
+            {
+                return std::chrono::nanoseconds(static_cast<std::int64_t>(std::llround(value.get<double>() * 1e6)));
+            }
+            if (value.is_string())
+            {
+                return parse_duration(value.get_ref<const std::string &>());
+            }
+            throw std::invalid_argument("Expected a duration string or number, got " + std::string(value.type_name()));
+        }
+    };
+
+    struct ByteSizeParser
+    {
+        std::uint64_t operator()(const nlohmann::json &value) const
+        {
+            if (value.is_number_unsigned() || (value.is_number_integer() && value.get<std::int64_t>() >= 0))
+            {
+                return value.get<std::uint64_t>();
+            }
+            if (value.is_string())
+            {
+                return parse_byte_size(value.get_ref<const std::string &>());
+            }
+            throw std::invalid_argument("Expected a byte size string or non-negative integer, got " + std::string(value.type_name()));
+        }
+    };
+
+} // namespace config
+
+#endif // CONFIG_CONVERT_HPP
@@ -0,0 +1,88 @@
+/*
+    * config_derived.hpp
+    *
+    * Header-only types for derived configuration keys.
+    * A derived key's value is a C++ function of other keys (pool_size = cores * per_core). Config stores
+    * the result as an ordinary entry, so reads stay a single hash lookup, and recomputes it only when one
+    * of its inputs changes, visiting affected keys in topological order.
+    *
+    * Key Components:
+    * - DerivedInputs class: The current input values handed to a derive function, by name or position.
+    * - DeriveFunction: std::function computing the derived value from its inputs.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+config.define_derived("pool_size", {"cores", "per_core"}, [](const DerivedInputs &in) {
+    return in["cores"].get<int>() * in["per_core"].get<int>();
+});
+config.set("cores", 8);      // pool_size is recomputed
+config.get("pool_size");     // Plain lookup
+
+Rules:
+- A derived key exists only while all of its inputs exist; it is removed when one goes away.
+- Inputs may be other derived keys. Definitions that would form a cycle throw std::invalid_argument.
+- A derived key is only recomputed when an input's value actually changed, and its dependents only
+  when its own value changed.
+- Derived keys cannot be set directly, and loads and load_from_env skip them. Derive functions run
+  with the Config lock held and must not call back into the same Config. If one throws, the old value
+  is kept and Config::derived_error(key) returns the exception's message until a later call succeeds.
+*/
+
+// File: config_derived.hpp
+
+
+#ifndef CONFIG_DERIVED_HPP
+#define CONFIG_DERIVED_HPP
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    class DerivedInputs
+    {
+    public:
+        DerivedInputs(const std::vector<std::string> &names, const std::vector<const nlohmann::json *> &values)
+            : names_(names), values_(values) {}
+
+        std::size_t size() const { return values_.size(); }
+        const nlohmann::json &operator[](std::size_t index) const { return *values_.at(index); }
+
+        const nlohmann::json &operator[](std::string_view name) const
+        {
+            for (std::size_t i = 0; i < names_.size(); ++i)
+            {
+                if (names_[i] == name)
+                {
+                    return *values_[i];
+                }
+            }
+            throw std::invalid_argument("Not an input of this derived key: " + std::string(name));
+        }
+
+    private:
+        const std::vector<std::string> &names_;
+        const std::vector<const nlohmann::json *> &values_;
+    };
+
+    using DeriveFunction = std::function<nlohmann::json(const DerivedInputs &)>;
+
+} // namespace config
+
+#endif // CONFIG_DERIVED_HPP
@@ -0,0 +1,519 @@
+/*
+    * config_flags.hpp
+    *
+    * Header-only feature flag engine backed by a Config key.
+    * Flag definitions (kill switch, targeting rules, percentage rollouts) are compiled into an immutable
+    * FlagSet. Evaluation reads the current set from a per-thread cache validated by one atomic version,
+    * hashes the caller's entity ID for consistent rollouts, and neither locks nor allocates. When the
+    * backing key is set, loaded, cleared or removed, the set is rebuilt and swapped in atomically.
+    *
+    * Key Components:
+    * - FlagContext / FlagAttribute: Entity ID and attributes a flag is evaluated for (views, no copies).
+    * - FlagSet class: Compiled, immutable flag definitions.
+    * - FeatureFlags class: Binds a FlagSet to a Config key and evaluates flags by name or by FlagHandle.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Flag definitions (the value of the backing key, "feature_flags" by default):
+
+{
+    "feature_x": true,                          // Plain bool: on or off for everyone
+    "checkout_v2": {
+        "enabled": true,                        // Kill switch, default true
+        "rules": [                              // First matching rule decides
+            {"attribute": "tenant", "in": ["acme", "globex"], "serve": true},
+            {"attribute": "country", "not_in": ["DE"], "rollout": 50}
+        ],
+        "rollout": 10,                          // Percent of entities when no rule matches, default 100
+        "salt": "checkout_v2"                   // Hash salt, default the flag name
+    }
+}
+
+- A rule matches when the context attribute is (or, for not_in, is not) one of the listed values;
+  an attribute missing from the context never matches "in" and always matches "not_in". The
+  attribute "id" refers to the entity ID unless the context passes its own.
+- Rollouts accept two decimal places. An entity's bucket is a hash of salt and entity ID, so the same
+  entity keeps its answer across processes and as the percentage grows.
+- Unknown flags evaluate to false. Malformed definitions are reported on std::cerr and the previous
+  flag set stays active.
+
+Usage:
+
+auto flags = FeatureFlags::bind(config);
+static const FlagHandle checkout = flags->handle("checkout_v2");
+FlagAttribute attributes[] = {{"tenant", tenant}, {"country", country}};
+if (flags->enabled(checkout, FlagContext(user_id, attributes))) { ... }
+
+Flag sets are reference counted. Each thread caches the set it last used and swaps it for the
+current one, taking the lock once, on its first evaluation after a rebuild; a replaced set is freed
+when no thread holds it any more. The Config must outlive the FeatureFlags bound to it.
+*/
+
+// File: config_flags.hpp
+
+
+#ifndef CONFIG_FLAGS_HPP
+#define CONFIG_FLAGS_HPP
+
+#include "configuration.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace config
+{
+    struct FlagAttribute
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // Views only: the entity ID and attributes must outlive the evaluation
+    class FlagContext
+    {
+    public:
+        explicit FlagContext(std::string_view entity_id) : entity_id_(entity_id) {}
+        FlagContext(std::string_view entity_id, const FlagAttribute *attributes, std::size_t count)
+            : entity_id_(entity_id), attributes_(attributes), count_(count) {}
+        template <std::size_t N>
+        FlagContext(std::string_view entity_id, const FlagAttribute (&attributes)[N])
+            : entity_id_(entity_id), attributes_(attributes), count_(N) {}
+        FlagContext(std::string_view entity_id, const std::vector<FlagAttribute> &attributes)
+            : entity_id_(entity_id), attributes_(attributes.data()), count_(attributes.size()) {}
+
+        std::string_view entity_id() const { return entity_id_; }
+
+        const std::string_view *attribute(std::string_view name) const
+        {
+            for (std::size_t i = 0; i < count_; ++i)
+            {
+                if (attributes_[i].name == name)
+                {
+                    return &attributes_[i].value;
+                }
+            }
+            return name == "id" ? &entity_id_ : nullptr;
+        }
+
+    private:
+        std::string_view entity_id_;
+        const FlagAttribute *attributes_ = nullptr;
+        std::size_t count_ = 0;
+    };
+
+    // Index of a flag name registered with FeatureFlags::handle(); stable across rebuilds
+    struct FlagHandle
+    {
+        std::size_t id;
+    };
+
+    namespace flags
+    {
+        constexpr std::uint32_t kBuckets = 10000; // Rollout granularity: 0.01%
+
+        // FNV-1a over salt, ':' and the entity ID, finished with the splitmix64 mixer
+        inline std::uint32_t bucket(std::string_view salt, std::string_view entity_id)
+        {
+            std::uint64_t h = 14695981039346656037ULL;
+            auto feed = [&h](std::string_view bytes) {
+                for (unsigned char c : bytes)
+                {
+                    h = (h ^ c) * 1099511628211ULL;
+                }
+            };
+            feed(salt);
+            feed(":");
+            feed(entity_id);
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebULL;
+            h ^= h >> 31;
+            return static_cast<std::uint32_t>(h % kBuckets);
+        }
+
+        inline std::uint32_t threshold(const nlohmann::json &percent, const std::string &flag)
+        {
+            if (!percent.is_number() || percent.get<double>() < 0.0 || percent.get<double>() > 100.0)
+            {
+                throw std::invalid_argument("Flag '" + flag + "': rollout must be a number from 0 to 100");
+            }
+            return static_cast<std::uint32_t>(std::llround(percent.get<double>() * (kBuckets / 100)));
+        }
+    } // namespace flags
+
+    class FlagSet
+    {
+    public:
+        struct Rule
+        {
+            std::string attribute;
+            bool negate = false;                // not_in
+            std::vector<std::string> values;
+            bool serve = false;                 // Used when threshold is kNoRollout
+            std::uint32_t threshold = kNoRollout;
+        };
+
+        struct Flag
+        {
+            std::string name;
+            bool enabled = true;
+            std::string salt;
+            std::vector<Rule> rules;
+            std::uint32_t threshold = flags::kBuckets;
+        };
+
+        static constexpr std::uint32_t kNoRollout = ~0u;
+
+        FlagSet() = default;
+
+        // Throws std::invalid_argument on malformed definitions
+        explicit FlagSet(const nlohmann::json &definitions)
+        {
+            if (definitions.is_null())
+            {
+                return;
+            }
+            if (!definitions.is_object())
+            {
+                throw std::invalid_argument("Feature flags must be an object of flag definitions");
+            }
+            for (auto it = definitions.begin(); it != definitions.end(); ++it)
+            {
+                flags_.emplace(it.key(), compile(it.key(), it.value()));
+            }
+        }
+
+        const Flag *find(std::string_view name) const
+        {
+            auto it = flags_.find(name);
+            return it == flags_.end() ? nullptr : &it->second;
+        }
+
+        std::size_t size() const { return flags_.size(); }
+
+        static bool evaluate(const Flag &flag, const FlagContext &context)
+        {
+            if (!flag.enabled)
+            {
+                return false;
+            }
+            for (const Rule &rule : flag.rules)
+            {
+                const std::string_view *value = context.attribute(rule.attribute);
+                bool listed = false;
+                if (value)
+                {
+                    for (const std::string &candidate : rule.values)
+                    {
+                        if (candidate == *value)
+                        {
+                            listed = true;
+                            break;
+                        }
+                    }
+                }
+                if (listed != rule.negate)
+                {
+                    return rule.threshold == kNoRollout ? rule.serve : rolled_out(flag, rule.threshold, context);
+                }
+            }
+            return rolled_out(flag, flag.threshold, context);
+        }
+
+    private:
+        friend class FeatureFlags;
+
+        static bool rolled_out(const Flag &flag, std::uint32_t threshold, const FlagContext &context)
+        {
+            if (threshold >= flags::kBuckets)
+            {
+                return true;
+            }
+            return threshold != 0 && flags::bucket(flag.salt, context.entity_id()) < threshold;
+        }
+
+        static Flag compile(const std::string &name, const nlohmann::json &definition)
+        {
+            Flag flag;
+            flag.name = name;
+            flag.salt = name;
+            if (definition.is_boolean())
+            {
+                flag.enabled = definition.get<bool>();
+                return flag;
+            }
+            if (!definition.is_object())
+            {
+                throw std::invalid_argument("Flag '" + name + "' must be a bool or an object");
+            }
+            flag.enabled = definition.value("enabled", true);
+            flag.salt = definition.value("salt", name);
+            if (definition.contains("rollout"))
+            {
+                flag.threshold = flags::threshold(definition["rollout"], name);
+            }
+            for (const auto &entry : definition.value("rules", nlohmann::json::array()))
+            {
+                Rule rule;
+                rule.attribute = entry.value("attribute", "");
+                if (rule.attribute.empty())
+                {
+                    throw std::invalid_argument("Flag '" + name + "': every rule needs an attribute");
+                }
+                rule.negate = entry.contains("not_in");
+                const nlohmann::json &values = rule.negate ? entry["not_in"] : entry.value("in", nlohmann::json());
+                if (!values.is_array())
+                {
+                    throw std::invalid_argument("Flag '" + name + "': rules need an \"in\" or \"not_in\" array");
+                }
+                for (const auto &value : values)
+                {
+                    rule.values.push_back(value.is_string() ? value.get<std::string>() : value.dump());
+                }
+                if (entry.contains("rollout"))
+                {
+                    rule.threshold = flags::threshold(entry["rollout"], name);
+                }
+                else if (entry.contains("serve") && entry["serve"].is_boolean())
+                {
+                    rule.serve = entry["serve"].get<bool>();
+                }
+                else
+                {
+                    throw std::invalid_argument("Flag '" + name + "': rules need a boolean \"serve\" or a \"rollout\"");
+                }
+                flag.rules.push_back(std::move(rule));
+            }
+            return flag;
+        }
+
+        std::map<std::string, Flag, std::less<>> flags_; // Ordered for string_view lookups without C++20
+        std::vector<const Flag *> by_handle_; // Filled by FeatureFlags, indexed by FlagHandle::id
+    };
+
+    class FeatureFlags
+    {
+    public:
+        // Builds the flag set from `key` and rebuilds it whenever `key` is set on `config` or the config is
+        // reloaded (load_from_file and the other loads, load_from_env, clear, remove)
+        static std::shared_ptr<FeatureFlags> bind(Config &config, const std::string &key = "feature_flags")
+        {
+            std::shared_ptr<FeatureFlags> flags(new FeatureFlags(config, key));
+            flags->refresh();
+            std::weak_ptr<FeatureFlags> weak = flags;
+            config.add_change_listener([weak, key](const std::string &changed, const nlohmann::json &value) {
+                if (changed != key)
+                {
+                    return;
+                }
+                if (auto self = weak.lock())
+                {
+                    self->rebuild(value);
+                }
+            });
+            config.add_reload_listener([weak]() {
+                if (auto self = weak.lock())
+                {
+                    self->refresh();
+                }
+            });
+            return flags;
+        }
+
+        FeatureFlags(const FeatureFlags &) = delete;
+        FeatureFlags &operator=(const FeatureFlags &) = delete;
+
+        // Re-reads the backing key; only recompiles when the definitions changed
+        bool refresh()
+        {
+            nlohmann::json definitions;
+            if (config_.exists(key_))
+            {
+                definitions = config_.get(key_);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (definitions == source_)
+                {
+                    return true;
+                }
+            }
+            return rebuild(definitions);
+        }
+
+        // Compiles and publishes new definitions; on error the current set stays active
+        bool rebuild(const nlohmann::json &definitions)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            try
+            {
+                auto next = std::make_shared<FlagSet>(definitions);
+                source_ = definitions;
+                publish_locked(std::move(next));
+                return true;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error while compiling feature flags from '" << key_ << "': " << e.what() << std::endl;
+                return false;
+            }
+        }
+
+        // Registers a name once (e.g. in a static) for the fastest evaluation path
+        FlagHandle handle(const std::string &name)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = handles_.find(name);
+            if (it != handles_.end())
+            {
+                return {it->second};
+            }
+            FlagHandle handle{handle_names_.size()};
+            handles_.emplace(name, handle.id);
+            handle_names_.push_back(name);
+            publish_locked(std::make_shared<FlagSet>(source_));
+            return handle;
+        }
+
+        bool enabled(FlagHandle handle, const FlagContext &context) const
+        {
+            const FlagSet &set = current();
+            if (handle.id >= set.by_handle_.size() || !set.by_handle_[handle.id])
+            {
+                return false;
+            }
+            return FlagSet::evaluate(*set.by_handle_[handle.id], context);
+        }
+
+        bool enabled(std::string_view name, const FlagContext &context) const
+        {
+            const FlagSet::Flag *flag = current().find(name);
+            return flag && FlagSet::evaluate(*flag, context);
+        }
+
+        // Without targeting: kill switches and flags without rules or rollouts
+        bool enabled(std::string_view name) const
+        {
+            return enabled(name, FlagContext(std::string_view()));
+        }
+
+        std::size_t flag_count() const { return current().size(); }
+
+        // The current set, e.g. to evaluate several flags against one consistent version
+        std::shared_ptr<const FlagSet> snapshot() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return current_;
+        }
+
+    private:
+        struct CachedSet
+        {
+            std::uint64_t flags;
+            std::uint64_t version;
+            std::shared_ptr<const FlagSet> set;
+        };
+
+        static constexpr std::size_t kThreadSets = 8;
+
+        FeatureFlags(Config &config, const std::string &key) : config_(config), key_(key), id_(next_id())
+        {
+            publish_locked(std::make_shared<FlagSet>());
+        }
+
+        // Ids are never reused, so a cached set cannot outlive its FeatureFlags into a new one at the same address
+        static std::uint64_t next_id()
+        {
+            static std::atomic<std::uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // The calling thread's cached set; refreshed under the lock only when a rebuild published a new version
+        const FlagSet &current() const
+        {
+            // Trivial, so reading it costs no TLS initialization check; `set` is owned by the front of `sets`
+            struct LastUsed
+            {
+                std::uint64_t flags;
+                std::uint64_t version;
+                const FlagSet *set;
+            };
+            thread_local LastUsed last{0, 0, nullptr};
+            std::uint64_t version = version_.load(std::memory_order_acquire);
+            if (last.flags == id_ && last.version == version)
+            {
+                return *last.set;
+            }
+            // Each thread keeps the sets of the FeatureFlags it used most recently, front first
+            thread_local std::vector<CachedSet> sets;
+            auto it = std::find_if(sets.begin(), sets.end(), [this](const CachedSet &cached) { return cached.flags == id_; });
+            if (it == sets.end())
+            {
+                if (sets.size() >= kThreadSets)
+                {
+                    sets.pop_back();
+                }
+                it = sets.insert(sets.begin(), CachedSet{id_, 0, nullptr});
+            }
+            else if (it != sets.begin())
+            {
+                std::rotate(sets.begin(), it, it + 1);
+                it = sets.begin();
+            }
+            if (!it->set || it->version != version)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                it->set = current_;
+                it->version = version_.load(std::memory_order_relaxed);
+            }
+            last = LastUsed{id_, it->version, it->set.get()};
+            return *it->set;
+        }
+
+        // Caller must hold mutex_
+        void publish_locked(std::shared_ptr<FlagSet> next)
+        {
+            next->by_handle_.resize(handle_names_.size());
+            for (std::size_t id = 0; id < handle_names_.size(); ++id)
+            {
+                next->by_handle_[id] = next->find(handle_names_[id]);
+            }
+            current_ = std::move(next);
+            version_.fetch_add(1, std::memory_order_release);
+        }
+
+        Config &config_;
+        std::string key_;
+        const std::uint64_t id_;
+        mutable std::mutex mutex_;
+        nlohmann::json source_;
+        std::unordered_map<std::string, std::size_t> handles_;
+        std::vector<std::string> handle_names_;
+        std::shared_ptr<const FlagSet> current_;   // Guarded by mutex_; threads cache it until version_ moves
+        std::atomic<std::uint64_t> version_{0};
+    };
+
+} // namespace config
+
+#endif // CONFIG_FLAGS_HPP
@@ -0,0 +1,202 @@
+/*
+    * config_intern.hpp
+    *
+    * Header-only hash-consing of configuration values.
+    * A ValueInterner keeps one immutable copy of each distinct structured value (object or array) it
+    * has seen, keyed by a structural hash. Config instances with interning enabled store such values as
+    * shared pointers to the canonical copy, so identical blocks loaded into many instances (per-tenant
+    * rate limits, backend lists) occupy memory once. Writes replace the pointer, never the shared value.
+    *
+    * Key Components:
+    * - InternOptions struct: Minimum value size worth sharing.
+    * - InternStats struct: Distinct values, references, lookups, and bytes saved by sharing.
+    * - ValueInterner class: Thread-safe pool of canonical values; ValueInterner::global() is process-wide.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+Config::instance("tenant_a").enable_interning();   // Uses ValueInterner::global()
+Config::instance("tenant_b").enable_interning();
+... load both ...
+std::cout << ValueInterner::global()->stats().saved_bytes << " bytes saved\n";
+
+Values are shared per top-level key: a key's whole value is interned when it is an object or array of
+at least InternOptions::min_bytes heap bytes. The pool holds weak references, so a value is freed
+as soon as no Config uses it any more.
+*/
+
+// File: config_intern.hpp
+
+
+#ifndef CONFIG_INTERN_HPP
+#define CONFIG_INTERN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "config_memory.hpp"
+
+namespace config
+{
+    struct InternOptions
+    {
+        std::size_t min_bytes = 256; // Smaller values are cheaper to copy than to hash and share
+    };
+
+    struct InternStats
+    {
+        std::size_t values = 0;       // Distinct live values in the pool
+        std::size_t references = 0;   // Stored references to them
+        std::uint64_t lookups = 0;    // intern() calls for values large enough to share
+        std::uint64_t hits = 0;       // Lookups answered with an existing value
+        std::size_t unique_bytes = 0; // Heap bytes of the distinct values
+        std::size_t saved_bytes = 0;  // Heap bytes the extra references would have needed as copies
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"values", values},
+                {"references", references},
+                {"lookups", lookups},
+                {"hits", hits},
+                {"unique_bytes", unique_bytes},
+                {"saved_bytes", saved_bytes}
+            };
+        }
+    };
+
+    class ValueInterner
+    {
+    public:
+        explicit ValueInterner(InternOptions options = InternOptions{}) : options_(options) {}
+
+        static std::shared_ptr<ValueInterner> global()
+        {
+            static std::shared_ptr<ValueInterner> interner = std::make_shared<ValueInterner>();
+            return interner;
+        }
+
+        static std::size_t heap_bytes(const nlohmann::json &value)
+        {
+            return memory::value_heap_bytes(value);
+        }
+
+        // The canonical copy of `value`, moving it into the pool if it is new. Returns nullptr (and leaves
+        // `value` alone) for scalars and values smaller than min_bytes.
+        std::shared_ptr<const nlohmann::json> intern(nlohmann::json &value)
+        {
+            if (!value.is_structured())
+            {
+                return nullptr;
+            }
+            std::size_t bytes = heap_bytes(value);
+            if (bytes < options_.min_bytes)
+            {
+                return nullptr;
+            }
+            std::size_t hash = std::hash<nlohmann::json>{}(value);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++lookups_;
+            auto &bucket = table_[hash];
+            for (auto it = bucket.begin(); it != bucket.end();)
+            {
+                std::shared_ptr<const nlohmann::json> existing = it->value.lock();
+                if (!existing)
+                {
+                    it = bucket.erase(it);
+                    continue;
+                }
+                if (*existing == value)
+                {
+                    ++hits_;
+                    return existing;
+                }
+                ++it;
+            }
+            auto shared = std::make_shared<const nlohmann::json>(std::move(value));
+            bucket.push_back({shared, bytes});
+            if (++inserts_since_prune_ >= 1024)
+            {
+                prune_locked();
+            }
+            return shared;
+        }
+
+        InternStats stats() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            InternStats stats;
+            stats.lookups = lookups_;
+            stats.hits = hits_;
+            for (const auto &[hash, bucket] : table_)
+            {
+                for (const auto &entry : bucket)
+                {
+                    long users = entry.value.use_count();
+                    if (users == 0)
+                    {
+                        continue;
+                    }
+                    ++stats.values;
+                    stats.references += static_cast<std::size_t>(users);
+                    stats.unique_bytes += entry.bytes;
+                    stats.saved_bytes += static_cast<std::size_t>(users - 1) * entry.bytes;
+                }
+            }
+            return stats;
+        }
+
+        // Drops pool entries whose values are no longer referenced
+        void prune()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            prune_locked();
+        }
+
+    private:
+        struct Entry
+        {
+            std::weak_ptr<const nlohmann::json> value;
+            std::size_t bytes;
+        };
+
+        void prune_locked()
+        {
+            inserts_since_prune_ = 0;
+            for (auto it = table_.begin(); it != table_.end();)
+            {
+                auto &bucket = it->second;
+                bucket.erase(std::remove_if(bucket.begin(), bucket.end(), [](const Entry &entry) { return entry.value.expired(); }), bucket.end());
+                it = bucket.empty() ? table_.erase(it) : std::next(it);
+            }
+        }
+
+        InternOptions options_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::size_t, std::vector<Entry>> table_;
+        std::uint64_t lookups_ = 0;
+        std::uint64_t hits_ = 0;
+        std::size_t inserts_since_prune_ = 0;
+    };
+
+} // namespace config
+
+#endif // CONFIG_INTERN_HPP
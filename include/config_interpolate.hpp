@@ -0,0 +1,130 @@
+/*
+    * config_interpolate.hpp
+    *
+    * Header-only template parsing for ${key} interpolation in configuration values.
+    * Config::get_interpolated expands "${key}" references to other keys (and "${env:NAME}" references
+    * to environment variables when enabled) on first read, memoizes the result, and records which keys
+    * each result depends on so a write invalidates only the results that referenced it.
+    *
+    * Key Components:
+    * - InterpolationOptions struct: Environment access and nesting limit.
+    * - TemplatePart struct / parse_template(): Splits a string into literal text and references.
+    *
+    * External Dependencies:
+    * - None
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Syntax:
+- "${name}" is replaced by the interpolated value of key `name`. A string that is exactly one
+  reference takes the referenced value's type ("${port}" -> 5432); otherwise values are spliced
+  in as text (strings unquoted, everything else as compact JSON).
+- "${env:NAME}" reads environment variable NAME (only with InterpolationOptions::allow_env).
+- "$${" produces a literal "${".
+Strings nested in objects and arrays are expanded too. Unknown keys, unset variables, cycles and
+unterminated references throw std::invalid_argument.
+*/
+
+// File: config_interpolate.hpp
+
+
+#ifndef CONFIG_INTERPOLATE_HPP
+#define CONFIG_INTERPOLATE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace config
+{
+    struct InterpolationOptions
+    {
+        bool allow_env = false;     // Resolve ${env:NAME}; environment values are memoized like keys
+        std::size_t max_depth = 64; // Longest chain of references followed before giving up
+    };
+
+    struct TemplatePart
+    {
+        enum class Kind
+        {
+            TEXT,
+            KEY,
+            ENV
+        };
+        Kind kind;
+        std::string text; // Literal text, key name or variable name
+    };
+
+    inline bool has_references(std::string_view text)
+    {
+        return text.find("${") != std::string_view::npos;
+    }
+
+    inline std::vector<TemplatePart> parse_template(std::string_view text)
+    {
+        std::vector<TemplatePart> parts;
+        std::string literal;
+        std::size_t pos = 0;
+        while (pos < text.size())
+        {
+            std::size_t open = text.find('$', pos);
+            if (open == std::string_view::npos)
+            {
+                literal.append(text.substr(pos));
+                break;
+            }
+            literal.append(text.substr(pos, open - pos));
+            if (text.substr(open, 3) == "$${")
+            {
+                literal.append("${");
+                pos = open + 3;
+                continue;
+            }
+            if (text.substr(open, 2) != "${")
+            {
+                literal.push_back('$');
+                pos = open + 1;
+                continue;
+            }
+            std::size_t close = text.find('}', open + 2);
+            if (close == std::string_view::npos)
+            {
+                throw std::invalid_argument("Unterminated reference in: " + std::string(text));
+            }
+            std::string_view name = text.substr(open + 2, close - open - 2);
+            TemplatePart part{TemplatePart::Kind::KEY, std::string(name)};
+            if (name.substr(0, 4) == "env:")
+            {
+                part.kind = TemplatePart::Kind::ENV;
+                part.text = std::string(name.substr(4));
+            }
+            if (part.text.empty())
+            {
+                throw std::invalid_argument("Empty reference in: " + std::string(text));
+            }
+            if (!literal.empty())
+            {
+                parts.push_back({TemplatePart::Kind::TEXT, std::move(literal)});
+                literal.clear();
+            }
+            parts.push_back(std::move(part));
+            pos = close + 1;
+        }
+        if (!literal.empty())
+        {
+            parts.push_back({TemplatePart::Kind::TEXT, std::move(literal)});
+        }
+        return parts;
+    }
+
+} // namespace config
+
+#endif // CONFIG_INTERPOLATE_HPP
@@ -0,0 +1,347 @@
+/*
+    * config_lazy.hpp
+    *
+    * Header-only support for lazily parsed JSON documents.
+    * A lazy load reads the file, runs one structural scan that records where each top-level value starts
+    * and ends, and stores those byte ranges instead of parsed values. Config parses a value the first
+    * time it is read and keeps the result, so startup time and memory follow the keys a process actually
+    * uses rather than the size of the file.
+    *
+    * Key Components:
+    * - MappedDocument class: Read-only view of a whole file, memory-mapped or read into a private copy.
+    * - RawSlice struct / scan_top_level(): Byte ranges of the values of a top-level JSON object.
+    * - LazyValue struct: A slice of a shared document and, once read, its parsed value.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    * - POSIX mmap
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+config.set_lazy_loading(true);
+config.load_from_file("huge.json");   // Scans structure only
+config.get("db");                     // Parses the "db" value now, then serves it from memory
+
+Rules:
+- Only JSON files are loaded lazily; YAML is always parsed up front.
+- The scan checks the top-level object, the keys and that brackets and strings are balanced. Errors
+  inside a value (a misspelled literal, mismatched bracket kinds) surface when the key is first read,
+  as std::invalid_argument.
+- Later duplicates of a key win, as in a full parse.
+- The document is a private copy of the file, so the file can be rewritten or removed while keys
+  are still unparsed.
+*/
+
+// File: config_lazy.hpp
+
+
+#ifndef CONFIG_LAZY_HPP
+#define CONFIG_LAZY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    class MappedDocument
+    {
+    public:
+        // Returns nullptr when the file cannot be opened; files mmap refuses (empty, special) are read instead.
+        // Only for files nobody else writes: truncating a mapped file makes later reads fault.
+        static std::shared_ptr<const MappedDocument> open(const std::string &file_path)
+        {
+            int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            std::shared_ptr<MappedDocument> document(new MappedDocument());
+            struct stat info;
+            if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+            {
+                void *data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                    document->mapped_ = data;
+                    document->view_ = std::string_view(static_cast<const char *>(data), static_cast<std::size_t>(info.st_size));
+                    ::close(fd);
+                    return document;
+                }
+            }
+            return read_into(fd, document);
+        }
+
+        // Reads a private copy, so later rewrites or truncation of the file cannot affect the document
+        static std::shared_ptr<const MappedDocument> read(const std::string &file_path)
+        {
+            int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            std::shared_ptr<MappedDocument> document(new MappedDocument());
+            struct stat info;
+            if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+            {
+                document->owned_.reserve(static_cast<std::size_t>(info.st_size));
+            }
+            return read_into(fd, document);
+        }
+
+        ~MappedDocument()
+        {
+            if (mapped_)
+            {
+                ::munmap(mapped_, view_.size());
+            }
+        }
+
+        MappedDocument(const MappedDocument &) = delete;
+        MappedDocument &operator=(const MappedDocument &) = delete;
+
+        std::string_view contents() const { return view_; }
+        bool is_mapped() const { return mapped_ != nullptr; }
+
+    private:
+        MappedDocument() = default;
+
+        // Reads the rest of `fd` into the document and closes it
+        static std::shared_ptr<const MappedDocument> read_into(int fd, const std::shared_ptr<MappedDocument> &document)
+        {
+            char buffer[65536];
+            ssize_t n;
+            while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+            {
+                document->owned_.append(buffer, static_cast<std::size_t>(n));
+            }
+            ::close(fd);
+            if (n < 0)
+            {
+                return nullptr;
+            }
+            document->view_ = document->owned_;
+            return document;
+        }
+
+        void *mapped_ = nullptr;
+        std::string owned_;
+        std::string_view view_;
+    };
+
+    struct RawSlice
+    {
+        std::string key;
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    namespace lazy
+    {
+        inline bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        inline std::size_t skip_space(std::string_view doc, std::size_t pos)
+        {
+            while (pos < doc.size() && is_space(doc[pos]))
+            {
+                ++pos;
+            }
+            return pos;
+        }
+
+        // doc[pos] == '"'; returns the index just past the closing quote, or npos if unterminated
+        inline std::size_t skip_string(std::string_view doc, std::size_t pos)
+        {
+            for (++pos; pos < doc.size(); ++pos)
+            {
+                if (doc[pos] == '\\')
+                {
+                    ++pos;
+                }
+                else if (doc[pos] == '"')
+                {
+                    return pos + 1;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+        // Returns the index just past the value starting at doc[pos], or npos if it is not balanced
+        inline std::size_t skip_value(std::string_view doc, std::size_t pos)
+        {
+            char c = doc[pos];
+            if (c == '"')
+            {
+                return skip_string(doc, pos);
+            }
+            if (c == '{' || c == '[')
+            {
+                std::size_t depth = 0;
+                while (pos < doc.size())
+                {
+                    c = doc[pos];
+                    if (c == '"')
+                    {
+                        pos = skip_string(doc, pos);
+                        if (pos == std::string_view::npos)
+                        {
+                            return pos;
+                        }
+                        continue;
+                    }
+                    if (c == '{' || c == '[')
+                    {
+                        ++depth;
+                    }
+                    else if (c == '}' || c == ']')
+                    {
+                        if (--depth == 0)
+                        {
+                            return pos + 1;
+                        }
+                    }
+                    ++pos;
+                }
+                return std::string_view::npos;
+            }
+            std::size_t start = pos;
+            while (pos < doc.size() && doc[pos] != ',' && doc[pos] != '}' && doc[pos] != ']' && !is_space(doc[pos]))
+            {
+                ++pos;
+            }
+            return pos == start ? std::string_view::npos : pos;
+        }
+    } // namespace lazy
+
+    // Records the key and value range of every member of the top-level object in `doc`. On malformed
+    // structure returns false with `error_offset` at the offending byte
+    inline bool scan_top_level(std::string_view doc, std::vector<RawSlice> &slices, std::size_t &error_offset)
+    {
+        using namespace lazy;
+        std::size_t pos = doc.substr(0, 3) == "\xEF\xBB\xBF" ? 3 : 0;
+        pos = skip_space(doc, pos);
+        auto fail = [&error_offset, &doc](std::size_t at) {
+            error_offset = std::min(at, doc.size());
+            return false;
+        };
+        if (pos == doc.size() || doc[pos] != '{')
+        {
+            return fail(pos);
+        }
+        pos = skip_space(doc, pos + 1);
+        if (pos < doc.size() && doc[pos] == '}')
+        {
+            return skip_space(doc, pos + 1) == doc.size() || fail(pos + 1);
+        }
+        while (true)
+        {
+            if (pos == doc.size() || doc[pos] != '"')
+            {
+                return fail(pos);
+            }
+            std::size_t key_end = skip_string(doc, pos);
+            if (key_end == std::string_view::npos)
+            {
+                return fail(pos);
+            }
+            std::string_view raw_key = doc.substr(pos + 1, key_end - pos - 2);
+            std::string key;
+            if (raw_key.find('\\') == std::string_view::npos)
+            {
+                key = std::string(raw_key);
+            }
+            else
+            {
+                try
+                {
+                    key = nlohmann::json::parse(doc.substr(pos, key_end - pos)).get<std::string>();
+                }
+                catch (const nlohmann::json::exception &)
+                {
+                    return fail(pos);
+                }
+            }
+            pos = skip_space(doc, key_end);
+            if (pos == doc.size() || doc[pos] != ':')
+            {
+                return fail(pos);
+            }
+            pos = skip_space(doc, pos + 1);
+            if (pos == doc.size())
+            {
+                return fail(pos);
+            }
+            std::size_t value_end = skip_value(doc, pos);
+            if (value_end == std::string_view::npos)
+            {
+                return fail(pos);
+            }
+            slices.push_back({std::move(key), pos, value_end - pos});
+            pos = skip_space(doc, value_end);
+            if (pos < doc.size() && doc[pos] == ',')
+            {
+                pos = skip_space(doc, pos + 1);
+                continue;
+            }
+            if (pos < doc.size() && doc[pos] == '}')
+            {
+                return skip_space(doc, pos + 1) == doc.size() || fail(pos + 1);
+            }
+            return fail(pos);
+        }
+    }
+
+    struct LazyValue
+    {
+        std::shared_ptr<const MappedDocument> document;
+        std::size_t offset = 0;
+        std::size_t length = 0;
+        mutable std::optional<nlohmann::json> value;
+        bool spilled = false; // Written out by a memory budget pass rather than loaded from a file
+
+        std::string_view raw() const { return document->contents().substr(offset, length); }
+
+        // Parses on first use; later calls return the cached value
+        const nlohmann::json &get(const std::string &key) const
+        {
+            if (!value)
+            {
+                std::string_view text = raw();
+                try
+                {
+                    value = nlohmann::json::parse(text.begin(), text.end());
+                }
+                catch (const nlohmann::json::parse_error &e)
+                {
+                    throw std::invalid_argument("Malformed value for configuration key '" + key + "' at offset " +
+                                                std::to_string(offset + (e.byte > 0 ? e.byte - 1 : 0)) + ": " + e.what());
+                }
+            }
+            return *value;
+        }
+    };
+
+} // namespace config
+
+#endif // CONFIG_LAZY_HPP
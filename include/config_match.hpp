@@ -0,0 +1,290 @@
+/*
+    * config_match.hpp
+    *
+    * Header-only key matchers for searching configuration keys.
+    * A KeyMatcher compiles a shell glob ("db.*.port", "cache.[ab]?") or a regular expression once and
+    * can then be matched against many keys. It also reports the literal prefix every match must start
+    * with, which Config::find_keys uses to scan only that range of its sorted key index.
+    *
+    * Key Components:
+    * - KeyMatcher class: Compiled glob or std::regex, with matches() and literal_prefix().
+    * - FindOptions struct: When and how wide Config::find_keys scans in parallel.
+    *
+    * External Dependencies:
+    * - None
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Glob syntax (the whole key must match):
+- `*` matches any run of characters, including '.'; `?` matches one character.
+- `[abc]`, `[a-z]` and `[!a-z]` (or `[^a-z]`) match one character from (or not from) a set.
+- `\` makes the next character literal.
+
+Regexes use std::regex (ECMAScript) with search semantics: "port" matches "db.port"; anchor with ^ and $.
+Only a leading "^" followed by literal characters produces a literal prefix, and only with the default
+flags: icase, multiline or another grammar disable it. Malformed patterns throw
+std::invalid_argument (globs) or std::regex_error (regexes).
+*/
+
+// File: config_match.hpp
+
+
+#ifndef CONFIG_MATCH_HPP
+#define CONFIG_MATCH_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace config
+{
+    struct FindOptions
+    {
+        std::size_t parallel_threshold = 65536; // Candidate keys needed before scanning on several threads
+        unsigned threads = 0;                   // 0 uses std::thread::hardware_concurrency()
+    };
+
+    class KeyMatcher
+    {
+    public:
+        static KeyMatcher glob(const std::string &pattern)
+        {
+            KeyMatcher matcher(pattern);
+            matcher.compile_glob();
+            return matcher;
+        }
+
+        static KeyMatcher regex(const std::string &pattern, std::regex::flag_type flags = std::regex::ECMAScript)
+        {
+            KeyMatcher matcher(pattern);
+            matcher.regex_ = std::make_shared<const std::regex>(pattern, flags | std::regex::optimize);
+            // The prefix scan assumes case-sensitive ECMAScript syntax with '^' anchored at the start of the key
+            const std::regex::flag_type changes_literals = std::regex::icase | std::regex::multiline | std::regex::basic | std::regex::extended |
+                                                           std::regex::awk | std::regex::grep | std::regex::egrep;
+            if ((flags & changes_literals) == 0)
+            {
+                matcher.prefix_ = regex_literal_prefix(pattern);
+            }
+            return matcher;
+        }
+
+        bool matches(std::string_view key) const
+        {
+            if (regex_)
+            {
+                return std::regex_search(key.begin(), key.end(), *regex_);
+            }
+            return match_glob(key);
+        }
+
+        const std::string &pattern() const { return pattern_; }
+        bool is_regex() const { return regex_ != nullptr; }
+
+        // Every matching key starts with this; empty when the pattern can match anywhere
+        const std::string &literal_prefix() const { return prefix_; }
+
+    private:
+        enum class TokenKind
+        {
+            CHAR,
+            ANY,
+            STAR,
+            SET
+        };
+
+        struct Token
+        {
+            TokenKind kind;
+            char c = 0;
+            std::bitset<256> set;
+
+            bool matches(char ch) const
+            {
+                switch (kind)
+                {
+                case TokenKind::CHAR: return ch == c;
+                case TokenKind::ANY: return true;
+                case TokenKind::SET: return set.test(static_cast<unsigned char>(ch));
+                case TokenKind::STAR: return false;
+                }
+                return false;
+            }
+        };
+
+        explicit KeyMatcher(const std::string &pattern) : pattern_(pattern) {}
+
+        void compile_glob()
+        {
+            const std::string &p = pattern_;
+            bool literal = true;
+            for (std::size_t i = 0; i < p.size(); ++i)
+            {
+                Token token{TokenKind::CHAR, 0, {}};
+                if (p[i] == '*')
+                {
+                    if (!tokens_.empty() && tokens_.back().kind == TokenKind::STAR)
+                    {
+                        continue;
+                    }
+                    token.kind = TokenKind::STAR;
+                }
+                else if (p[i] == '?')
+                {
+                    token.kind = TokenKind::ANY;
+                }
+                else if (p[i] == '[')
+                {
+                    token.kind = TokenKind::SET;
+                    i = parse_set(i, token.set);
+                }
+                else
+                {
+                    if (p[i] == '\\')
+                    {
+                        if (++i == p.size())
+                        {
+                            throw std::invalid_argument("Glob ends with an escape: " + p);
+                        }
+                    }
+                    token.c = p[i];
+                }
+                if (token.kind != TokenKind::CHAR)
+                {
+                    literal = false;
+                }
+                else if (literal)
+                {
+                    prefix_.push_back(token.c);
+                }
+                tokens_.push_back(token);
+            }
+        }
+
+        // Parses the set starting at p[open] == '[' and returns the index of its closing ']'
+        std::size_t parse_set(std::size_t open, std::bitset<256> &set) const
+        {
+            const std::string &p = pattern_;
+            std::size_t i = open + 1;
+            bool negate = i < p.size() && (p[i] == '!' || p[i] == '^');
+            if (negate)
+            {
+                ++i;
+            }
+            bool first = true;
+            for (; i < p.size() && (p[i] != ']' || first); ++i)
+            {
+                first = false;
+                unsigned char lo = static_cast<unsigned char>(p[i]);
+                unsigned char hi = lo;
+                if (i + 2 < p.size() && p[i + 1] == '-' && p[i + 2] != ']')
+                {
+                    hi = static_cast<unsigned char>(p[i + 2]);
+                    i += 2;
+                }
+                for (unsigned c = lo; c <= hi; ++c)
+                {
+                    set.set(c);
+                }
+            }
+            if (i == p.size())
+            {
+                throw std::invalid_argument("Unterminated '[' in glob: " + p);
+            }
+            if (negate)
+            {
+                set.flip();
+            }
+            return i;
+        }
+
+        // Iterative matching that backtracks only to the most recent '*'
+        bool match_glob(std::string_view key) const
+        {
+            const std::size_t n = tokens_.size();
+            std::size_t t = 0;
+            std::size_t k = 0;
+            std::size_t star_t = std::string::npos;
+            std::size_t star_k = 0;
+            while (k < key.size())
+            {
+                if (t < n && tokens_[t].kind == TokenKind::STAR)
+                {
+                    star_t = t++;
+                    star_k = k;
+                }
+                else if (t < n && tokens_[t].matches(key[k]))
+                {
+                    ++t;
+                    ++k;
+                }
+                else if (star_t != std::string::npos)
+                {
+                    t = star_t + 1;
+                    k = ++star_k;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            while (t < n && tokens_[t].kind == TokenKind::STAR)
+            {
+                ++t;
+            }
+            return t == n;
+        }
+
+        // Literal characters after a leading '^', stopping at the first metacharacter
+        static std::string regex_literal_prefix(const std::string &pattern)
+        {
+            std::string prefix;
+            if (pattern.empty() || pattern[0] != '^' || pattern.find('|') != std::string::npos)
+            {
+                return prefix;
+            }
+            const std::string meta = ".^$*+?()[]{}|\\";
+            for (std::size_t i = 1; i < pattern.size(); ++i)
+            {
+                char c = pattern[i];
+                if (c == '*' || c == '?' || c == '{')
+                {
+                    // The previous character is optional
+                    if (!prefix.empty())
+                    {
+                        prefix.pop_back();
+                    }
+                    break;
+                }
+                if (c == '\\' && i + 1 < pattern.size() && meta.find(pattern[i + 1]) != std::string::npos)
+                {
+                    c = pattern[++i];
+                }
+                else if (meta.find(c) != std::string::npos)
+                {
+                    break;
+                }
+                prefix.push_back(c);
+            }
+            return prefix;
+        }
+
+        std::string pattern_;
+        std::string prefix_;
+        std::vector<Token> tokens_;
+        std::shared_ptr<const std::regex> regex_;
+    };
+
+} // namespace config
+
+#endif // CONFIG_MATCH_HPP
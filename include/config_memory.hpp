@@ -0,0 +1,228 @@
+/*
+    * config_memory.hpp
+    *
+    * Header-only memory accounting for Config instances.
+    * Walks stored nlohmann::json values and estimates the heap bytes they own, including json node,
+    * std::map/std::vector container and std::string overhead, plus the hash table holding the
+    * top-level keys. Results are broken down per top-level key and per value type.
+    *
+    * Key Components:
+    * - MemoryUsage struct: Per-instance totals with per-key and per-type breakdowns.
+    * - RegistryMemoryUsage struct: Totals for every Config::instance entry.
+    * - memory namespace: Allocation size estimates and the json walker.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Estimation model:
+- Every heap allocation is rounded the way glibc malloc does on 64-bit targets: 8 bytes of chunk
+  header, 16-byte alignment, 32-byte minimum. Other allocators differ by a few bytes per block.
+- A json value is 16 bytes inline. Objects, arrays, strings and binaries allocate their container
+  separately; object members are std::map nodes (32 bytes of tree links plus the key/value pair).
+- Strings that fit the small-string buffer own no heap memory.
+- Top-level entries are std::unordered_map nodes (next pointer, key/value pair, cached hash) plus
+  the bucket array.
+*/
+
+// File: config_memory.hpp
+
+
+#ifndef CONFIG_MEMORY_HPP
+#define CONFIG_MEMORY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    struct TypeMemoryUsage
+    {
+        std::size_t count = 0;  // Values of this type, at any depth
+        std::size_t bytes = 0;  // Heap bytes owned directly by those values
+    };
+
+    struct KeyMemoryUsage
+    {
+        std::string key;
+        std::string type;
+        std::size_t bytes = 0;  // Hash node, key string and the whole value tree
+        std::size_t nodes = 0;  // json values in the tree
+    };
+
+    struct MemoryUsage
+    {
+        std::size_t total_bytes = 0;
+        std::size_t instance_bytes = 0;     // sizeof(Config)
+        std::size_t table_bytes = 0;        // Bucket array and hash nodes
+        std::size_t key_bytes = 0;          // Heap memory of top-level key strings
+        std::size_t value_bytes = 0;        // Heap memory owned by the json values
+        std::size_t other_bytes = 0;        // Listeners, environment overrides, version string
+        std::size_t json_nodes = 0;
+        std::vector<KeyMemoryUsage> keys;   // Largest first
+        std::map<std::string, TypeMemoryUsage> types;
+
+        nlohmann::json to_json(std::size_t top_keys = 20) const
+        {
+            nlohmann::json j = {
+                {"total_bytes", total_bytes},
+                {"instance_bytes", instance_bytes},
+                {"table_bytes", table_bytes},
+                {"key_bytes", key_bytes},
+                {"value_bytes", value_bytes},
+                {"other_bytes", other_bytes},
+                {"json_nodes", json_nodes},
+                {"keys", nlohmann::json::array()},
+                {"types", nlohmann::json::object()}
+            };
+            for (std::size_t i = 0; i < keys.size() && i < top_keys; ++i)
+            {
+                j["keys"].push_back({{"key", keys[i].key}, {"type", keys[i].type}, {"bytes", keys[i].bytes}, {"nodes", keys[i].nodes}});
+            }
+            for (const auto &[type, usage] : types)
+            {
+                j["types"][type] = {{"count", usage.count}, {"bytes", usage.bytes}};
+            }
+            return j;
+        }
+    };
+
+    struct RegistryMemoryUsage
+    {
+        std::size_t total_bytes = 0;
+        std::vector<std::pair<std::string, MemoryUsage>> instances;  // Largest first
+
+        nlohmann::json to_json(std::size_t top_keys = 5) const
+        {
+            nlohmann::json j = {{"total_bytes", total_bytes}, {"instances", nlohmann::json::object()}};
+            for (const auto &[name, usage] : instances)
+            {
+                j["instances"][name] = usage.to_json(top_keys);
+            }
+            return j;
+        }
+    };
+
+    namespace memory
+    {
+        // Bytes malloc reserves for a request of `requested` bytes (glibc, 64-bit)
+        inline std::size_t allocation_size(std::size_t requested)
+        {
+            if (requested == 0)
+            {
+                return 0;
+            }
+            return std::max<std::size_t>(32, (requested + 8 + 15) & ~static_cast<std::size_t>(15));
+        }
+
+        inline std::size_t string_heap_bytes(const std::string &s)
+        {
+            const char *data = s.data();
+            const char *object = reinterpret_cast<const char *>(&s);
+            bool local = data >= object && data < object + sizeof(std::string);
+            return local ? 0 : allocation_size(s.capacity() + 1);
+        }
+
+        // libstdc++ red-black tree node: color, parent, left, right
+        constexpr std::size_t kMapNodeLinks = 32;
+
+        // Heap bytes owned by `value` and everything below it; the value's own 16 bytes are not included
+        inline std::size_t json_heap_bytes(const nlohmann::json &value, MemoryUsage &usage, std::size_t &nodes)
+        {
+            ++nodes;
+            std::size_t own = 0;
+            std::size_t children = 0;
+            switch (value.type())
+            {
+            case nlohmann::json::value_t::object:
+            {
+                const auto &object = value.get_ref<const nlohmann::json::object_t &>();
+                own = allocation_size(sizeof(nlohmann::json::object_t));
+                for (const auto &[key, child] : object)
+                {
+                    own += allocation_size(kMapNodeLinks + sizeof(nlohmann::json::object_t::value_type)) + string_heap_bytes(key);
+                    children += json_heap_bytes(child, usage, nodes);
+                }
+                break;
+            }
+            case nlohmann::json::value_t::array:
+            {
+                const auto &array = value.get_ref<const nlohmann::json::array_t &>();
+                own = allocation_size(sizeof(nlohmann::json::array_t)) + allocation_size(array.capacity() * sizeof(nlohmann::json));
+                for (const auto &child : array)
+                {
+                    children += json_heap_bytes(child, usage, nodes);
+                }
+                break;
+            }
+            case nlohmann::json::value_t::string:
+                own = allocation_size(sizeof(nlohmann::json::string_t)) + string_heap_bytes(value.get_ref<const nlohmann::json::string_t &>());
+                break;
+            case nlohmann::json::value_t::binary:
+            {
+                const auto &binary = value.get_binary();
+                own = allocation_size(sizeof(nlohmann::json::binary_t)) + allocation_size(binary.capacity());
+                break;
+            }
+            default:
+                break; // Numbers, booleans and null live inside the json value
+            }
+            TypeMemoryUsage &type = usage.types[value.type_name()];
+            ++type.count;
+            type.bytes += own;
+            return own + children;
+        }
+
+        // Heap bytes owned by `value`, without the per-type breakdown
+        inline std::size_t value_heap_bytes(const nlohmann::json &value)
+        {
+            MemoryUsage scratch;
+            std::size_t nodes = 0;
+            return json_heap_bytes(value, scratch, nodes);
+        }
+
+        // Node size of std::unordered_map<std::string, nlohmann::json> with a cached hash
+        constexpr std::size_t kHashNodeBytes = sizeof(void *) + sizeof(std::pair<const std::string, nlohmann::json>) + sizeof(std::size_t);
+
+        // Fills the table, key and value fields of `usage` from a top-level map
+        inline void account_map(const std::unordered_map<std::string, nlohmann::json> &map, MemoryUsage &usage)
+        {
+            usage.table_bytes += allocation_size(map.bucket_count() * sizeof(void *));
+            usage.keys.reserve(usage.keys.size() + map.size());
+            for (const auto &[key, value] : map)
+            {
+                KeyMemoryUsage entry;
+                entry.key = key;
+                entry.type = value.type_name();
+                std::size_t node = allocation_size(kHashNodeBytes);
+                std::size_t key_heap = string_heap_bytes(key);
+                std::size_t value_heap = json_heap_bytes(value, usage, entry.nodes);
+                entry.bytes = node + key_heap + value_heap;
+                usage.table_bytes += node;
+                usage.key_bytes += key_heap;
+                usage.value_bytes += value_heap;
+                usage.json_nodes += entry.nodes;
+                usage.keys.push_back(std::move(entry));
+            }
+            std::sort(usage.keys.begin(), usage.keys.end(), [](const KeyMemoryUsage &a, const KeyMemoryUsage &b) {
+                return a.bytes > b.bytes;
+            });
+        }
+    } // namespace memory
+
+} // namespace config
+
+#endif // CONFIG_MEMORY_HPP
@@ -0,0 +1,262 @@
+/*
+    * config_metrics.hpp
+    *
+    * Header-only runtime metrics for Config instances.
+    * Counts reads, writes, misses and listener invocations, and measures the time spent waiting
+    * for and holding the instance mutex. Counters are sharded per thread so that tracking does not
+    * become a contention point itself.
+    *
+    * Key Components:
+    * - ConfigStats struct: Point-in-time snapshot with JSON and Prometheus text output.
+    * - ConfigMetrics class: Cache-line aligned, per-thread sharded counters.
+    * - MeteredLock class: Scoped mutex lock that records wait and hold times when metrics are enabled.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+config.enable_metrics();
+...
+ConfigStats stats = config.stats();
+std::cout << stats.miss_rate() << std::endl;
+std::cout << stats.to_prometheus("default");
+
+Metrics are disabled by default; a disabled instance pays one relaxed atomic load per call.
+*/
+
+// File: config_metrics.hpp
+
+
+#ifndef CONFIG_METRICS_HPP
+#define CONFIG_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    struct ConfigStats
+    {
+        std::uint64_t reads = 0;
+        std::uint64_t writes = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t listener_invocations = 0;
+        std::uint64_t lock_acquisitions = 0;
+        std::chrono::nanoseconds lock_wait{0};
+        std::chrono::nanoseconds lock_hold{0};
+
+        double miss_rate() const
+        {
+            return reads == 0 ? 0.0 : static_cast<double>(misses) / static_cast<double>(reads);
+        }
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"reads", reads},
+                {"writes", writes},
+                {"misses", misses},
+                {"miss_rate", miss_rate()},
+                {"listener_invocations", listener_invocations},
+                {"lock_acquisitions", lock_acquisitions},
+                {"lock_wait_ns", lock_wait.count()},
+                {"lock_hold_ns", lock_hold.count()}
+            };
+        }
+
+        // Prometheus text exposition format, labelled with the instance name
+        std::string to_prometheus(const std::string &instance = "default") const
+        {
+            std::ostringstream out;
+            std::string label = "{instance=\"" + escape_label(instance) + "\"}";
+            auto counter = [&](const char *name, const char *help, auto value) {
+                out << "# HELP " << name << " " << help << "\n";
+                out << "# TYPE " << name << " counter\n";
+                out << name << label << " " << value << "\n";
+            };
+            counter("config_reads_total", "Configuration reads (get, exists, get_all).", reads);
+            counter("config_writes_total", "Configuration writes (set and loaded keys).", writes);
+            counter("config_misses_total", "Reads of keys that do not exist.", misses);
+            counter("config_listener_invocations_total", "Change listener calls.", listener_invocations);
+            counter("config_lock_acquisitions_total", "Acquisitions of the instance mutex.", lock_acquisitions);
+            counter("config_lock_wait_seconds_total", "Time spent waiting for the instance mutex.",
+                    std::chrono::duration<double>(lock_wait).count());
+            counter("config_lock_hold_seconds_total", "Time the instance mutex was held.",
+                    std::chrono::duration<double>(lock_hold).count());
+            return out.str();
+        }
+
+    private:
+        static std::string escape_label(const std::string &value)
+        {
+            std::string escaped;
+            escaped.reserve(value.size());
+            for (char c : value)
+            {
+                if (c == '\\' || c == '"')
+                {
+                    escaped.push_back('\\');
+                    escaped.push_back(c);
+                }
+                else if (c == '\n')
+                {
+                    escaped += "\\n";
+                }
+                else
+                {
+                    escaped.push_back(c);
+                }
+            }
+            return escaped;
+        }
+    };
+
+    class ConfigMetrics
+    {
+    public:
+        static constexpr std::size_t kShards = 16;
+
+        void add_read(bool hit)
+        {
+            Shard &s = shard();
+            s.reads.fetch_add(1, std::memory_order_relaxed);
+            if (!hit)
+            {
+                s.misses.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void add_writes(std::uint64_t count = 1)
+        {
+            shard().writes.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        void add_listener_invocations(std::uint64_t count)
+        {
+            shard().listener_invocations.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        void record_lock_wait(std::chrono::nanoseconds wait)
+        {
+            Shard &s = shard();
+            s.lock_acquisitions.fetch_add(1, std::memory_order_relaxed);
+            s.lock_wait_ns.fetch_add(static_cast<std::uint64_t>(wait.count()), std::memory_order_relaxed);
+        }
+
+        void record_lock_hold(std::chrono::nanoseconds hold)
+        {
+            shard().lock_hold_ns.fetch_add(static_cast<std::uint64_t>(hold.count()), std::memory_order_relaxed);
+        }
+
+        ConfigStats snapshot() const
+        {
+            ConfigStats stats;
+            for (const auto &s : shards_)
+            {
+                stats.reads += s.reads.load(std::memory_order_relaxed);
+                stats.writes += s.writes.load(std::memory_order_relaxed);
+                stats.misses += s.misses.load(std::memory_order_relaxed);
+                stats.listener_invocations += s.listener_invocations.load(std::memory_order_relaxed);
+                stats.lock_acquisitions += s.lock_acquisitions.load(std::memory_order_relaxed);
+                stats.lock_wait += std::chrono::nanoseconds(s.lock_wait_ns.load(std::memory_order_relaxed));
+                stats.lock_hold += std::chrono::nanoseconds(s.lock_hold_ns.load(std::memory_order_relaxed));
+            }
+            return stats;
+        }
+
+        void reset()
+        {
+            for (auto &s : shards_)
+            {
+                s.reads.store(0, std::memory_order_relaxed);
+                s.writes.store(0, std::memory_order_relaxed);
+                s.misses.store(0, std::memory_order_relaxed);
+                s.listener_invocations.store(0, std::memory_order_relaxed);
+                s.lock_acquisitions.store(0, std::memory_order_relaxed);
+                s.lock_wait_ns.store(0, std::memory_order_relaxed);
+                s.lock_hold_ns.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        // One cache line per shard so threads on different shards never share a line
+        struct alignas(64) Shard
+        {
+            std::atomic<std::uint64_t> reads{0};
+            std::atomic<std::uint64_t> writes{0};
+            std::atomic<std::uint64_t> misses{0};
+            std::atomic<std::uint64_t> listener_invocations{0};
+            std::atomic<std::uint64_t> lock_acquisitions{0};
+            std::atomic<std::uint64_t> lock_wait_ns{0};
+            std::atomic<std::uint64_t> lock_hold_ns{0};
+        };
+
+        // Threads are assigned shards round-robin on first use
+        static std::size_t shard_index()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+            return index;
+        }
+
+        Shard &shard() { return shards_[shard_index()]; }
+
+        std::array<Shard, kShards> shards_;
+    };
+
+    // Scoped lock on a mutex; records wait and hold times when given a metrics sink
+    class MeteredLock
+    {
+    public:
+        MeteredLock(std::mutex &mutex, ConfigMetrics *metrics) : mutex_(mutex), metrics_(metrics)
+        {
+            if (!metrics_)
+            {
+                mutex_.lock();
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
+            mutex_.lock();
+            acquired_ = std::chrono::steady_clock::now();
+            metrics_->record_lock_wait(acquired_ - start);
+        }
+
+        ~MeteredLock()
+        {
+            if (!metrics_)
+            {
+                mutex_.unlock();
+                return;
+            }
+            auto held = std::chrono::steady_clock::now() - acquired_;
+            mutex_.unlock();
+            metrics_->record_lock_hold(std::chrono::duration_cast<std::chrono::nanoseconds>(held));
+        }
+
+        MeteredLock(const MeteredLock &) = delete;
+        MeteredLock &operator=(const MeteredLock &) = delete;
+
+    private:
+        std::mutex &mutex_;
+        ConfigMetrics *metrics_;
+        std::chrono::steady_clock::time_point acquired_;
+    };
+
+} // namespace config
+
+#endif // CONFIG_METRICS_HPP
@@ -0,0 +1,536 @@
+/*
+    * config_profiler.hpp
+    *
+    * Header-only sampling hot-key profiler for Config instances.
+    * Records 1-in-N get/set calls (key, caller tag and latency) into a lock-free ring buffer and
+    * aggregates them into a top-K hot-key report with a space-saving counter. Used to decide which
+    * keys to bind or cache, and to find code paths that read configuration in tight loops.
+    *
+    * Key Components:
+    * - ProfilerOptions struct: Sampling rate, ring size, report size and optional reporting interval.
+    * - ConfigProfiler class: Sampling, ring buffer, aggregation and periodic reporting.
+    * - ConfigProfiler::TagScope: Labels the calls made by the current thread while in scope.
+    * - HotKeyReport struct: Top-K keys with estimated call counts, latencies and tags.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+auto profiler = std::make_shared<ConfigProfiler>(ProfilerOptions{});
+config.attach_profiler(profiler);
+{
+    ConfigProfiler::TagScope tag("request_handler");
+    config.get("name");
+}
+std::cout << profiler->report().to_string();
+
+Notes:
+- Keys longer than 56 bytes and tags longer than 24 bytes are truncated in the report.
+- If the ring fills up between reports the oldest samples are dropped and counted in `dropped`.
+- Counts in the report are estimates: sampled calls multiplied by the sampling rate.
+*/
+
+// File: config_profiler.hpp
+
+
+#ifndef CONFIG_PROFILER_HPP
+#define CONFIG_PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    enum class ProfiledOp
+    {
+        GET,
+        SET
+    };
+
+    struct HotKey
+    {
+        std::string key;
+        std::string tag;                // Most frequent tag among the samples
+        std::uint64_t samples = 0;      // Sampled calls counted for this key
+        std::uint64_t error = 0;        // Space-saving overestimate bound on `samples`
+        std::uint64_t estimated_calls = 0;
+        std::uint64_t gets = 0;
+        std::uint64_t sets = 0;
+        std::chrono::nanoseconds mean_latency{0};
+        std::chrono::nanoseconds max_latency{0};
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"key", key},
+                {"tag", tag},
+                {"samples", samples},
+                {"error", error},
+                {"estimated_calls", estimated_calls},
+                {"gets", gets},
+                {"sets", sets},
+                {"mean_latency_ns", mean_latency.count()},
+                {"max_latency_ns", max_latency.count()}
+            };
+        }
+    };
+
+    struct HotKeyReport
+    {
+        std::uint64_t samples = 0;      // Samples aggregated since the last reset
+        std::uint64_t dropped = 0;      // Samples lost because the ring was overwritten
+        std::uint32_t sample_every = 1;
+        std::vector<HotKey> keys;       // Hottest first
+
+        nlohmann::json to_json() const
+        {
+            nlohmann::json j = {
+                {"samples", samples},
+                {"dropped", dropped},
+                {"sample_every", sample_every},
+                {"keys", nlohmann::json::array()}
+            };
+            for (const auto &key : keys)
+            {
+                j["keys"].push_back(key.to_json());
+            }
+            return j;
+        }
+
+        std::string to_string() const
+        {
+            std::ostringstream out;
+            out << "Hot keys (" << samples << " samples, 1 in " << sample_every << ", " << dropped << " dropped)\n";
+            for (const auto &key : keys)
+            {
+                out << "  " << key.key << ": ~" << key.estimated_calls << " calls (" << key.gets << " get, "
+                    << key.sets << " set), mean " << key.mean_latency.count() << " ns, max "
+                    << key.max_latency.count() << " ns";
+                if (!key.tag.empty())
+                {
+                    out << ", tag " << key.tag;
+                }
+                out << "\n";
+            }
+            return out.str();
+        }
+    };
+
+    struct ProfilerOptions
+    {
+        std::uint32_t sample_every = 64;                  // Record one call in N per thread
+        std::size_t buffer_capacity = 4096;               // Ring buffer slots between reports
+        std::size_t top_k = 20;                           // Keys in each report
+        std::size_t counters = 0;                         // Space-saving counters; 0 uses 4 * top_k
+        std::chrono::milliseconds report_interval{0};     // Periodic reporting; 0 disables the thread
+        std::function<void(const HotKeyReport &)> on_report;
+    };
+
+    class ConfigProfiler
+    {
+    public:
+        static constexpr std::size_t kKeyWords = 7;
+        static constexpr std::size_t kTagWords = 3;
+
+        // Tags the get/set calls made by this thread while in scope; the view must outlive the scope
+        class TagScope
+        {
+        public:
+            explicit TagScope(std::string_view tag) : previous_(current_tag())
+            {
+                current_tag() = tag;
+            }
+            ~TagScope() { current_tag() = previous_; }
+
+            TagScope(const TagScope &) = delete;
+            TagScope &operator=(const TagScope &) = delete;
+
+        private:
+            std::string_view previous_;
+        };
+
+        // Times one call if it is selected for sampling
+        class Sample
+        {
+        public:
+            Sample(ConfigProfiler *profiler, ProfiledOp op, const std::string &key)
+                : profiler_(profiler && profiler->should_sample() ? profiler : nullptr), op_(op), key_(key)
+            {
+                if (profiler_)
+                {
+                    start_ = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~Sample()
+            {
+                if (profiler_)
+                {
+                    profiler_->record(op_, key_, std::chrono::steady_clock::now() - start_);
+                }
+            }
+
+            Sample(const Sample &) = delete;
+            Sample &operator=(const Sample &) = delete;
+
+        private:
+            ConfigProfiler *profiler_;
+            ProfiledOp op_;
+            const std::string &key_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        explicit ConfigProfiler(ProfilerOptions options = {})
+            : options_(std::move(options)),
+              id_(next_id()),
+              slots_(std::max<std::size_t>(1, options_.buffer_capacity))
+        {
+            options_.sample_every = std::max<std::uint32_t>(1, options_.sample_every);
+            options_.top_k = std::max<std::size_t>(1, options_.top_k);
+            if (options_.counters < options_.top_k)
+            {
+                options_.counters = options_.top_k * 4;
+            }
+            if (options_.report_interval.count() > 0 && options_.on_report)
+            {
+                reporter_ = std::thread([this] { reporting_loop(); });
+            }
+        }
+
+        ~ConfigProfiler()
+        {
+            {
+                std::lock_guard<std::mutex> lock(reporter_mutex_);
+                stopping_ = true;
+            }
+            reporter_cv_.notify_all();
+            if (reporter_.joinable())
+            {
+                reporter_.join();
+            }
+        }
+
+        ConfigProfiler(const ConfigProfiler &) = delete;
+        ConfigProfiler &operator=(const ConfigProfiler &) = delete;
+
+        const ProfilerOptions &options() const { return options_; }
+
+        // Per-thread, per-instance countdown; true for one call in sample_every
+        bool should_sample() const
+        {
+            // Each thread keeps the countdowns of the profilers it used most recently, front first
+            thread_local std::vector<Countdown> countdowns;
+            auto it = std::find_if(countdowns.begin(), countdowns.end(), [this](const Countdown &c) { return c.profiler == id_; });
+            if (it == countdowns.end())
+            {
+                if (countdowns.size() >= kThreadCountdowns)
+                {
+                    countdowns.pop_back();
+                }
+                // Spread the first sample of each thread over the interval so threads are not in phase
+                std::uint32_t phase = 1 + static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()) % options_.sample_every);
+                it = countdowns.insert(countdowns.begin(), Countdown{id_, phase});
+            }
+            else if (it != countdowns.begin())
+            {
+                std::rotate(countdowns.begin(), it, it + 1);
+                it = countdowns.begin();
+            }
+            if (--it->remaining != 0)
+            {
+                return false;
+            }
+            it->remaining = options_.sample_every;
+            return true;
+        }
+
+        // Lock-free: claims a ring slot and publishes it with a per-slot sequence number
+        void record(ProfiledOp op, std::string_view key, std::chrono::nanoseconds latency)
+        {
+            std::uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+            Slot &slot = slots_[ticket % slots_.size()];
+            slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::string_view tag = current_tag();
+            std::size_t key_length = std::min(key.size(), kKeyWords * 8);
+            std::size_t tag_length = std::min(tag.size(), kTagWords * 8);
+            store_words(slot.key, key.substr(0, key_length));
+            store_words(slot.tag, tag.substr(0, tag_length));
+            slot.meta.store(static_cast<std::uint64_t>(op) | (key_length << 8) | (tag_length << 24), std::memory_order_relaxed);
+            slot.latency_ns.store(static_cast<std::uint64_t>(latency.count()), std::memory_order_relaxed);
+
+            slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+        }
+
+        // Drains the ring into the aggregate and returns the current top-K
+        HotKeyReport report()
+        {
+            std::lock_guard<std::mutex> lock(aggregate_mutex_);
+            drain();
+            HotKeyReport report;
+            report.samples = total_samples_;
+            report.dropped = dropped_;
+            report.sample_every = options_.sample_every;
+
+            std::vector<const Counter *> ranked;
+            ranked.reserve(counters_.size());
+            for (const auto &[key, counter] : counters_)
+            {
+                ranked.push_back(&counter);
+            }
+            std::size_t k = std::min(options_.top_k, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(), [](const Counter *a, const Counter *b) {
+                return a->count > b->count;
+            });
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                const Counter &c = *ranked[i];
+                HotKey hot;
+                hot.key = c.key;
+                hot.samples = c.count;
+                hot.error = c.error;
+                hot.estimated_calls = c.count * options_.sample_every;
+                hot.gets = c.gets * options_.sample_every;
+                hot.sets = c.sets * options_.sample_every;
+                std::uint64_t recorded = c.gets + c.sets;
+                hot.mean_latency = std::chrono::nanoseconds(recorded ? c.total_latency_ns / recorded : 0);
+                hot.max_latency = std::chrono::nanoseconds(c.max_latency_ns);
+                std::uint64_t best = 0;
+                for (const auto &[tag, count] : c.tags)
+                {
+                    if (count > best)
+                    {
+                        best = count;
+                        hot.tag = tag;
+                    }
+                }
+                report.keys.push_back(std::move(hot));
+            }
+            return report;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(aggregate_mutex_);
+            drain();
+            counters_.clear();
+            min_counts_ = {};
+            total_samples_ = 0;
+            dropped_ = 0;
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<std::uint64_t> sequence{0};
+            std::atomic<std::uint64_t> meta{0};         // op | key length << 8 | tag length << 24
+            std::atomic<std::uint64_t> latency_ns{0};
+            std::atomic<std::uint64_t> key[kKeyWords] = {};
+            std::atomic<std::uint64_t> tag[kTagWords] = {};
+        };
+
+        struct Countdown
+        {
+            std::uint64_t profiler;
+            std::uint32_t remaining;
+        };
+
+        static constexpr std::size_t kThreadCountdowns = 8;
+
+        // Ids are never reused, so a countdown cannot outlive its profiler into a new one at the same address
+        static std::uint64_t next_id()
+        {
+            static std::atomic<std::uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Space-saving counter entry
+        struct Counter
+        {
+            std::string key;
+            std::uint64_t count = 0;
+            std::uint64_t error = 0;
+            std::uint64_t gets = 0;
+            std::uint64_t sets = 0;
+            std::uint64_t total_latency_ns = 0;
+            std::uint64_t max_latency_ns = 0;
+            std::unordered_map<std::string, std::uint64_t> tags;
+        };
+
+        // Min-heap entry; `count` may lag behind the counter's, which only grows, and is refreshed when popped
+        struct MinCount
+        {
+            std::uint64_t count;
+            Counter *counter;
+
+            bool operator>(const MinCount &other) const { return count > other.count; }
+        };
+
+        static std::string_view &current_tag()
+        {
+            thread_local std::string_view tag;
+            return tag;
+        }
+
+        template <std::size_t N>
+        static void store_words(std::atomic<std::uint64_t> (&words)[N], std::string_view text)
+        {
+            for (std::size_t i = 0; i * 8 < text.size(); ++i)
+            {
+                std::uint64_t word = 0;
+                std::memcpy(&word, text.data() + i * 8, std::min<std::size_t>(8, text.size() - i * 8));
+                words[i].store(word, std::memory_order_relaxed);
+            }
+        }
+
+        template <std::size_t N>
+        static std::string load_words(const std::atomic<std::uint64_t> (&words)[N], std::size_t length)
+        {
+            char buffer[N * 8];
+            for (std::size_t i = 0; i < N && i * 8 < length; ++i)
+            {
+                std::uint64_t word = words[i].load(std::memory_order_relaxed);
+                std::memcpy(buffer + i * 8, &word, 8);
+            }
+            return std::string(buffer, std::min(length, N * 8));
+        }
+
+        // Caller must hold aggregate_mutex_
+        void drain()
+        {
+            std::uint64_t head = head_.load(std::memory_order_acquire);
+            if (head - tail_ > slots_.size())
+            {
+                dropped_ += head - tail_ - slots_.size();
+                tail_ = head - slots_.size();
+            }
+            for (; tail_ < head; ++tail_)
+            {
+                const Slot &slot = slots_[tail_ % slots_.size()];
+                std::uint64_t expected = 2 * tail_ + 2;
+                std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+                if (before < expected)
+                {
+                    break; // Still being written; picked up by the next drain
+                }
+                if (before > expected)
+                {
+                    ++dropped_;
+                    continue;
+                }
+                std::uint64_t meta = slot.meta.load(std::memory_order_relaxed);
+                std::uint64_t latency = slot.latency_ns.load(std::memory_order_relaxed);
+                std::string key = load_words(slot.key, (meta >> 8) & 0xFFFF);
+                std::string tag = load_words(slot.tag, (meta >> 24) & 0xFF);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != expected)
+                {
+                    ++dropped_;
+                    continue;
+                }
+                aggregate(static_cast<ProfiledOp>(meta & 0xFF), key, tag, latency);
+            }
+        }
+
+        void aggregate(ProfiledOp op, const std::string &key, const std::string &tag, std::uint64_t latency_ns)
+        {
+            ++total_samples_;
+            auto it = counters_.find(key);
+            if (it == counters_.end())
+            {
+                Counter counter;
+                if (counters_.size() >= options_.counters)
+                {
+                    // Replace the minimum; the newcomer inherits its count as the error bound
+                    Counter *min = pop_min();
+                    counter.count = min->count;
+                    counter.error = min->count;
+                    counters_.erase(counters_.find(min->key));
+                }
+                counter.key = key;
+                it = counters_.emplace(key, std::move(counter)).first;
+                min_counts_.push({it->second.count + 1, &it->second});
+            }
+            Counter &c = it->second;
+            ++c.count;
+            (op == ProfiledOp::GET ? c.gets : c.sets) += 1;
+            c.total_latency_ns += latency_ns;
+            c.max_latency_ns = std::max(c.max_latency_ns, latency_ns);
+            if (!tag.empty())
+            {
+                ++c.tags[tag];
+            }
+        }
+
+        // The counter with the smallest count. Counts only grow, so an entry whose count is current is the minimum
+        Counter *pop_min()
+        {
+            while (true)
+            {
+                MinCount top = min_counts_.top();
+                min_counts_.pop();
+                if (top.count == top.counter->count)
+                {
+                    return top.counter;
+                }
+                min_counts_.push({top.counter->count, top.counter});
+            }
+        }
+
+        void reporting_loop()
+        {
+            std::unique_lock<std::mutex> lock(reporter_mutex_);
+            while (!reporter_cv_.wait_for(lock, options_.report_interval, [this] { return stopping_; }))
+            {
+                lock.unlock();
+                options_.on_report(report());
+                lock.lock();
+            }
+        }
+
+        ProfilerOptions options_;
+        std::uint64_t id_;
+        std::vector<Slot> slots_;
+        std::atomic<std::uint64_t> head_{0};
+
+        std::mutex aggregate_mutex_;
+        std::uint64_t tail_ = 0;
+        std::uint64_t total_samples_ = 0;
+        std::uint64_t dropped_ = 0;
+        std::unordered_map<std::string, Counter> counters_; // Node-based, so Counter pointers stay valid
+        std::priority_queue<MinCount, std::vector<MinCount>, std::greater<MinCount>> min_counts_; // One entry per counter
+
+        std::mutex reporter_mutex_;
+        std::condition_variable reporter_cv_;
+        bool stopping_ = false;
+        std::thread reporter_;
+    };
+
+} // namespace config
+
+#endif // CONFIG_PROFILER_HPP
@@ -0,0 +1,394 @@
+/*
+    * config_query.hpp
+    *
+    * Header-only compiled queries for nested configuration values.
+    * A CompiledQuery parses a JSON Pointer ("/routes/3/backends") or a JSONPath subset
+    * ("$.routes[3].backends", "$.routes[*].name", "$..port") once, and can then be resolved many times.
+    * Config::query caches the resolved node locations per query until the top-level key is written
+    * again, so repeated deep queries neither re-walk nor copy the enclosing object.
+    *
+    * Key Components:
+    * - CompiledQuery class: Parsed query steps, the top-level key it starts from, and the resolvers.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Supported syntax:
+- JSON Pointer (RFC 6901): "/a/b/0", with "~1" for "/" and "~0" for "~". The first token is the
+  top-level key. Numeric tokens index arrays and name members of objects.
+- JSONPath subset: "$" followed by .name, ['name'] or ["name"], [index] (negative counts from the
+  end), .* or [*] (all children), and ..name or ..* (recursive descent).
+Invalid queries throw std::invalid_argument when compiled.
+*/
+
+// File: config_query.hpp
+
+
+#ifndef CONFIG_QUERY_HPP
+#define CONFIG_QUERY_HPP
+
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    class CompiledQuery
+    {
+    public:
+        enum class StepKind
+        {
+            TOKEN,      // JSON Pointer token: member name, or index for arrays
+            NAME,       // JSONPath member name
+            INDEX,      // JSONPath array index
+            WILDCARD,   // All children
+            DESCENDANT  // Recursive descent to members named `name`, or all nodes when `name` is empty
+        };
+
+        struct Step
+        {
+            StepKind kind;
+            std::string name;
+            long long index = 0;
+        };
+
+        explicit CompiledQuery(const std::string &text) : text_(text)
+        {
+            if (!text.empty() && text[0] == '$')
+            {
+                parse_json_path();
+            }
+            else
+            {
+                parse_json_pointer();
+            }
+            if (steps_.empty())
+            {
+                throw std::invalid_argument("Query must select at least a top-level key: " + text_);
+            }
+            const Step &first = steps_.front();
+            if (first.kind == StepKind::TOKEN || first.kind == StepKind::NAME)
+            {
+                root_key_ = first.name;
+                anchored_ = true;
+            }
+            else if (first.kind == StepKind::INDEX)
+            {
+                throw std::invalid_argument("Query cannot index the top level: " + text_);
+            }
+        }
+
+        const std::string &text() const { return text_; }
+        const std::vector<Step> &steps() const { return steps_; }
+
+        // True when the query starts at a single named top-level key
+        bool anchored() const { return anchored_; }
+        const std::string &root_key() const { return root_key_; }
+
+        // Applies steps[step...] to `node`, calling out(const nlohmann::json &) for every match
+        template <typename Out>
+        void resolve(const nlohmann::json &node, std::size_t step, Out &&out) const
+        {
+            if (step == steps_.size())
+            {
+                out(node);
+                return;
+            }
+            const Step &s = steps_[step];
+            switch (s.kind)
+            {
+            case StepKind::TOKEN:
+                if (node.is_object())
+                {
+                    auto it = node.find(s.name);
+                    if (it != node.end())
+                    {
+                        resolve(*it, step + 1, out);
+                    }
+                }
+                else if (node.is_array() && is_array_index(s.name))
+                {
+                    std::size_t index = std::stoull(s.name);
+                    if (index < node.size())
+                    {
+                        resolve(node[index], step + 1, out);
+                    }
+                }
+                break;
+            case StepKind::NAME:
+                if (node.is_object())
+                {
+                    auto it = node.find(s.name);
+                    if (it != node.end())
+                    {
+                        resolve(*it, step + 1, out);
+                    }
+                }
+                break;
+            case StepKind::INDEX:
+                if (node.is_array())
+                {
+                    long long size = static_cast<long long>(node.size());
+                    long long index = s.index < 0 ? size + s.index : s.index;
+                    if (index >= 0 && index < size)
+                    {
+                        resolve(node[static_cast<std::size_t>(index)], step + 1, out);
+                    }
+                }
+                break;
+            case StepKind::WILDCARD:
+                if (node.is_structured())
+                {
+                    for (const auto &child : node)
+                    {
+                        resolve(child, step + 1, out);
+                    }
+                }
+                break;
+            case StepKind::DESCENDANT:
+                descend(node, step, out);
+                break;
+            }
+        }
+
+        // Resolves the whole query against a map of top-level keys to values
+        template <typename Map, typename Out>
+        void resolve_root(const Map &entries, Out &&out) const
+        {
+            if (anchored_)
+            {
+                auto it = entries.find(root_key_);
+                if (it != entries.end())
+                {
+                    resolve(it->second, 1, out);
+                }
+                return;
+            }
+            for (const auto &[key, value] : entries)
+            {
+                resolve_entry(key, value, out);
+            }
+        }
+
+        // Resolves an unanchored query against one top-level entry
+        template <typename Out>
+        void resolve_entry(const std::string &key, const nlohmann::json &value, Out &&out) const
+        {
+            const Step &first = steps_.front();
+            if (first.kind == StepKind::WILDCARD || first.name.empty() || key == first.name)
+            {
+                resolve(value, 1, out);
+            }
+            if (first.kind == StepKind::DESCENDANT)
+            {
+                descend(value, 0, out);
+            }
+        }
+
+    private:
+        template <typename Out>
+        void descend(const nlohmann::json &node, std::size_t step, Out &out) const
+        {
+            const Step &s = steps_[step];
+            if (node.is_object())
+            {
+                for (auto it = node.begin(); it != node.end(); ++it)
+                {
+                    if (s.name.empty() || it.key() == s.name)
+                    {
+                        resolve(it.value(), step + 1, out);
+                    }
+                    descend(it.value(), step, out);
+                }
+            }
+            else if (node.is_array())
+            {
+                for (const auto &child : node)
+                {
+                    if (s.name.empty())
+                    {
+                        resolve(child, step + 1, out);
+                    }
+                    descend(child, step, out);
+                }
+            }
+        }
+
+        static bool is_array_index(const std::string &token)
+        {
+            // Longer tokens would overflow std::size_t, and no array is that large anyway
+            if (token.empty() || token.size() > 19 || (token.size() > 1 && token[0] == '0'))
+            {
+                return false;
+            }
+            for (char c : token)
+            {
+                if (!std::isdigit(static_cast<unsigned char>(c)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[noreturn]] void fail(const std::string &reason) const
+        {
+            throw std::invalid_argument("Invalid query '" + text_ + "': " + reason);
+        }
+
+        void parse_json_pointer()
+        {
+            if (text_.empty() || text_[0] != '/')
+            {
+                fail("JSON Pointer must start with '/' and JSONPath with '$'");
+            }
+            std::size_t pos = 1;
+            while (true)
+            {
+                std::size_t end = text_.find('/', pos);
+                std::string raw = text_.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+                std::string token;
+                for (std::size_t i = 0; i < raw.size(); ++i)
+                {
+                    if (raw[i] == '~')
+                    {
+                        if (i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1'))
+                        {
+                            token.push_back(raw[i + 1] == '0' ? '~' : '/');
+                            ++i;
+                            continue;
+                        }
+                        fail("'~' must be followed by '0' or '1'");
+                    }
+                    token.push_back(raw[i]);
+                }
+                steps_.push_back({StepKind::TOKEN, token, 0});
+                if (end == std::string::npos)
+                {
+                    break;
+                }
+                pos = end + 1;
+            }
+        }
+
+        void parse_json_path()
+        {
+            std::size_t pos = 1;
+            while (pos < text_.size())
+            {
+                if (text_.compare(pos, 2, "..") == 0)
+                {
+                    pos += 2;
+                    std::string name = read_name(pos);
+                    steps_.push_back({StepKind::DESCENDANT, name == "*" ? std::string() : name, 0});
+                }
+                else if (text_[pos] == '.')
+                {
+                    ++pos;
+                    std::string name = read_name(pos);
+                    if (name == "*")
+                    {
+                        steps_.push_back({StepKind::WILDCARD, "", 0});
+                    }
+                    else
+                    {
+                        steps_.push_back({StepKind::NAME, name, 0});
+                    }
+                }
+                else if (text_[pos] == '[')
+                {
+                    parse_bracket(pos);
+                }
+                else
+                {
+                    fail("unexpected '" + std::string(1, text_[pos]) + "'");
+                }
+            }
+        }
+
+        std::string read_name(std::size_t &pos)
+        {
+            std::size_t start = pos;
+            while (pos < text_.size() && text_[pos] != '.' && text_[pos] != '[')
+            {
+                ++pos;
+            }
+            if (pos == start)
+            {
+                fail("empty member name");
+            }
+            return text_.substr(start, pos - start);
+        }
+
+        void parse_bracket(std::size_t &pos)
+        {
+            std::size_t close = std::string::npos;
+            ++pos;
+            if (pos < text_.size() && (text_[pos] == '\'' || text_[pos] == '"'))
+            {
+                char quote = text_[pos];
+                std::size_t end = text_.find(quote, pos + 1);
+                if (end == std::string::npos || end + 1 >= text_.size() || text_[end + 1] != ']')
+                {
+                    fail("unterminated quoted name");
+                }
+                steps_.push_back({StepKind::NAME, text_.substr(pos + 1, end - pos - 1), 0});
+                pos = end + 2;
+                return;
+            }
+            close = text_.find(']', pos);
+            if (close == std::string::npos)
+            {
+                fail("missing ']'");
+            }
+            std::string inside = text_.substr(pos, close - pos);
+            pos = close + 1;
+            if (inside == "*")
+            {
+                steps_.push_back({StepKind::WILDCARD, "", 0});
+                return;
+            }
+            std::size_t digits = inside.size() > 0 && inside[0] == '-' ? 1 : 0;
+            if (digits == inside.size())
+            {
+                fail("expected an index, '*' or a quoted name");
+            }
+            for (std::size_t i = digits; i < inside.size(); ++i)
+            {
+                if (!std::isdigit(static_cast<unsigned char>(inside[i])))
+                {
+                    fail("expected an index, '*' or a quoted name");
+                }
+            }
+            long long index = 0;
+            try
+            {
+                index = std::stoll(inside);
+            }
+            catch (const std::out_of_range &)
+            {
+                fail("index out of range");
+            }
+            steps_.push_back({StepKind::INDEX, "", index});
+        }
+
+        std::string text_;
+        std::vector<Step> steps_;
+        std::string root_key_;
+        bool anchored_ = false;
+    };
+
+} // namespace config
+
+#endif // CONFIG_QUERY_HPP
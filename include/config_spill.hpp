@@ -0,0 +1,124 @@
+/*
+    * config_spill.hpp
+    *
+    * Header-only types for memory-bounded Config instances.
+    * With a MemoryBudget set, Config keeps the parsed values it holds under a resident byte budget by
+    * writing the coldest large values (and any value above a size threshold) to an unlinked, memory-mapped
+    * spill segment. A spilled value is reloaded transparently, and kept, on its next read, exactly like a
+    * lazily loaded one (see config_lazy.hpp).
+    *
+    * Key Components:
+    * - MemoryBudget struct: Resident budget, size threshold, smallest spillable value and spill directory.
+    * - SpillStats struct: Resident estimate, spilled values, spill file bytes, passes and reloads.
+    * - write_spill_segment(): Writes a batch of serialized values to a new mapped segment.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    * - POSIX mkstemp, mmap
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage (through Config):
+
+MemoryBudget budget;
+budget.resident_bytes = 64 << 20;   // Keep at most ~64 MiB of parsed values in memory
+budget.spill_threshold = 1 << 20;   // Never keep values of 1 MiB or more resident after a write
+config.set_memory_budget(budget);
+config.load_from_file("models.json");
+config.get("lookup_table");         // Reloaded from the spill segment if it was evicted
+
+Rules:
+- Only values of at least min_spill_bytes are spilled. Coldness is the order of last access (any read
+  or write of the key), so the least recently used large values go first.
+- The budget is enforced after writes and loads, and by enforce_memory_budget(). Reloads count
+  against it until the next enforcement.
+- Reloaded values keep their spill slice, so evicting them again costs no disk write.
+- Segments are serialized and written by the triggering call after it releases the Config lock; the
+  evicted values stay readable until then, and keys written meanwhile keep their new value.
+- Segment files are unlinked as soon as they are mapped; the space is returned when the last value
+  in a segment is overwritten, erased or the Config is destroyed.
+*/
+
+// File: config_spill.hpp
+
+
+#ifndef CONFIG_SPILL_HPP
+#define CONFIG_SPILL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "config_lazy.hpp"
+
+namespace config
+{
+    struct MemoryBudget
+    {
+        std::size_t resident_bytes = 0;     // Heap bytes of parsed values to keep; 0 means no budget
+        std::size_t spill_threshold = 0;    // Values at least this large are spilled after every write; 0 disables
+        std::size_t min_spill_bytes = 1024; // Smaller values always stay resident
+        std::string directory = "/tmp";     // Where spill segments are created
+
+        bool enabled() const { return resident_bytes != 0 || spill_threshold != 0; }
+    };
+
+    struct SpillStats
+    {
+        std::size_t resident_bytes = 0;   // Heap bytes of parsed values, tracked per key as they are written, reloaded and evicted
+        std::size_t spilled_values = 0;   // Keys currently evicted to a spill segment
+        std::size_t spill_file_bytes = 0; // Bytes of live spill segments
+        std::uint64_t passes = 0;         // Enforcement passes that evicted something
+        std::uint64_t spills = 0;         // Values written to spill segments
+        std::uint64_t reloads = 0;        // Evicted values parsed back on access
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"resident_bytes", resident_bytes},
+                {"spilled_values", spilled_values},
+                {"spill_file_bytes", spill_file_bytes},
+                {"passes", passes},
+                {"spills", spills},
+                {"reloads", reloads}
+            };
+        }
+    };
+
+    // Writes `contents` to a new file in `directory`, maps it and unlinks it. Returns nullptr on failure
+    inline std::shared_ptr<const MappedDocument> write_spill_segment(const std::string &directory, const std::string &contents)
+    {
+        std::string path = directory + "/config_spill_XXXXXX";
+        int fd = ::mkstemp(path.data());
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        std::size_t written = 0;
+        while (written < contents.size())
+        {
+            ssize_t n = ::write(fd, contents.data() + written, contents.size() - written);
+            if (n <= 0)
+            {
+                break;
+            }
+            written += static_cast<std::size_t>(n);
+        }
+        ::close(fd);
+        std::shared_ptr<const MappedDocument> segment = written == contents.size() ? MappedDocument::open(path) : nullptr;
+        ::unlink(path.c_str());
+        return segment;
+    }
+
+} // namespace config
+
+#endif // CONFIG_SPILL_HPP
@@ -0,0 +1,261 @@
+/*
+    * config_trace.hpp
+    *
+    * Header-only Chrome trace-event output for the configuration library.
+    * Scoped hooks in load_from_file, save_to_file, load_from_env, output_config and listener
+    * dispatch record complete ("ph": "X") events into a ring buffer, which can be written as
+    * Chrome trace-event JSON and opened in Perfetto or chrome://tracing next to an application's
+    * own traces. Tracing is off by default and costs one relaxed atomic load per hook.
+    *
+    * Key Components:
+    * - TraceOptions struct: Ring buffer capacity and an optional output file written on stop().
+    * - ConfigTracer class: Process-wide event buffer and JSON writer.
+    * - TraceScope class: RAII hook recording one complete event with optional arguments.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+Usage:
+
+ConfigTracer::global().start({"config_trace.json"});
+config.load_from_file("config.json");
+ConfigTracer::global().stop(); // Writes config_trace.json
+
+Timestamps are steady_clock microseconds (CLOCK_MONOTONIC on Linux), the clock Chrome and
+Perfetto use for JSON traces, so events line up with other traces from the same machine.
+*/
+
+// File: config_trace.hpp
+
+
+#ifndef CONFIG_TRACE_HPP
+#define CONFIG_TRACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace config
+{
+    struct TraceEvent
+    {
+        std::string name;
+        std::string category;
+        std::int64_t start_us = 0;
+        std::int64_t duration_us = 0;
+        std::uint64_t tid = 0;
+        nlohmann::json args;
+
+        nlohmann::json to_json(std::int64_t pid) const
+        {
+            nlohmann::json j = {
+                {"name", name},
+                {"cat", category},
+                {"ph", "X"},
+                {"ts", start_us},
+                {"dur", duration_us},
+                {"pid", pid},
+                {"tid", tid}
+            };
+            if (!args.is_null())
+            {
+                j["args"] = args;
+            }
+            return j;
+        }
+    };
+
+    struct TraceOptions
+    {
+        std::string file_path;          // Written by stop(); empty keeps events in memory only
+        std::size_t capacity = 65536;   // Oldest events are overwritten once full
+    };
+
+    class ConfigTracer
+    {
+    public:
+        static ConfigTracer &global()
+        {
+            static ConfigTracer tracer;
+            return tracer;
+        }
+
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        void start(TraceOptions options = {})
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options_ = std::move(options);
+            events_.clear();
+            events_.reserve(std::min<std::size_t>(options_.capacity, 1024));
+            next_ = 0;
+            dropped_ = 0;
+            enabled_.store(options_.capacity > 0, std::memory_order_release);
+        }
+
+        // Stops recording and writes the trace file if one was configured
+        bool stop()
+        {
+            enabled_.store(false, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (options_.file_path.empty())
+            {
+                return true;
+            }
+            std::ofstream out(options_.file_path);
+            if (!out.is_open())
+            {
+                std::cerr << "Failed to open trace file for writing: " << options_.file_path << std::endl;
+                return false;
+            }
+            write_locked(out);
+            return static_cast<bool>(out);
+        }
+
+        void record(TraceEvent event)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (events_.size() < options_.capacity)
+            {
+                events_.push_back(std::move(event));
+                return;
+            }
+            events_[next_] = std::move(event);
+            next_ = (next_ + 1) % options_.capacity;
+            ++dropped_;
+        }
+
+        // Events in recording order
+        std::vector<TraceEvent> events() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<TraceEvent> ordered(events_.begin() + static_cast<std::ptrdiff_t>(next_), events_.end());
+            ordered.insert(ordered.end(), events_.begin(), events_.begin() + static_cast<std::ptrdiff_t>(next_));
+            return ordered;
+        }
+
+        std::uint64_t dropped() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return dropped_;
+        }
+
+        // Chrome trace-event JSON object format
+        void write(std::ostream &os) const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            write_locked(os);
+        }
+
+        static std::int64_t now_us()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static std::uint64_t current_tid()
+        {
+            thread_local std::uint64_t tid = static_cast<std::uint64_t>(::syscall(SYS_gettid));
+            return tid;
+        }
+
+    private:
+        ConfigTracer() = default;
+
+        void write_locked(std::ostream &os) const
+        {
+            std::int64_t pid = static_cast<std::int64_t>(::getpid());
+            nlohmann::json trace = {
+                {"traceEvents", nlohmann::json::array()},
+                {"displayTimeUnit", "ms"},
+                {"otherData", {{"source", "config_manager"}, {"dropped_events", dropped_}}}
+            };
+            auto &list = trace["traceEvents"];
+            for (std::size_t i = 0; i < events_.size(); ++i)
+            {
+                list.push_back(events_[(next_ + i) % events_.size()].to_json(pid));
+            }
+            os << trace.dump() << "\n";
+        }
+
+        std::atomic<bool> enabled_{false};
+        mutable std::mutex mutex_;
+        TraceOptions options_;
+        std::vector<TraceEvent> events_;
+        std::size_t next_ = 0;
+        std::uint64_t dropped_ = 0;
+    };
+
+    // Records one complete event covering its lifetime, when tracing is enabled at construction
+    class TraceScope
+    {
+    public:
+        explicit TraceScope(const char *name, const char *category = "config")
+            : active_(ConfigTracer::global().enabled()), name_(name), category_(category)
+        {
+            if (active_)
+            {
+                start_us_ = ConfigTracer::now_us();
+            }
+        }
+
+        ~TraceScope()
+        {
+            if (!active_)
+            {
+                return;
+            }
+            TraceEvent event;
+            event.name = name_;
+            event.category = category_;
+            event.start_us = start_us_;
+            event.duration_us = ConfigTracer::now_us() - start_us_;
+            event.tid = ConfigTracer::current_tid();
+            event.args = std::move(args_);
+            ConfigTracer::global().record(std::move(event));
+        }
+
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+
+        explicit operator bool() const { return active_; }
+
+        // Arguments are only converted when the scope is recording
+        template <typename T>
+        TraceScope &arg(const char *key, const T &value)
+        {
+            if (active_)
+            {
+                args_[key] = value;
+            }
+            return *this;
+        }
+
+    private:
+        bool active_;
+        const char *name_;
+        const char *category_;
+        std::int64_t start_us_ = 0;
+        nlohmann::json args_;
+    };
+
+} // namespace config
+
+#endif // CONFIG_TRACE_HPP
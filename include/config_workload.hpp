@@ -0,0 +1,560 @@
+/*
+    * config_workload.hpp
+    *
+    * Header-only workload recording and replay for the configuration library.
+    * A WorkloadRecorder attached to a Config logs get, set and load calls (key, value size, thread and
+    * timestamp) to a compact binary file. replay_workload() re-runs such a recording against any
+    * IConfigStorage, either preserving the recorded timing or as fast as possible, so changes can be
+    * benchmarked with real access patterns. See tools/config_replay.cpp for the command line tool.
+    *
+    * Key Components:
+    * - WorkloadRecorder class: Thread-safe binary writer with per-thread op buffers and a key dictionary.
+    * - read_workload(): Decodes a recording into WorkloadOp entries.
+    * - replay_workload(): Replays a recording with one thread per recorded thread.
+    *
+    * External Dependencies:
+    * - nlohmann/json
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Version 0.0.1
+*/
+
+/*
+File format (all integers are unsigned LEB128 varints):
+  header:  "CFGWKLD2"
+  key:     0x00, length, bytes                 (defines the next key id, starting at 0)
+  op:      type | 0x80 if the get missed, delta_ns since the previous op of the same thread, thread, key id, size
+Types: 1 = get, 2 = set, 3 = load (key is the file path, size the bytes read).
+Sizes are the length of string values and an estimate of the compact JSON length of anything else
+(string escapes are not counted). Each thread buffers its own ops, so ops of different threads
+are interleaved in chunks; read_workload() returns them sorted by timestamp.
+*/
+
+// File: config_workload.hpp
+
+
+#ifndef CONFIG_WORKLOAD_HPP
+#define CONFIG_WORKLOAD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace config
+{
+    class IConfigStorage;
+
+    enum class WorkloadOpType : std::uint8_t
+    {
+        GET = 1,
+        SET = 2,
+        LOAD = 3
+    };
+
+    struct WorkloadOp
+    {
+        WorkloadOpType type = WorkloadOpType::GET;
+        bool miss = false;
+        std::uint64_t timestamp_ns = 0;  // Since the recording started
+        std::uint32_t thread = 0;
+        std::string key;
+        std::uint64_t size = 0;
+    };
+
+    namespace workload
+    {
+        constexpr char kMagic[] = "CFGWKLD2";
+        constexpr std::size_t kMagicSize = sizeof(kMagic) - 1;
+        constexpr std::uint8_t kKeyDefinition = 0x00;
+        constexpr std::uint8_t kMissFlag = 0x80;
+
+        inline void put_varint(std::string &out, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        inline bool get_varint(const std::string &in, std::size_t &pos, std::uint64_t &value)
+        {
+            value = 0;
+            for (unsigned shift = 0; pos < in.size() && shift < 64; shift += 7)
+            {
+                std::uint8_t byte = static_cast<std::uint8_t>(in[pos++]);
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline std::uint64_t decimal_digits(std::uint64_t value)
+        {
+            std::uint64_t digits = 1;
+            for (; value >= 10; value /= 10)
+            {
+                ++digits;
+            }
+            return digits;
+        }
+
+        // Compact JSON length without serializing; string escapes are not counted
+        inline std::uint64_t json_length(const nlohmann::json &value)
+        {
+            switch (value.type())
+            {
+            case nlohmann::json::value_t::null:
+                return 4;
+            case nlohmann::json::value_t::boolean:
+                return value.get<bool>() ? 4 : 5;
+            case nlohmann::json::value_t::number_integer:
+            {
+                std::int64_t number = value.get<std::int64_t>();
+                return number < 0 ? 1 + decimal_digits(0 - static_cast<std::uint64_t>(number)) : decimal_digits(static_cast<std::uint64_t>(number));
+            }
+            case nlohmann::json::value_t::number_unsigned:
+                return decimal_digits(value.get<std::uint64_t>());
+            case nlohmann::json::value_t::number_float:
+            {
+                char digits[32];
+                auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value.get<double>());
+                return error == std::errc() ? static_cast<std::uint64_t>(end - digits) : sizeof(digits);
+            }
+            case nlohmann::json::value_t::string:
+                return value.get_ref<const std::string &>().size() + 2;
+            case nlohmann::json::value_t::array:
+            {
+                std::uint64_t length = 2 + (value.empty() ? 0 : value.size() - 1);
+                for (const auto &element : value)
+                {
+                    length += json_length(element);
+                }
+                return length;
+            }
+            case nlohmann::json::value_t::object:
+            {
+                std::uint64_t length = 2 + (value.empty() ? 0 : value.size() - 1);
+                for (auto it = value.begin(); it != value.end(); ++it)
+                {
+                    length += it.key().size() + 3 + json_length(it.value());
+                }
+                return length;
+            }
+            default:
+                return value.is_binary() ? value.get_binary().size() : 0;
+            }
+        }
+
+        inline std::uint64_t value_size(const nlohmann::json &value)
+        {
+            return value.is_string() ? value.get_ref<const std::string &>().size() : json_length(value);
+        }
+
+        // Small per-process thread numbers, assigned on first use
+        inline std::uint32_t thread_number()
+        {
+            static std::atomic<std::uint32_t> next{0};
+            thread_local std::uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+            return number;
+        }
+    } // namespace workload
+
+    class WorkloadRecorder
+    {
+    public:
+        explicit WorkloadRecorder(const std::string &file_path, std::size_t buffer_bytes = 64 * 1024)
+            : file_(file_path, std::ios::binary),
+              open_(file_.is_open()),
+              buffer_bytes_(buffer_bytes),
+              thread_buffer_bytes_(std::min<std::size_t>(buffer_bytes, kThreadBufferBytes)),
+              id_(next_id()),
+              start_(std::chrono::steady_clock::now())
+        {
+            if (!open_)
+            {
+                std::cerr << "Failed to open workload file for writing: " << file_path << std::endl;
+                return;
+            }
+            buffer_.reserve(buffer_bytes_ + 256);
+            buffer_.append(workload::kMagic, workload::kMagicSize);
+        }
+
+        ~WorkloadRecorder() { flush(); }
+
+        WorkloadRecorder(const WorkloadRecorder &) = delete;
+        WorkloadRecorder &operator=(const WorkloadRecorder &) = delete;
+
+        bool is_open() const { return open_; }
+
+        // Appends to the calling thread's buffer; the shared lock is only taken for new keys and full buffers
+        void record(WorkloadOpType type, std::string_view key, std::uint64_t size, bool miss = false)
+        {
+            if (!open_)
+            {
+                return;
+            }
+            std::uint64_t now = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+            ThreadLog &log = thread_log();
+            std::uint64_t key_id = key_id_for(log, key);
+            std::string full;
+            {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                now = std::max(now, log.last_ns);
+                log.buffer.push_back(static_cast<char>(static_cast<std::uint8_t>(type) | (miss ? workload::kMissFlag : 0)));
+                workload::put_varint(log.buffer, now - log.last_ns);
+                workload::put_varint(log.buffer, log.thread);
+                workload::put_varint(log.buffer, key_id);
+                workload::put_varint(log.buffer, size);
+                log.last_ns = now;
+                if (log.buffer.size() >= thread_buffer_bytes_)
+                {
+                    full.swap(log.buffer);
+                }
+            }
+            records_.fetch_add(1, std::memory_order_relaxed);
+            if (!full.empty())
+            {
+                // Only this thread appends to its log, so its ops still reach the file in order
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffer_.append(full);
+                if (buffer_.size() >= buffer_bytes_)
+                {
+                    flush_locked();
+                }
+            }
+        }
+
+        // Writes every thread's buffered ops to the file
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &[thread, log] : logs_)
+            {
+                std::lock_guard<std::mutex> log_lock(log->mutex);
+                buffer_.append(log->buffer);
+                log->buffer.clear();
+            }
+            flush_locked();
+        }
+
+        std::uint64_t records() const { return records_.load(std::memory_order_relaxed); }
+
+    private:
+        struct ThreadLog
+        {
+            std::mutex mutex;                    // Uncontended except against flush()
+            std::string buffer;
+            std::uint64_t last_ns = 0;
+            std::uint32_t thread = 0;
+            std::unordered_map<std::string_view, std::uint64_t> key_ids;  // Owner thread only; views into key_ids_
+        };
+
+        struct CachedLog
+        {
+            std::uint64_t recorder;
+            ThreadLog *log;
+        };
+
+        static constexpr std::size_t kThreadBufferBytes = 4 * 1024;
+        static constexpr std::size_t kThreadLogs = 8;
+
+        // Ids are never reused, so a cached log cannot outlive its recorder into a new one at the same address
+        static std::uint64_t next_id()
+        {
+            static std::atomic<std::uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ThreadLog &thread_log()
+        {
+            // Each thread keeps the logs of the recorders it used most recently, front first
+            thread_local std::vector<CachedLog> logs;
+            auto it = std::find_if(logs.begin(), logs.end(), [this](const CachedLog &cached) { return cached.recorder == id_; });
+            if (it == logs.end())
+            {
+                if (logs.size() >= kThreadLogs)
+                {
+                    logs.pop_back();
+                }
+                // An evicted entry finds the same log again, so per-thread deltas stay consistent
+                std::uint32_t thread = workload::thread_number();
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto &log = logs_[thread];
+                if (!log)
+                {
+                    log = std::make_unique<ThreadLog>();
+                    log->thread = thread;
+                    log->buffer.reserve(thread_buffer_bytes_ + 64);
+                }
+                it = logs.insert(logs.begin(), CachedLog{id_, log.get()});
+            }
+            else if (it != logs.begin())
+            {
+                std::rotate(logs.begin(), it, it + 1);
+                it = logs.begin();
+            }
+            return *it->log;
+        }
+
+        // Key definitions go straight to the shared buffer, so they always precede the ops using them
+        std::uint64_t key_id_for(ThreadLog &log, std::string_view key)
+        {
+            auto cached = log.key_ids.find(key);
+            if (cached != log.key_ids.end())
+            {
+                return cached->second;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = key_ids_.find(std::string(key));
+            if (it == key_ids_.end())
+            {
+                it = key_ids_.emplace(std::string(key), static_cast<std::uint64_t>(key_ids_.size())).first;
+                buffer_.push_back(static_cast<char>(workload::kKeyDefinition));
+                workload::put_varint(buffer_, key.size());
+                buffer_.append(key.data(), key.size());
+            }
+            log.key_ids.emplace(it->first, it->second);
+            return it->second;
+        }
+
+        void flush_locked()
+        {
+            if (open_ && !buffer_.empty())
+            {
+                file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+                file_.flush();
+                buffer_.clear();
+            }
+        }
+
+        mutable std::mutex mutex_;
+        std::ofstream file_;
+        const bool open_;
+        std::string buffer_;
+        std::size_t buffer_bytes_;
+        std::size_t thread_buffer_bytes_;
+        const std::uint64_t id_;
+        std::chrono::steady_clock::time_point start_;
+        std::atomic<std::uint64_t> records_{0};
+        std::unordered_map<std::string, std::uint64_t> key_ids_;                   // Node keys back the ThreadLog views
+        std::unordered_map<std::uint32_t, std::unique_ptr<ThreadLog>> logs_;      // By thread number
+    };
+
+    // Decodes a recording sorted by timestamp. Returns false if the file is missing or malformed, with
+    // the reason in `error` when given
+    inline bool read_workload(const std::string &file_path, std::vector<WorkloadOp> &ops, std::string *error = nullptr)
+    {
+        auto fail = [error](std::string reason) {
+            if (error)
+            {
+                *error = std::move(reason);
+            }
+            return false;
+        };
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return fail("Failed to open workload file: " + file_path);
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.compare(0, workload::kMagicSize, workload::kMagic) != 0)
+        {
+            return fail("Not a workload recording: " + file_path);
+        }
+        std::vector<std::string> keys;
+        std::unordered_map<std::uint64_t, std::uint64_t> thread_timestamps;
+        std::size_t first_op = ops.size();
+        std::size_t pos = workload::kMagicSize;
+        while (pos < data.size())
+        {
+            std::size_t record_start = pos;
+            std::uint8_t tag = static_cast<std::uint8_t>(data[pos++]);
+            bool ok = true;
+            if (tag == workload::kKeyDefinition)
+            {
+                std::uint64_t length = 0;
+                ok = workload::get_varint(data, pos, length) && length <= data.size() - pos;
+                if (ok)
+                {
+                    keys.emplace_back(data, pos, length);
+                    pos += length;
+                }
+            }
+            else
+            {
+                std::uint64_t delta = 0, thread = 0, key = 0, size = 0;
+                std::uint8_t type = tag & ~workload::kMissFlag;
+                ok = type >= 1 && type <= 3 && workload::get_varint(data, pos, delta) && workload::get_varint(data, pos, thread)
+                     && workload::get_varint(data, pos, key) && workload::get_varint(data, pos, size) && key < keys.size();
+                if (ok)
+                {
+                    std::uint64_t &last = thread_timestamps[thread];
+                    last += delta;
+                    WorkloadOp op;
+                    op.type = static_cast<WorkloadOpType>(type);
+                    op.miss = (tag & workload::kMissFlag) != 0;
+                    op.timestamp_ns = last;
+                    op.thread = static_cast<std::uint32_t>(thread);
+                    op.key = keys[key];
+                    op.size = size;
+                    ops.push_back(std::move(op));
+                }
+            }
+            if (!ok)
+            {
+                return fail("Malformed workload record at offset " + std::to_string(record_start) + " in " + file_path);
+            }
+        }
+        // Stable, so each thread's ops keep their recorded order
+        std::stable_sort(ops.begin() + static_cast<std::ptrdiff_t>(first_op), ops.end(),
+                         [](const WorkloadOp &a, const WorkloadOp &b) { return a.timestamp_ns < b.timestamp_ns; });
+        return true;
+    }
+
+    struct ReplayOptions
+    {
+        bool preserve_timing = false;   // Wait until each op's recorded time; otherwise run flat out
+        double speed = 1.0;             // Timing multiplier when preserving timing
+        bool replay_loads = true;       // Call load_from_file for recorded loads
+        bool seed = true;               // Set keys that were read successfully before replaying
+    };
+
+    struct ReplayResult
+    {
+        std::uint64_t ops = 0;
+        std::uint64_t gets = 0;
+        std::uint64_t sets = 0;
+        std::uint64_t loads = 0;
+        std::uint64_t misses = 0;
+        std::uint32_t threads = 0;
+        std::chrono::nanoseconds wall{0};
+        std::chrono::nanoseconds get_time{0};
+        std::chrono::nanoseconds set_time{0};
+        std::chrono::nanoseconds load_time{0};
+
+        nlohmann::json to_json() const
+        {
+            return {
+                {"ops", ops},
+                {"gets", gets},
+                {"sets", sets},
+                {"loads", loads},
+                {"misses", misses},
+                {"threads", threads},
+                {"wall_ns", wall.count()},
+                {"get_ns", get_time.count()},
+                {"set_ns", set_time.count()},
+                {"load_ns", load_time.count()}
+            };
+        }
+    };
+
+    // Replays `ops` against `storage`, one thread per recorded thread, keeping each thread's order
+    template <typename Storage = IConfigStorage>
+    ReplayResult replay_workload(const std::vector<WorkloadOp> &ops, Storage &storage, const ReplayOptions &options = {})
+    {
+        ReplayResult result;
+        std::unordered_map<std::uint32_t, std::vector<const WorkloadOp *>> per_thread;
+        std::unordered_set<std::string> seeded;
+        for (const auto &op : ops)
+        {
+            per_thread[op.thread].push_back(&op);
+            if (options.seed && op.type == WorkloadOpType::GET && !op.miss && seeded.insert(op.key).second)
+            {
+                storage.set(op.key, std::string(op.size, 'x'));
+            }
+        }
+        result.threads = static_cast<std::uint32_t>(per_thread.size());
+
+        std::mutex result_mutex;
+        auto start = std::chrono::steady_clock::now();
+        auto run = [&](const std::vector<const WorkloadOp *> &thread_ops) {
+            ReplayResult local;
+            for (const WorkloadOp *op : thread_ops)
+            {
+                if (options.preserve_timing)
+                {
+                    auto due = std::chrono::nanoseconds(static_cast<std::int64_t>(static_cast<double>(op->timestamp_ns) / options.speed));
+                    std::this_thread::sleep_until(start + due);
+                }
+                auto op_start = std::chrono::steady_clock::now();
+                switch (op->type)
+                {
+                case WorkloadOpType::GET:
+                    try
+                    {
+                        nlohmann::json value = storage.get(op->key);
+                        (void)value;
+                    }
+                    catch (const std::invalid_argument &)
+                    {
+                        ++local.misses;
+                    }
+                    ++local.gets;
+                    local.get_time += std::chrono::steady_clock::now() - op_start;
+                    break;
+                case WorkloadOpType::SET:
+                    storage.set(op->key, std::string(op->size, 'x'));
+                    ++local.sets;
+                    local.set_time += std::chrono::steady_clock::now() - op_start;
+                    break;
+                case WorkloadOpType::LOAD:
+                    if (options.replay_loads)
+                    {
+                        storage.load_from_file(op->key);
+                        ++local.loads;
+                        local.load_time += std::chrono::steady_clock::now() - op_start;
+                    }
+                    break;
+                }
+            }
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result.gets += local.gets;
+            result.sets += local.sets;
+            result.loads += local.loads;
+            result.misses += local.misses;
+            result.get_time += local.get_time;
+            result.set_time += local.set_time;
+            result.load_time += local.load_time;
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(per_thread.size());
+        for (const auto &[thread, thread_ops] : per_thread)
+        {
+            threads.emplace_back(run, std::cref(thread_ops));
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        result.wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        result.ops = result.gets + result.sets + result.loads;
+        return result;
+    }
+
+} // namespace config
+
+#endif // CONFIG_WORKLOAD_HPP
@@ -28,34 +28,128 @@ Key Classes and Functions:
    - Functions:
      - `virtual nlohmann::json get(const std::string &key) const = 0`: Gets the value for a given key.
      - `virtual void set(const std::string &key, const nlohmann::json &value) = 0`: Sets the value for a given key.
+     - `virtual void set(const std::string &key, nlohmann::json &&value)`: Sets the value by moving it into storage (defaults to copying).
      - `virtual std::unordered_map<std::string, nlohmann::json> get_all() const = 0`: Gets all key-value pairs.
-     - `virtual void load_from_file(const std::string &file_path) = 0`: Loads configuration from a file.
-     - `virtual void save_to_file(const std::string &file_path) const = 0`: Saves configuration to a file.
+     - `virtual IoResult load_from_file(const std::string &file_path) = 0`: Loads configuration from a file.
+     - `virtual IoResult save_to_file(const std::string &file_path) const = 0`: Saves configuration to a file.
      - `virtual void remove(const std::string &key) = 0`: Removes a key-value pair.
      - `virtual bool exists(const std::string &key) const = 0`: Checks if a key exists.
      - `virtual void clear() = 0`: Clears all configurations.
-     - `virtual void load_from_file(const std::string &file_path, const std::string &version) = 0`: Loads configuration from a file with a specific version.
-     - `virtual void save_to_file(const std::string &file_path, const std::string &version) const = 0`: Saves configuration to a file with a specific version.
+     - `virtual IoResult load_from_file(const std::string &file_path, const std::string &version) = 0`: Loads configuration from a file with a specific version.
+     - `virtual IoResult save_to_file(const std::string &file_path, const std::string &version) const = 0`: Saves configuration to a file with a specific version.
      - `virtual void load_from_env() = 0`: Loads configuration from environment variables.
      - `virtual void add_change_listener(const std::function<void(const std::string &, const nlohmann::json &)> &listener) = 0`: Adds a change listener.
-     - `virtual void backup_to_file(const std::string &backup_file_path) const = 0`: Backs up the configuration to a file.
+     - `virtual IoResult backup_to_file(const std::string &backup_file_path) const = 0`: Backs up the configuration to a file.
      - `template<typename T = void> typename std::enable_if<std::is_same<T, std::ostream&>::value, std::ostream&>::type output_config(std::ostream &os) const`: Outputs the configuration to an ostream.
      - `template<typename T = void> typename std::enable_if<std::is_same<T, void>::value, void>::type output_config(std::ostream &os) const`: Outputs the configuration to an ostream (void specialization).
 2. Config Class
    - Implements the IConfigStorage interface and provides configuration management functionality.
    - Functions: Same as IConfigStorage interface, with additional functions for instance management.
+   - `set(key, std::move(value))`, `emplace(key, args...)` and `update_multiple(std::move(map))` move values into storage;
+     loads move parsed values out of the document.
 3. ConfigFactory Class
    - Provides factory methods to create and manage Config instances.
    - Functions:
      - `static std::shared_ptr<Config> create_config(const std::string &name = "default")`: Creates a basic config instance.
      - `static std::shared_ptr<Config> create_new_config_from_existing(const std::string &name, const std::string &filePath)`: Creates a new config instance from an existing configuration file.
      - `static std::shared_ptr<Config> create_config_with_defaults(const std::string &name, const std::unordered_map<std::string, nlohmann::json> &defaults)`: Creates a config instance with default values.
+       An rvalue `defaults` map is moved into the instance instead of copied.
      - `static std::shared_ptr<Config> create_env_config(const std::string &name, const std::string &environment)`: Creates a config instance for a specific environment.
      - `static std::shared_ptr<Config> create_env_loaded_config(const std::string &name)`: Creates a config instance and loads it from environment variables.
      - `static std::shared_ptr<Config> create_thread_safe_config(const std::string &name = "default")`: Thread-safe method to create or get a config instance.
      - `static std::shared_ptr<Config> get_pooled_config(const std::string &name = "default")`: Pools and reuses instances.
 4. Template Functions
    - Handle different data types and custom format functions.
+5. IoResult Struct
+   - Returned by the load/save functions (including the partial variants) and backup_to_file instead of printing
+     or swallowing errors; nothing is written to std::cerr.
+   - Saves and backups write a temporary file and rename it over the target, so failures leave the old file intact.
+   - Holds an `IoError` code, message and location (file, line, column, byte offset), per-phase
+     timings (open, read, parse, convert, insert, write) and the byte and key counts.
+   - `to_json()` renders the result for logging and monitoring.
+6. Runtime Metrics (config_metrics.hpp)
+   - `enable_metrics()` / `disable_metrics()`: Opt-in per instance; disabled instances pay one relaxed atomic load per call.
+   - `stats()`: Snapshot of reads, writes, misses, listener invocations and mutex wait/hold times.
+   - `stats_prometheus(instance_label)`: The same snapshot in Prometheus text format.
+   - Counters are sharded per thread on separate cache lines.
+7. Hot-Key Profiler (config_profiler.hpp)
+   - `attach_profiler(std::shared_ptr<ConfigProfiler>)` / `detach_profiler()`: Samples 1-in-N get/set calls.
+   - `ConfigProfiler::TagScope`: Labels the calls made by the current thread.
+   - `ConfigProfiler::report()`: Top-K hot keys (space-saving counter) with latencies and tags; optionally on a timer.
+8. Tracing (config_trace.hpp)
+   - `ConfigTracer::global().start(TraceOptions)` / `stop()`: Records Chrome trace events into a ring buffer and
+     optionally writes them to a file viewable in Perfetto.
+   - Hooks: load_from_file, load_partial_from_file, save_to_file, save_partial_to_file, load_from_env,
+     output_config and each change listener call.
+9. Memory Accounting (config_memory.hpp)
+   - `memory_usage()`: Estimated heap bytes per top-level key, per value type and for the instance, including
+     json node, container, string and hash-table overhead.
+   - `Config::registry_memory_usage()`: The same for every `Config::instance` entry; `Config::instance_names()` lists them.
+10. Workload Record and Replay (config_workload.hpp)
+   - `attach_recorder(std::shared_ptr<WorkloadRecorder>)` / `detach_recorder()`: Logs get, set and load calls
+     (key, value size, thread, timestamp) to a compact binary file.
+   - `read_workload()` and `replay_workload()`: Re-run a recording against any IConfigStorage; see tools/config_replay.cpp.
+11. Typed Reads (config_convert.hpp)
+   - `get_duration(key)`: Parses "250ms", "1h30m" or a number of milliseconds into std::chrono::nanoseconds.
+   - `get_bytes(key)`: Parses "64MiB", "1.5GB" or a plain number into a byte count.
+   - `get_as<T, Parser>(key)`: Any conversion; the result is cached with the entry until the key is written again.
+12. Columnar Arrays (config_array.hpp)
+   - `set_array(key, values)`: Stores a double or std::int64_t array in one contiguous, 64-byte aligned buffer.
+   - `get_array<T>(key)`: ArrayView sharing that buffer (no copy); `span()` in C++20 builds.
+   - `set_array_promotion_threshold(n)`: Stores json arrays of n or more integers, or n or more floats, as columnar arrays.
+   - get, get_all, save and output functions still see the arrays as json arrays.
+13. Queries (config_query.hpp)
+   - `CompiledQuery(path)`: A JSON Pointer ("/a/0/b") or JSONPath subset ("$.a[0].b", "$.a[*].b", "$..b") parsed once.
+   - `query(compiled)` / `query(path)`: Copies of the matching nodes; `query_each(compiled, fn)` visits them in place.
+   - Resolved node locations are cached per query until the top-level key (or, for "$.*" and "$..", any key) is written.
+14. Key Range Scans
+   - `keys_with_prefix(prefix)`: Sorted keys starting with prefix.
+   - `for_each_in_range(lo, hi, fn)`: Visits keys in [lo, hi) in order without copying the map.
+   - Backed by a sorted index over the hash map's keys, built on the first scan and maintained on every write after that.
+15. Key Search (config_match.hpp)
+   - `KeyMatcher::glob(pattern)` / `KeyMatcher::regex(pattern)`: Matchers compiled once and reusable across calls and threads.
+   - `find_keys(matcher, options)` / `find_keys(glob)`: Sorted matching keys; literal prefixes narrow the scan through the key index,
+     and large candidate sets are matched in parallel.
+16. Interpolation (config_interpolate.hpp)
+   - `get_interpolated(key)`: Expands "${key}" (and, when enabled, "${env:NAME}") references on first read and memoizes the result.
+   - Writes drop only the memoized results that depended on the written key, following the dependency graph.
+   - `set_interpolation_options(options)`: Environment access and maximum reference depth.
+17. Derived Keys (config_derived.hpp)
+   - `define_derived(key, inputs, fn)`: Stores fn(inputs) as an ordinary entry, so reads stay a single lookup.
+   - Writes to an input recompute only the derived keys downstream of it, in topological order, stopping where a value is unchanged.
+   - Cycles are rejected when defined; `remove_derived(key)` and `is_derived(key)` manage definitions.
+   - A function that throws keeps the previous value; `derived_error(key)` returns what it threw.
+18. Feature Flags (config_flags.hpp, included separately)
+   - `FeatureFlags::bind(config, key)`: Compiles the flag definitions under key and rebuilds them atomically when the key is set
+     or the config is reloaded (`add_reload_listener` runs after loads, load_from_env, clear and remove).
+   - `enabled(handle_or_name, FlagContext)`: Lock-free, allocation-free evaluation of targeting rules and consistent-hash rollouts.
+19. Value Interning (config_intern.hpp)
+   - `enable_interning(interner)`: Stores large object and array values identical to one already interned as a shared, immutable copy.
+   - Writes replace the shared pointer, so other instances keep their value; `ValueInterner::stats()` reports the bytes saved.
+   - `disable_interning()` stops sharing new writes; `is_shared(key)` tells whether a key's value is shared.
+20. Lazy Loading (config_lazy.hpp)
+   - `set_lazy_loading(true)`: JSON loads read the file into a private copy and record each top-level value's byte range in one
+     structural scan, so later rewrites of the file do not affect unparsed keys.
+   - Each value is parsed on its first read and kept; `is_lazy(key)` tells whether a key is still unparsed.
+   - Malformed values inside a structurally valid document throw std::invalid_argument when they are read.
+21. Memory Budget (config_spill.hpp)
+   - `set_memory_budget(budget)`: Keeps parsed values under `resident_bytes` by evicting the least recently used large
+     values, and any value of `spill_threshold` bytes or more, to unlinked memory-mapped spill segments.
+   - Evicted values are reloaded on their next read; `is_spilled(key)` and `spill_stats()` report the current state.
+   - Enforced after writes and loads, and by `enforce_memory_budget()`.
+22. Capacity
+   - `reserve(keys)`: Sizes the key table once for a known workload; `bucket_count()` reports its current size.
+   - `shrink_to_fit()`: Releases buckets and spare capacity after bulk removals.
+   - load_from_file, load_partial_from_file, load_from_env and update_multiple reserve for all incoming keys before inserting.
+23. Asynchronous I/O (config_async.hpp, included separately)
+   - `async_load`, `async_save`, `async_backup`: Run the blocking operation on an executor and return a std::future<IoResult>,
+     or call a completion handler with it.
+   - `AsyncOptions`: Priority (HIGH, NORMAL, LOW), a CancellationToken for requests that have not started, and the executor.
+24. Batched Multi-File Loads (config_batch_io.hpp)
+   - `load_from_files(paths, options, stats)`: Reads every file in one batch, parses them in parallel and applies them in order,
+     later files overriding earlier ones. Returns one IoResult per path.
+   - On Linux the batch goes through io_uring (raw system calls, no liburing); elsewhere, or when the kernel refuses it,
+     through open/fstat/read/close. `BatchLoadOptions` selects the backend and registered buffers.
 */
 
 /*
@@ -104,6 +198,206 @@ config.save_to_file("config.yaml", "1.0.0");
 
 */
 
+/* Example: Check a load and inspect its phase timings */
+/*
+
+IoResult result = config.load_from_file("config.json");
+if (!result) {
+    std::cerr << result.message << " at line " << result.line << std::endl;
+}
+std::cout << result.to_json().dump() << std::endl;
+
+*/
+
+/* Example: Track how hard the config layer is used */
+/*
+
+config.enable_metrics();
+config.get("name");
+ConfigStats stats = config.stats();
+std::cout << stats.reads << " reads, miss rate " << stats.miss_rate() << std::endl;
+std::cout << config.stats_prometheus("default");
+
+*/
+
+/* Example: Find the hottest keys */
+/*
+
+auto profiler = std::make_shared<ConfigProfiler>(ProfilerOptions{});
+config.attach_profiler(profiler);
+{
+    ConfigProfiler::TagScope tag("request_handler");
+    config.get("name");
+}
+std::cout << profiler->report().to_string();
+
+*/
+
+/* Example: Trace loads and listeners for Perfetto */
+/*
+
+ConfigTracer::global().start({"config_trace.json"});
+config.load_from_file("config.json");
+config.set("name", "traced");
+ConfigTracer::global().stop(); // Writes config_trace.json
+
+*/
+
+/* Example: Find the keys and instances that use the most memory */
+/*
+
+MemoryUsage usage = config.memory_usage();
+std::cout << usage.total_bytes << " bytes, largest key " << usage.keys[0].key << std::endl;
+std::cout << Config::registry_memory_usage().to_json().dump(4) << std::endl;
+
+*/
+
+/* Example: Record a workload for replay with config_replay */
+/*
+
+config.attach_recorder(std::make_shared<WorkloadRecorder>("config.workload"));
+config.get("name");
+config.detach_recorder();
+
+*/
+
+/* Example: Typed reads that parse once */
+/*
+
+config.set("timeout", "250ms");
+config.set("cache_size", "64MiB");
+auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(config.get_duration("timeout"));
+std::uint64_t cache_bytes = config.get_bytes("cache_size");
+int port = config.get_as<int>("port");
+
+*/
+
+/* Example: Large numeric tables without per-element json nodes */
+/*
+
+config.set_array("thresholds", std::vector<double>(100000, 0.5));
+ArrayView<double> thresholds = config.get_array<double>("thresholds");
+double sum = std::accumulate(thresholds.begin(), thresholds.end(), 0.0);
+
+*/
+
+/* Example: Deep lookups compiled once */
+/*
+
+CompiledQuery backend_ports("$.routes[*].backends[*].port");
+std::vector<nlohmann::json> ports = config.query(backend_ports);
+nlohmann::json primary = config.query("/db/primary").at(0);
+
+*/
+
+/* Example: Scan one section of the key space */
+/*
+
+std::vector<std::string> db_keys = config.keys_with_prefix("db.");
+config.for_each_in_range("db.", "db/", [](const std::string &key, const nlohmann::json &value) {
+    std::cout << key << " = " << value << std::endl;
+});
+
+*/
+
+/* Example: Find keys by glob or regex */
+/*
+
+std::vector<std::string> ports = config.find_keys("db.*.port");
+KeyMatcher replicas = KeyMatcher::regex("^db\\.replica[0-9]+\\.");
+std::vector<std::string> replica_keys = config.find_keys(replicas);
+
+*/
+
+/* Example: Build values from other keys */
+/*
+
+config.set("db_host", "db.internal");
+config.set("db_port", 5432);
+config.set("db_url", "postgres://${db_host}:${db_port}/app");
+std::cout << config.get_interpolated("db_url") << std::endl;
+
+*/
+
+/* Expected result:
+
+"postgres://db.internal:5432/app"
+
+*/
+
+/* Example: Keys computed from other keys */
+/*
+
+config.set("cores", 8);
+config.set("per_core", 4);
+config.define_derived("pool_size", {"cores", "per_core"}, [](const DerivedInputs &in) {
+    return in["cores"].get<int>() * in["per_core"].get<int>();
+});
+config.set("cores", 16);
+std::cout << config.get("pool_size") << std::endl;
+
+*/
+
+/* Expected result:
+
+64
+
+*/
+
+/* Example: Share identical blocks across tenants */
+/*
+
+for (const auto &tenant : tenants) {
+    Config &config = Config::instance(tenant);
+    config.enable_interning();
+    config.load_from_file(tenant + ".json");
+}
+std::cout << ValueInterner::global()->stats().saved_bytes << " bytes saved" << std::endl;
+
+*/
+
+/* Example: Open a huge file and parse only what is used */
+/*
+
+config.set_lazy_loading(true);
+config.load_from_file("catalog.json");   // Structural scan only
+nlohmann::json db = config.get("db");      // "db" is parsed here, the rest stays raw
+
+*/
+
+/* Example: Bound resident memory */
+/*
+
+MemoryBudget budget;
+budget.resident_bytes = 64 << 20;
+budget.spill_threshold = 1 << 20;
+config.set_memory_budget(budget);
+config.load_from_file("models.json");
+std::cout << config.spill_stats().to_json().dump() << std::endl;
+
+*/
+
+/* Example: Save without blocking the event loop */
+/*
+
+#include "config_async.hpp"
+
+async_save(config, "service.json", [](const IoResult &result) {
+    if (!result) std::cerr << result.message << std::endl;
+}, AsyncOptions{AsyncPriority::LOW});
+
+*/
+
+/* Example: Load a directory of fragments in one batch */
+/*
+
+std::vector<std::string> fragments = {"conf.d/10-base.json", "conf.d/20-db.yaml", "conf.d/30-local.json"};
+for (const IoResult &result : config.load_from_files(fragments)) {
+    if (!result) std::cerr << result.to_json().dump() << std::endl;
+}
+
+*/
+
 /* Example: Add change listener */
 /*
 
@@ -261,6 +555,10 @@ complex:
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <set>
+#include <optional>
 #include <mutex>
 #include <fstream>
 #include <stdexcept>
@@ -272,7 +570,30 @@ complex:
 #include <vector>
 #include <sstream>
 #include <unistd.h> // For environ
-#include <string.h> 
+#include <string.h>
+#include <cstdio>
+#include <string_view>
+#include <chrono>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "config_metrics.hpp"
+#include "config_profiler.hpp"
+#include "config_trace.hpp"
+#include "config_memory.hpp"
+#include "config_workload.hpp"
+#include "config_convert.hpp"
+#include "config_array.hpp"
+#include "config_query.hpp"
+#include "config_match.hpp"
+#include "config_interpolate.hpp"
+#include "config_derived.hpp"
+#include "config_intern.hpp"
+#include "config_lazy.hpp"
+#include "config_spill.hpp"
+#include "config_batch_io.hpp"
+#include <typeindex>
 
 
 #define FORMAT_MANAGER_INCLUDED  // Comment out line to exclude format manager functionality
@@ -284,23 +605,131 @@ complex:
 namespace config
 {
 
+    // Error codes reported by the file load/save functions
+    enum class IoError
+    {
+        NONE,
+        OPEN_FAILED,
+        READ_FAILED,
+        PARSE_FAILED,
+        CONVERSION_FAILED,
+        UNSUPPORTED_FORMAT,
+        WRITE_FAILED,
+        CANCELLED
+    };
+
+    constexpr std::string_view io_error_to_string(IoError error) noexcept
+    {
+        switch (error)
+        {
+        case IoError::NONE: return "none";
+        case IoError::OPEN_FAILED: return "open_failed";
+        case IoError::READ_FAILED: return "read_failed";
+        case IoError::PARSE_FAILED: return "parse_failed";
+        case IoError::CONVERSION_FAILED: return "conversion_failed";
+        case IoError::UNSUPPORTED_FORMAT: return "unsupported_format";
+        case IoError::WRITE_FAILED: return "write_failed";
+        case IoError::CANCELLED: return "cancelled";
+        }
+        return "unknown";
+    }
+
+    // Wall-clock time spent in each phase of a load or save
+    struct IoPhaseTimings
+    {
+        std::chrono::nanoseconds open{0};
+        std::chrono::nanoseconds read{0};
+        std::chrono::nanoseconds parse{0};
+        std::chrono::nanoseconds convert{0};
+        std::chrono::nanoseconds insert{0};
+        std::chrono::nanoseconds write{0};
+
+        std::chrono::nanoseconds total() const
+        {
+            return open + read + parse + convert + insert + write;
+        }
+    };
+
+    // Outcome of a load or save: error code and location, phase timings, byte and key counts
+    struct IoResult
+    {
+        IoError error = IoError::NONE;
+        std::string message;
+        std::string file_path;
+        std::size_t line = 0;   // 1-based, 0 when unknown
+        std::size_t column = 0; // 1-based, 0 when unknown
+        std::size_t offset = 0; // Byte offset of the error in the file
+        IoPhaseTimings timings;
+        std::size_t bytes = 0;  // Bytes read or written
+        std::size_t keys = 0;   // Top-level keys loaded or saved
+
+        bool ok() const { return error == IoError::NONE; }
+        explicit operator bool() const { return ok(); }
+
+        nlohmann::json to_json() const
+        {
+            nlohmann::json j = {
+                {"ok", ok()},
+                {"error", io_error_to_string(error)},
+                {"file", file_path},
+                {"bytes", bytes},
+                {"keys", keys},
+                {"timings_ns", {
+                    {"open", timings.open.count()},
+                    {"read", timings.read.count()},
+                    {"parse", timings.parse.count()},
+                    {"convert", timings.convert.count()},
+                    {"insert", timings.insert.count()},
+                    {"write", timings.write.count()},
+                    {"total", timings.total().count()}
+                }}
+            };
+            if (!ok())
+            {
+                j["message"] = message;
+                j["line"] = line;
+                j["column"] = column;
+                j["offset"] = offset;
+            }
+            return j;
+        }
+    };
+
+    // Measures consecutive phases; each lap() returns the time since the previous one
+    class IoPhaseClock
+    {
+    public:
+        IoPhaseClock() : last_(std::chrono::steady_clock::now()) {}
+        std::chrono::nanoseconds lap()
+        {
+            auto now = std::chrono::steady_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_);
+            last_ = now;
+            return elapsed;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point last_;
+    };
+
     class IConfigStorage
     {
     public:
         virtual ~IConfigStorage() = default;
         virtual nlohmann::json get(const std::string &key) const = 0;
         virtual void set(const std::string &key, const nlohmann::json &value) = 0;
+        virtual void set(const std::string &key, nlohmann::json &&value) { set(key, static_cast<const nlohmann::json &>(value)); }
         virtual std::unordered_map<std::string, nlohmann::json> get_all() const = 0;
-        virtual void load_from_file(const std::string &file_path) = 0;
-        virtual void save_to_file(const std::string &file_path) const = 0;
+        virtual IoResult load_from_file(const std::string &file_path) = 0;
+        virtual IoResult save_to_file(const std::string &file_path) const = 0;
         virtual void remove(const std::string &key) = 0;
         virtual bool exists(const std::string &key) const = 0;
         virtual void clear() = 0;
-        virtual void load_from_file(const std::string &file_path, const std::string &version) = 0;
-        virtual void save_to_file(const std::string &file_path, const std::string &version) const = 0;
+        virtual IoResult load_from_file(const std::string &file_path, const std::string &version) = 0;
+        virtual IoResult save_to_file(const std::string &file_path, const std::string &version) const = 0;
         virtual void load_from_env() = 0;
         virtual void add_change_listener(const std::function<void(const std::string &, const nlohmann::json &)> &listener) = 0;
-        virtual void backup_to_file(const std::string &backup_file_path) const = 0;
+        virtual IoResult backup_to_file(const std::string &backup_file_path) const = 0;
 
 #ifdef FORMAT_MANAGER_INCLUDED
         template<typename T = void>
@@ -320,27 +749,121 @@ namespace config
     public:
         Config() = default;
         static Config& instance(const std::string &name = "default");
+        static std::vector<std::string> instance_names();
+        static RegistryMemoryUsage registry_memory_usage();
 
         // Public method declarations
         nlohmann::json get(const std::string &key) const override;
         void set(const std::string &key, const nlohmann::json &value) override;
+        void set(const std::string &key, nlohmann::json &&value) override; // Moves the value into storage
+        template <typename... Args>
+        void emplace(const std::string &key, Args &&...args); // Builds the json value from args, then moves it in
         std::unordered_map<std::string, nlohmann::json> get_all() const override;
         void validate(const std::unordered_map<std::string, std::function<bool(const nlohmann::json &)>> &validators) const;
-        void load_from_file(const std::string &file_path) override;
-        void save_to_file(const std::string &file_path) const override;
+        IoResult load_from_file(const std::string &file_path) override;
+        IoResult save_to_file(const std::string &file_path) const override;
         void remove(const std::string &key) override;
         bool exists(const std::string &key) const override;
         void clear() override;
         void display() const;
         std::vector<nlohmann::json> inspect(const std::vector<std::string> &keys) const;
         void update_multiple(const std::unordered_map<std::string, nlohmann::json> &new_cfg);
-        void load_partial_from_file(const std::string &file_path, const std::vector<std::string> &keys);
-        void save_partial_to_file(const std::string &file_path, const std::vector<std::string> &keys) const;
-        void load_from_file(const std::string &file_path, const std::string &version) override;
-        void save_to_file(const std::string &file_path, const std::string &version) const override;
+        void update_multiple(std::unordered_map<std::string, nlohmann::json> &&new_cfg);
+        IoResult load_partial_from_file(const std::string &file_path, const std::vector<std::string> &keys);
+        IoResult save_partial_to_file(const std::string &file_path, const std::vector<std::string> &keys) const;
+        // Loads many files, later files overriding earlier ones: one batched read, then parallel parsing.
+        // Returns one IoResult per path, in order; a file that fails is skipped
+        std::vector<IoResult> load_from_files(const std::vector<std::string> &file_paths, const BatchLoadOptions &options = BatchLoadOptions{},
+                                              BatchReadStats *stats = nullptr);
+        IoResult load_from_file(const std::string &file_path, const std::string &version) override;
+        IoResult save_to_file(const std::string &file_path, const std::string &version) const override;
         void load_from_env() override;
         void add_change_listener(const std::function<void(const std::string &, const nlohmann::json &)> &listener) override;
-        void backup_to_file(const std::string &backup_file_path) const override;
+        IoResult backup_to_file(const std::string &backup_file_path) const override;
+
+        // Called after loads, load_from_env, clear and remove, which change keys without calling change listeners.
+        // Runs once the instance lock is released, so the listener may read the config.
+        void add_reload_listener(const std::function<void()> &listener);
+
+        // Runtime metrics (off by default)
+        void enable_metrics();
+        void disable_metrics();
+        bool metrics_enabled() const;
+        ConfigStats stats() const;
+        std::string stats_prometheus(const std::string &instance_label = "default") const;
+        void reset_stats();
+
+        // Sampling hot-key profiler for get/set (off until attached)
+        void attach_profiler(std::shared_ptr<ConfigProfiler> profiler);
+        void detach_profiler();
+        std::shared_ptr<ConfigProfiler> profiler() const;
+
+        // Typed reads; the converted value is cached per key until the key is written again
+        template <typename T, typename Parser = JsonParser<T>>
+        T get_as(const std::string &key, Parser parser = Parser{}) const;
+        std::chrono::nanoseconds get_duration(const std::string &key) const;
+        std::uint64_t get_bytes(const std::string &key) const;
+
+        // Columnar storage for large numeric arrays; get_array returns a view without copying
+        template <typename T>
+        void set_array(const std::string &key, AlignedBuffer<T> values);
+        template <typename T>
+        void set_array(const std::string &key, const std::vector<T> &values);
+        template <typename T>
+        ArrayView<T> get_array(const std::string &key) const;
+        bool is_columnar(const std::string &key) const;
+        void set_array_promotion_threshold(std::size_t min_elements); // 0 disables automatic promotion
+
+        // Nested lookups by JSON Pointer or JSONPath subset; resolved locations are cached until the key is written again
+        std::vector<nlohmann::json> query(const CompiledQuery &compiled) const;
+        std::vector<nlohmann::json> query(const std::string &path) const;
+        void query_each(const CompiledQuery &compiled, const std::function<void(const nlohmann::json &)> &visit) const; // No copies; visit runs under the lock
+
+        // Ordered key scans without copying the map; fn runs under the lock. An empty `hi` scans to the last key
+        std::vector<std::string> keys_with_prefix(std::string_view prefix) const;
+        void for_each_in_range(std::string_view lo, std::string_view hi, const std::function<void(const std::string &, const nlohmann::json &)> &fn) const;
+
+        // Sorted keys matching a compiled glob or regex; literal prefixes only scan that index range
+        std::vector<std::string> find_keys(const KeyMatcher &matcher, const FindOptions &options = FindOptions{}) const;
+        std::vector<std::string> find_keys(const std::string &glob) const;
+
+        // Values with ${key} and ${env:NAME} references expanded; memoized until a key they depend on is written
+        nlohmann::json get_interpolated(const std::string &key) const;
+        void set_interpolation_options(const InterpolationOptions &options);
+
+        // Keys computed from other keys, stored as ordinary entries and recomputed in topological order when an input changes
+        void define_derived(const std::string &key, const std::vector<std::string> &inputs, DeriveFunction fn);
+        void remove_derived(const std::string &key); // The last computed value stays as an ordinary entry
+        bool is_derived(const std::string &key) const;
+        std::string derived_error(const std::string &key) const; // Why the last recomputation failed; empty if it did not
+
+        // Hash-consing: large object and array values identical to one already in the interner share its copy.
+        // Disabling keeps existing shared values; they are replaced on their next write
+        void enable_interning(std::shared_ptr<ValueInterner> interner = ValueInterner::global());
+        void disable_interning();
+        bool is_shared(const std::string &key) const;
+
+        // Lazy JSON loads: load_from_file only records where each top-level value is, and parses it on first read
+        void set_lazy_loading(bool enabled);
+        bool is_lazy(const std::string &key) const; // Loaded lazily and not read yet; spilled keys report is_spilled instead
+
+        // Resident-memory budget: large, least recently used values are evicted to mapped spill segments and reloaded on access
+        void set_memory_budget(const MemoryBudget &budget); // Enforced immediately; a default MemoryBudget turns it off
+        void enforce_memory_budget();
+        bool is_spilled(const std::string &key) const;
+        SpillStats spill_stats() const;
+
+        // Workload recording of get/set/load calls for replay (off until attached)
+        void attach_recorder(std::shared_ptr<WorkloadRecorder> recorder);
+        void detach_recorder();
+
+        // Estimated heap footprint per top-level key, per value type and for the whole instance
+        MemoryUsage memory_usage() const;
+
+        // Capacity control: reserve buckets for a known key count up front, or release them after bulk removals
+        void reserve(std::size_t keys);
+        void shrink_to_fit();
+        std::size_t bucket_count() const;
 
 #ifdef FORMAT_MANAGER_INCLUDED
         template<typename T = void>
@@ -358,11 +881,186 @@ namespace config
         Config(Config&& other) noexcept; // Custom move constructor
         Config& operator=(Config&& other) noexcept; // Custom move assignment
 
+        // Named instances handed out by instance(), enumerable for registry-wide reports
+        struct Registry
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::unique_ptr<Config>> instances;
+        };
+        static Registry &registry();
+
+        void set_locked(const std::string &key, nlohmann::json value);
+
+        // Every change to config_map goes through these so derived state (the typed cache) stays in sync
+        void store_locked(const std::string &key, nlohmann::json value);
+        bool erase_locked(const std::string &key);
+        void clear_locked();
+        void store_array_locked(const std::string &key, ColumnarArray array);
+        void store_lazy_locked(const std::string &key, LazyValue value);
+
+        // Memory budget bookkeeping; only active while budget_.enabled()
+        void touch_locked(const std::string &key) const;
+        void note_resident_locked(const std::string &key, const nlohmann::json &value);
+        void forget_resident_locked(const std::string &key);
+        void measure_resident_locked();
+        void enforce_memory_budget_locked();
+        // Values chosen for eviction wait in shared_ (still readable) while the caller, after releasing the
+        // lock, serializes and writes them; write_spills then swaps in the spilled LazyValue
+        struct PendingSpill
+        {
+            std::string key;
+            std::shared_ptr<const nlohmann::json> value;
+        };
+        void write_spills(std::vector<PendingSpill> &spills);
+
+        // Lookups that also see columnar arrays, converting them to json only when needed
+        const nlohmann::json *find_locked(const std::string &key, nlohmann::json &scratch) const;
+        const std::unordered_map<std::string, nlohmann::json> &materialized_locked(std::unordered_map<std::string, nlohmann::json> &scratch) const;
+
+        // Query resolution; results pointing into temporary copies of columnar arrays are left in `scratch` uncached
+        struct QueryScratch
+        {
+            nlohmann::json value;
+            std::vector<const nlohmann::json *> nodes;
+        };
+        const std::vector<const nlohmann::json *> &resolve_query_locked(const CompiledQuery &compiled, QueryScratch &scratch) const;
+
+        // Ordered key index maintenance; no-ops until the first range scan builds the index
+        void ensure_key_index_locked() const;
+        void index_key_locked(const std::string &stored_key, const nlohmann::json *value) const;
+        void unindex_key_locked(const std::string &key) const;
+
+        // Interpolation; `stack` holds the keys being resolved, for cycle detection
+        const nlohmann::json &interpolate_locked(const std::string &key, std::vector<std::string> &stack) const;
+        nlohmann::json expand_locked(const nlohmann::json &value, const std::string &owner, std::vector<std::string> &stack) const;
+        nlohmann::json resolve_reference_locked(const TemplatePart &part, const std::string &owner, std::vector<std::string> &stack) const;
+        void invalidate_interpolation_locked(const std::string &key);
+
+        // Derived keys; the queue is ordered by rank (longest input chain), which is a topological order
+        using DerivedQueue = std::set<std::pair<std::size_t, std::string>>;
+        void rebuild_derived_graph_locked();
+        void propagate_derived_locked(const std::vector<std::string> &changed);
+        void recompute_derived_locked(DerivedQueue queue);
+        ConfigMetrics *active_metrics() const { return metrics_.load(std::memory_order_relaxed); }
+        ConfigProfiler *active_profiler() const { return profiler_.load(std::memory_order_relaxed); }
+        WorkloadRecorder *active_recorder() const { return recorder_.load(std::memory_order_relaxed); }
+
+        // File load/save helpers; the phase timings and error location are recorded in the IoResult
+        static std::string file_extension(const std::string &file_path);
+        static bool is_supported_extension(const std::string &extension);
+        static void trace_io_result(TraceScope &trace, const IoResult &result);
+        static IoResult &io_failure(IoResult &result, IoError error, const std::string &message);
+        static IoError io_exception_error(const std::exception &e, IoError fallback); // PARSE/CONVERSION_FAILED when e says so
+        static void locate_offset(IoResult &result, std::string_view contents, std::size_t offset);
+        static bool read_file(const std::string &file_path, const std::string &extension, std::string &contents, IoResult &result, IoPhaseClock &clock);
+        // Writes a temporary file next to `file_path` and renames it into place, so readers never see a partial file
+        static bool write_file(const std::string &file_path, const std::string &contents, const std::string &context, IoResult &result,
+                               IoPhaseClock &clock);
+        static bool parse_document(const std::string &contents, const std::string &extension, const std::vector<std::string> *keys,
+                                   std::vector<std::pair<std::string, nlohmann::json>> &entries, IoResult &result, IoPhaseClock &clock);
+        static bool scan_document(const std::string &file_path, const std::vector<std::string> *keys,
+                                  std::vector<std::pair<std::string, LazyValue>> &entries, IoResult &result, IoPhaseClock &clock);
+        bool serialize_document(const std::string &extension, const std::vector<std::string> *keys, const std::string *version,
+                                std::string &output, IoResult &result) const;
+        void commit_document(const std::string &file_path, std::vector<std::pair<std::string, nlohmann::json>> &entries,
+                             std::vector<std::pair<std::string, LazyValue>> &lazy_entries, const std::string *version, IoResult &result,
+                             IoPhaseClock &clock);
+        IoResult load_document(const std::string &file_path, const std::vector<std::string> *keys, const std::string *version);
+        IoResult save_document(const std::string &file_path, const std::vector<std::string> *keys, const std::string *version) const;
+
         std::unordered_map<std::string, nlohmann::json> config_map;
         std::vector<std::function<void(const std::string &, const nlohmann::json &)>> change_listeners_;
+        std::vector<std::function<void()>> reload_listeners_;
         mutable std::mutex mutex_;
         std::string version_;
         std::unordered_map<std::string, std::string> env_overrides_;
+        std::unique_ptr<ConfigMetrics> metrics_storage_; // Kept after disable_metrics() so in-flight locks stay valid
+        std::atomic<ConfigMetrics *> metrics_{nullptr};
+        std::shared_ptr<ConfigProfiler> profiler_storage_;
+        std::vector<std::shared_ptr<ConfigProfiler>> retired_profilers_; // May still be used by in-flight calls
+        std::atomic<ConfigProfiler *> profiler_{nullptr};
+        std::shared_ptr<WorkloadRecorder> recorder_storage_;
+        std::vector<std::shared_ptr<WorkloadRecorder>> retired_recorders_; // May still be used by in-flight calls
+        std::atomic<WorkloadRecorder *> recorder_{nullptr};
+
+        // Converted values for get_as, keyed by (T, Parser)
+        template <typename T, typename Parser>
+        struct TypedCacheTag {};
+        struct TypedCacheEntry
+        {
+            std::type_index type;
+            std::shared_ptr<const void> value;
+        };
+        mutable std::unordered_map<std::string, std::vector<TypedCacheEntry>> typed_cache_;
+        std::uint64_t generation_ = 0; // Bumped on every change to config_map or the side maps
+
+        // Keys stored as columnar arrays live here instead of config_map
+        std::unordered_map<std::string, ColumnarArray> arrays_;
+        std::size_t array_promotion_threshold_ = 0;
+
+        // Resolved query locations: per top-level key for anchored queries, per generation for the rest
+        static constexpr std::size_t kMaxCachedQueries = 256;
+        struct QueryCacheEntry
+        {
+            std::uint64_t generation;
+            std::vector<const nlohmann::json *> nodes;
+            std::unordered_map<std::string, nlohmann::json> arrays; // Columnar arrays converted for `nodes`
+        };
+        mutable std::unordered_map<std::string, std::unordered_map<std::string, std::vector<const nlohmann::json *>>> query_cache_;
+        mutable std::unordered_map<std::string, QueryCacheEntry> global_query_cache_;
+
+        // Keys of config_map and arrays_ in sorted order, viewing the map nodes' own key strings.
+        // Built by the first range scan, then kept in sync by the store/erase/clear helpers
+        struct IndexedKey
+        {
+            const std::string *key;
+            const nlohmann::json *value; // nullptr for columnar arrays
+        };
+        mutable std::map<std::string_view, IndexedKey> key_index_;
+        mutable bool key_index_built_ = false;
+
+        // Memoized get_interpolated results, and for each key the keys whose results referenced it
+        mutable std::unordered_map<std::string, nlohmann::json> interpolated_;
+        mutable std::unordered_map<std::string, std::unordered_set<std::string>> interpolation_dependents_;
+        InterpolationOptions interpolation_options_;
+
+        // Derived key definitions, and for each input the derived keys that read it
+        struct DerivedKey
+        {
+            std::vector<std::string> inputs;
+            DeriveFunction fn;
+            std::size_t rank = 0;
+            std::string error; // What the last call of fn threw; empty after a successful one
+        };
+        std::unordered_map<std::string, DerivedKey> derived_;
+        std::unordered_map<std::string, std::vector<std::string>> derived_dependents_;
+
+        // Keys whose values are interned live here instead of config_map; the json is never modified in place
+        std::unordered_map<std::string, std::shared_ptr<const nlohmann::json>> shared_;
+        std::shared_ptr<ValueInterner> interner_;
+
+        // Lazily loaded keys: document slices, parsed into the entry on first read. Writes move the key to config_map
+        std::unordered_map<std::string, LazyValue> lazy_;
+        std::atomic<bool> lazy_loading_{false};
+
+        // Memory budget: each parsed value's heap bytes and last-access tick (for choosing cold keys), kept up
+        // to date as values are written, reloaded and evicted, their total, and the spill segments written so far
+        // (each freed when its last value goes)
+        struct ResidentValue
+        {
+            std::size_t bytes = 0;
+            std::uint64_t tick = 0;
+            const nlohmann::json *spilling = nullptr; // The value queued in spill_queue_ and parked in shared_
+        };
+        MemoryBudget budget_;
+        mutable std::size_t resident_estimate_ = 0;
+        bool spill_pending_ = false;
+        bool spill_blocked_ = false; // The last pass stayed over budget with nothing left to evict
+        mutable std::unordered_map<std::string, ResidentValue> resident_;
+        mutable std::uint64_t access_clock_ = 0;
+        std::vector<std::weak_ptr<const MappedDocument>> spill_segments_;
+        std::vector<PendingSpill> spill_queue_;
+        mutable SpillStats spill_counters_;
     };
 
 #ifdef FORMAT_MANAGER_INCLUDED
@@ -371,6 +1069,10 @@ namespace config
     typename std::enable_if<std::is_same<T, std::ostream&>::value, std::ostream&>::type
     Config::output_config(std::ostream &os) const
     {
+        TraceScope trace("output_config");
+        MeteredLock lock(mutex_, active_metrics());
+        std::unordered_map<std::string, nlohmann::json> scratch;
+        const auto &entries = materialized_locked(scratch);
         try
         {
             auto format = output_format::get_format_manager().get_format();
@@ -378,26 +1080,26 @@ namespace config
             switch (format)
             {
             case output_format::OutputFormat::PLAIN_TEXT:
-                for (const auto &[key, value] : config_map)
+                for (const auto &[key, value] : entries)
                 {
                     ss << key << ": " << value.dump() << "\n";
                 }
                 output_format::plain_text_format(os, ss.str());
                 break;
             case output_format::OutputFormat::JSON:
-                output_format::json_format(os, config_map);
+                output_format::json_format(os, entries);
                 break;
             case output_format::OutputFormat::XML:
-                output_format::xml_format(os, config_map);
+                output_format::xml_format(os, entries);
                 break;
             case output_format::OutputFormat::YAML:
-                output_format::yaml_format(os, config_map);
+                output_format::yaml_format(os, entries);
                 break;
             case output_format::OutputFormat::HTML:
-                output_format::html_format(os, config_map);
+                output_format::html_format(os, entries);
                 break;
             case output_format::OutputFormat::CSV:
-                output_format::csv_format(os, config_map);
+                output_format::csv_format(os, entries);
                 break;
             default:
                 throw std::invalid_argument("Unsupported format");
@@ -418,24 +1120,208 @@ namespace config
     }
 #endif
 
+    // The parser runs without the lock held; its result is only cached if nothing was written meanwhile
+    template <typename T, typename Parser>
+    T Config::get_as(const std::string &key, Parser parser) const
+    {
+        const std::type_index type(typeid(TypedCacheTag<T, Parser>));
+        nlohmann::json raw;
+        std::uint64_t generation = 0;
+        {
+            ConfigMetrics *metrics = active_metrics();
+            MeteredLock lock(mutex_, metrics);
+            const nlohmann::json *found = find_locked(key, raw);
+            if (metrics)
+            {
+                metrics->add_read(found != nullptr);
+            }
+            if (!found)
+            {
+                throw std::invalid_argument("Unknown configuration key: " + key);
+            }
+            auto cached = typed_cache_.find(key);
+            if (cached != typed_cache_.end())
+            {
+                for (const auto &entry : cached->second)
+                {
+                    if (entry.type == type)
+                    {
+                        return *static_cast<const T *>(entry.value.get());
+                    }
+                }
+            }
+            if (found != &raw)
+            {
+                raw = *found;
+            }
+            generation = generation_;
+        }
+
+        std::shared_ptr<const T> value;
+        try
+        {
+            value = std::make_shared<const T>(parser(raw));
+        }
+        catch (const std::exception &e)
+        {
+            throw std::invalid_argument("Cannot convert configuration key '" + key + "': " + e.what());
+        }
+
+        MeteredLock lock(mutex_, active_metrics());
+        if (generation_ == generation)
+        {
+            typed_cache_[key].push_back({type, value});
+        }
+        return *value;
+    }
+
+    template <typename T>
+    void Config::set_array(const std::string &key, AlignedBuffer<T> values)
+    {
+        static_assert(is_columnar_type<T>::value, "set_array supports double and std::int64_t");
+        MeteredLock lock(mutex_, active_metrics());
+        store_array_locked(key, ColumnarArray(std::move(values)));
+    }
+
+    template <typename T>
+    void Config::set_array(const std::string &key, const std::vector<T> &values)
+    {
+        set_array(key, AlignedBuffer<T>(values.begin(), values.end()));
+    }
+
+    template <typename... Args>
+    void Config::emplace(const std::string &key, Args &&...args)
+    {
+        set(key, nlohmann::json(std::forward<Args>(args)...));
+    }
+
+    // Shares the stored buffer for columnar keys; plain json arrays are converted into a new buffer
+    template <typename T>
+    ArrayView<T> Config::get_array(const std::string &key) const
+    {
+        static_assert(is_columnar_type<T>::value, "get_array supports double and std::int64_t");
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        auto array = arrays_.find(key);
+        nlohmann::json scratch;
+        const nlohmann::json *found = array == arrays_.end() ? find_locked(key, scratch) : nullptr;
+        if (metrics)
+        {
+            metrics->add_read(array != arrays_.end() || found);
+        }
+        if (array != arrays_.end())
+        {
+            return array->second.view<T>();
+        }
+        if (!found)
+        {
+            throw std::invalid_argument("Unknown configuration key: " + key);
+        }
+        auto converted = ColumnarArray::from_json(*found);
+        if constexpr (std::is_same_v<T, double>)
+        {
+            if (!converted)
+            {
+                converted = ColumnarArray::doubles_from_json(*found);
+            }
+        }
+        if (!converted)
+        {
+            throw std::invalid_argument("Configuration key '" + key + "' is not a numeric array of that type");
+        }
+        return converted->view<T>();
+    }
+
+    Config::Registry &Config::registry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
     Config& Config::instance(const std::string &name)
     {
-        static std::unordered_map<std::string, std::unique_ptr<Config>> instances;
-        static std::mutex mutex_;
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (instances.find(name) == instances.end())
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto &slot = reg.instances[name];
+        if (!slot)
+        {
+            slot = std::make_unique<Config>();
+        }
+        return *slot;
+    }
+
+    std::vector<std::string> Config::instance_names()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        std::vector<std::string> names;
+        names.reserve(reg.instances.size());
+        for (const auto &[name, instance] : reg.instances)
+        {
+            names.push_back(name);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    RegistryMemoryUsage Config::registry_memory_usage()
+    {
+        RegistryMemoryUsage report;
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &[name, instance] : reg.instances)
         {
-            instances[name] = std::make_unique<Config>();
+            MemoryUsage usage = instance->memory_usage();
+            report.total_bytes += usage.total_bytes;
+            report.instances.emplace_back(name, std::move(usage));
         }
-        return *instances[name];
+        std::sort(report.instances.begin(), report.instances.end(), [](const auto &a, const auto &b) {
+            return a.second.total_bytes > b.second.total_bytes;
+        });
+        return report;
     }
 
     // Move constructor definition
     Config::Config(Config&& other) noexcept
         : config_map(std::move(other.config_map)),
           change_listeners_(std::move(other.change_listeners_)),
+          reload_listeners_(std::move(other.reload_listeners_)),
           version_(std::move(other.version_)),
-          env_overrides_(std::move(other.env_overrides_))
+          env_overrides_(std::move(other.env_overrides_)),
+          metrics_storage_(std::move(other.metrics_storage_)),
+          metrics_(other.metrics_.exchange(nullptr)),
+          profiler_storage_(std::move(other.profiler_storage_)),
+          retired_profilers_(std::move(other.retired_profilers_)),
+          profiler_(other.profiler_.exchange(nullptr)),
+          recorder_storage_(std::move(other.recorder_storage_)),
+          retired_recorders_(std::move(other.retired_recorders_)),
+          recorder_(other.recorder_.exchange(nullptr)),
+          typed_cache_(std::move(other.typed_cache_)),
+          generation_(other.generation_),
+          arrays_(std::move(other.arrays_)),
+          array_promotion_threshold_(other.array_promotion_threshold_),
+          query_cache_(std::move(other.query_cache_)),
+          global_query_cache_(std::move(other.global_query_cache_)),
+          key_index_(std::move(other.key_index_)),
+          key_index_built_(other.key_index_built_),
+          interpolated_(std::move(other.interpolated_)),
+          interpolation_dependents_(std::move(other.interpolation_dependents_)),
+          interpolation_options_(other.interpolation_options_),
+          derived_(std::move(other.derived_)),
+          derived_dependents_(std::move(other.derived_dependents_)),
+          shared_(std::move(other.shared_)),
+          interner_(std::move(other.interner_)),
+          lazy_(std::move(other.lazy_)),
+          lazy_loading_(other.lazy_loading_.load()),
+          budget_(std::move(other.budget_)),
+          resident_estimate_(other.resident_estimate_),
+          spill_pending_(other.spill_pending_),
+          spill_blocked_(other.spill_blocked_),
+          resident_(std::move(other.resident_)),
+          access_clock_(other.access_clock_),
+          spill_segments_(std::move(other.spill_segments_)),
+          spill_queue_(std::move(other.spill_queue_)),
+          spill_counters_(other.spill_counters_)
     {
         // Note: `std::mutex` cannot be moved, so we leave it default constructed.
     }
@@ -451,8 +1337,46 @@ namespace config
 
             config_map = std::move(other.config_map);
             change_listeners_ = std::move(other.change_listeners_);
+            reload_listeners_ = std::move(other.reload_listeners_);
             version_ = std::move(other.version_);
             env_overrides_ = std::move(other.env_overrides_);
+            metrics_storage_ = std::move(other.metrics_storage_);
+            metrics_.store(other.metrics_.exchange(nullptr));
+            profiler_storage_ = std::move(other.profiler_storage_);
+            retired_profilers_ = std::move(other.retired_profilers_);
+            profiler_.store(other.profiler_.exchange(nullptr));
+            recorder_storage_ = std::move(other.recorder_storage_);
+            retired_recorders_ = std::move(other.retired_recorders_);
+            recorder_.store(other.recorder_.exchange(nullptr));
+            typed_cache_ = std::move(other.typed_cache_);
+            ++generation_;
+            arrays_ = std::move(other.arrays_);
+            array_promotion_threshold_ = other.array_promotion_threshold_;
+            query_cache_ = std::move(other.query_cache_);
+            global_query_cache_.clear();
+            other.global_query_cache_.clear();
+            key_index_ = std::move(other.key_index_);
+            key_index_built_ = other.key_index_built_;
+            other.key_index_.clear();
+            other.key_index_built_ = false;
+            interpolated_ = std::move(other.interpolated_);
+            interpolation_dependents_ = std::move(other.interpolation_dependents_);
+            interpolation_options_ = other.interpolation_options_;
+            derived_ = std::move(other.derived_);
+            derived_dependents_ = std::move(other.derived_dependents_);
+            shared_ = std::move(other.shared_);
+            interner_ = std::move(other.interner_);
+            lazy_ = std::move(other.lazy_);
+            lazy_loading_.store(other.lazy_loading_.load());
+            budget_ = std::move(other.budget_);
+            resident_estimate_ = other.resident_estimate_;
+            spill_pending_ = other.spill_pending_;
+            spill_blocked_ = other.spill_blocked_;
+            resident_ = std::move(other.resident_);
+            access_clock_ = other.access_clock_;
+            spill_segments_ = std::move(other.spill_segments_);
+            spill_queue_ = std::move(other.spill_queue_);
+            spill_counters_ = other.spill_counters_;
         }
         return *this;
     }
@@ -472,7 +1396,12 @@ namespace config
             auto config = create_config(name);
             try
             {
-                config->load_from_file(filePath);
+                IoResult result = config->load_from_file(filePath);
+                if (!result)
+                {
+                    std::cerr << "Failed to load configuration from file: " << filePath << ". Error: " << result.message << std::endl;
+                    return nullptr; // Return a null pointer to indicate failure
+                }
             }
             catch (const std::exception &e)
             {
@@ -493,17 +1422,29 @@ namespace config
             return config;
         }
 
-        // Create a config instance for a specific environment
-        static std::shared_ptr<Config> create_env_config(const std::string &name, const std::string &environment)
+        // Same, moving the defaults into the instance
+        static std::shared_ptr<Config> create_config_with_defaults(const std::string &name, std::unordered_map<std::string, nlohmann::json> &&defaults)
         {
             auto config = create_config(name);
-            if (environment == "development")
+            for (auto &[key, value] : defaults)
             {
-                config->set("db_host", "localhost");
-                config->set("db_port", 5432);
-                config->set("api_endpoint", "https://dev.api.example.com");
+                config->set(key, std::move(value));
+            }
+            return config;
+        }
+
+        // Create a config instance for a specific environment
+        static std::shared_ptr<Config> create_env_config(const std::string &name, const std::string &environment)
+        {
+            auto config = create_config(name);
+            if (environment == "development")
+            {
+                config->set("db_host", "localhost");
+                config->set("db_port", 5432);
+                config->set("api_endpoint", "https://dev.api.example.com");
                 config->set("log_level", "debug");
                 config->set("feature_x_enabled", true);
+                config->set("feature_flags", {{"feature_x", true}});
             }
             else if (environment == "production")
             {
@@ -512,6 +1453,7 @@ namespace config
                 config->set("api_endpoint", "https://api.example.com");
                 config->set("log_level", "error");
                 config->set("feature_x_enabled", false);
+                config->set("feature_flags", {{"feature_x", false}});
             }
             else if (environment == "testing")
             {
@@ -520,6 +1462,7 @@ namespace config
                 config->set("api_endpoint", "https://test.api.example.com");
                 config->set("log_level", "info");
                 config->set("feature_x_enabled", true);
+                config->set("feature_flags", {{"feature_x", true}});
             }
             else
             {
@@ -593,413 +1536,2335 @@ namespace config
     // Enhanced Functions
     nlohmann::json Config::get(const std::string &key) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = config_map.find(key);
-        if (it != config_map.end())
-        {
-            return it->second;
-        }
-        throw std::invalid_argument("Unknown configuration key: " + key);
-    }
-
-    void Config::set(const std::string &key, const nlohmann::json &value)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (!key.empty())
+        ConfigProfiler::Sample sample(active_profiler(), ProfiledOp::GET, key);
+        ConfigMetrics *metrics = active_metrics();
+        nlohmann::json result;
+        bool hit = false;
         {
-            if (key == "example" && !value.is_string())
-            {
-                throw std::invalid_argument("Value for 'example' must be a string");
-            }
-            config_map[key] = value;
-            for (const auto &listener : change_listeners_)
+            MeteredLock lock(mutex_, metrics);
+            const nlohmann::json *found = find_locked(key, result);
+            if (metrics)
             {
-                listener(key, value);
+                metrics->add_read(found != nullptr);
             }
-        }
-        else
-        {
-            throw std::invalid_argument("Key cannot be empty");
-        }
-    }
-
-    std::unordered_map<std::string, nlohmann::json> Config::get_all() const
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return config_map;
-    }
-
-    void Config::validate(const std::unordered_map<std::string, std::function<bool(const nlohmann::json &)>> &validators) const
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
-        {
-            for (const auto &[key, validate_func] : validators)
+            if (found)
             {
-                auto it = config_map.find(key);
-                if (it != config_map.end())
+                hit = true;
+                if (found != &result)
                 {
-                    if (!validate_func(it->second))
-                    {
-                        throw std::invalid_argument("Validation failed for key: " + key + " with value: " + it->second.dump());
-                    }
-                }
-                else
-                {
-                    throw std::invalid_argument("Validation failed: key not found: " + key);
+                    result = *found;
                 }
             }
         }
-        catch (const std::exception &e)
+        // Recorded after the lock is released; the copy is sized rather than the stored value
+        if (WorkloadRecorder *recorder = active_recorder())
         {
-            std::cerr << "Error in validate: " << e.what() << std::endl;
+            recorder->record(WorkloadOpType::GET, key, hit ? workload::value_size(result) : 0, !hit);
         }
+        if (!hit)
+        {
+            throw std::invalid_argument("Unknown configuration key: " + key);
+        }
+        return result;
     }
 
-    void Config::load_from_file(const std::string &file_path)
+    void Config::set(const std::string &key, const nlohmann::json &value)
     {
-        try
+        ConfigProfiler::Sample sample(active_profiler(), ProfiledOp::SET, key);
+        if (WorkloadRecorder *recorder = active_recorder())
         {
-            load_from_file(file_path, "1.0.0");
+            recorder->record(WorkloadOpType::SET, key, workload::value_size(value));
         }
-        catch (const std::exception &e)
+        std::vector<PendingSpill> spills;
         {
-            std::cerr << "Error in load_from_file: " << e.what() << std::endl;
+            MeteredLock lock(mutex_, active_metrics());
+            set_locked(key, value);
+            spills.swap(spill_queue_);
         }
+        write_spills(spills);
     }
 
-    void Config::save_to_file(const std::string &file_path) const
+    void Config::set(const std::string &key, nlohmann::json &&value)
     {
-        try
+        ConfigProfiler::Sample sample(active_profiler(), ProfiledOp::SET, key);
+        if (WorkloadRecorder *recorder = active_recorder())
         {
-            save_to_file(file_path, "1.0.0");
+            recorder->record(WorkloadOpType::SET, key, workload::value_size(value));
         }
-        catch (const std::exception &e)
+        std::vector<PendingSpill> spills;
         {
-            std::cerr << "Error in save_to_file: " << e.what() << std::endl;
+            MeteredLock lock(mutex_, active_metrics());
+            set_locked(key, std::move(value));
+            spills.swap(spill_queue_);
         }
+        write_spills(spills);
     }
 
-    void Config::remove(const std::string &key)
+    // Caller must hold mutex_; listeners see the stored value, since `value` has been moved into storage
+    void Config::set_locked(const std::string &key, nlohmann::json value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        if (!key.empty())
         {
-            if (config_map.erase(key) == 0)
+            if (key == "example" && !value.is_string())
             {
-                throw std::invalid_argument("Unknown configuration key: " + key);
+                throw std::invalid_argument("Value for 'example' must be a string");
+            }
+            if (!derived_.empty() && derived_.count(key) != 0)
+            {
+                throw std::invalid_argument("Cannot set derived key: " + key);
+            }
+            // Dependents are only recomputed when the input's value actually changes
+            bool input_changed = false;
+            if (!derived_dependents_.empty() && derived_dependents_.count(key) != 0)
+            {
+                nlohmann::json scratch;
+                const nlohmann::json *current = find_locked(key, scratch);
+                input_changed = current == nullptr || *current != value;
+            }
+            store_locked(key, std::move(value));
+            if (!change_listeners_.empty())
+            {
+                nlohmann::json scratch;
+                const nlohmann::json &stored = *find_locked(key, scratch);
+                for (const auto &listener : change_listeners_)
+                {
+                    TraceScope trace("listener", "config.listener");
+                    trace.arg("key", key);
+                    listener(key, stored);
+                }
+            }
+            if (ConfigMetrics *metrics = active_metrics())
+            {
+                metrics->add_writes();
+                metrics->add_listener_invocations(change_listeners_.size());
+            }
+            if (input_changed)
+            {
+                propagate_derived_locked({key});
+            }
+            if (spill_pending_)
+            {
+                enforce_memory_budget_locked();
             }
         }
-        catch (const std::exception &e)
+        else
         {
-            std::cerr << "Error in remove: " << e.what() << std::endl;
+            throw std::invalid_argument("Key cannot be empty");
         }
     }
 
-    bool Config::exists(const std::string &key) const
+    // Caller must hold mutex_
+    void Config::store_locked(const std::string &key, nlohmann::json value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        ++generation_;
+        if (budget_.enabled())
         {
-            return config_map.find(key) != config_map.end();
+            forget_resident_locked(key);
         }
-        catch (const std::exception &e)
+        if (!typed_cache_.empty())
         {
-            std::cerr << "Error in exists: " << e.what() << std::endl;
-            return false;
+            typed_cache_.erase(key);
         }
-    }
-
-    void Config::clear()
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        if (!query_cache_.empty())
         {
-            config_map.clear();
+            query_cache_.erase(key);
         }
-        catch (const std::exception &e)
+        if (!interpolated_.empty())
         {
-            std::cerr << "Error in clear: " << e.what() << std::endl;
+            invalidate_interpolation_locked(key);
         }
-    }
-
-    void Config::display() const
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        if (!lazy_.empty())
         {
-            for (const auto &[key, value] : config_map)
+            auto existing = lazy_.find(key);
+            if (existing != lazy_.end())
             {
-                std::cout << key << ": " << value.dump(4) << std::endl;
+                unindex_key_locked(key);
+                lazy_.erase(existing);
             }
         }
-        catch (const std::exception &e)
+        if (array_promotion_threshold_ != 0 && value.is_array() && value.size() >= array_promotion_threshold_)
         {
-            std::cerr << "Error in display: " << e.what() << std::endl;
+            if (auto array = ColumnarArray::from_json(value))
+            {
+                auto existing = config_map.find(key);
+                if (existing != config_map.end())
+                {
+                    unindex_key_locked(key);
+                    config_map.erase(existing);
+                }
+                auto shared = shared_.find(key);
+                if (shared != shared_.end())
+                {
+                    unindex_key_locked(key);
+                    shared_.erase(shared);
+                }
+                auto it = arrays_.insert_or_assign(key, std::move(*array)).first;
+                index_key_locked(it->first, nullptr);
+                return;
+            }
         }
-    }
-
-    std::vector<nlohmann::json> Config::inspect(const std::vector<std::string> &keys) const
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-
-        std::vector<nlohmann::json> values;
-        values.reserve(keys.size());
-
-        for (const auto &key : keys)
+        if (!arrays_.empty())
         {
-            lock.unlock();
-            try
+            auto existing = arrays_.find(key);
+            if (existing != arrays_.end())
             {
-                values.push_back(get(key));
+                unindex_key_locked(key);
+                arrays_.erase(existing);
             }
-            catch (const std::invalid_argument &e)
+        }
+        if (interner_)
+        {
+            if (std::shared_ptr<const nlohmann::json> interned = interner_->intern(value))
             {
-                values.push_back(nlohmann::json::object());
+                // The index holds views into the erased node's key, so unindex first; the indexed value
+                // pointer changes with every write, so the entry is always replaced
+                unindex_key_locked(key);
+                auto existing = config_map.find(key);
+                if (existing != config_map.end())
+                {
+                    config_map.erase(existing);
+                }
+                auto it = shared_.insert_or_assign(key, std::move(interned)).first;
+                index_key_locked(it->first, it->second.get());
+                return;
             }
-            lock.lock();
         }
-
-        return values;
-    }
-
-    void Config::update_multiple(const std::unordered_map<std::string, nlohmann::json> &new_cfg)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        if (!shared_.empty())
         {
-            for (const auto &[key, value] : new_cfg)
+            auto existing = shared_.find(key);
+            if (existing != shared_.end())
             {
-                set(key, value);
+                unindex_key_locked(key);
+                shared_.erase(existing);
             }
         }
-        catch (const std::exception &e)
+        auto [it, inserted] = config_map.try_emplace(key);
+        it->second = std::move(value);
+        if (inserted)
+        {
+            index_key_locked(it->first, &it->second);
+        }
+        if (budget_.enabled())
         {
-            std::cerr << "Error in update_multiple: " << e.what() << std::endl;
+            touch_locked(key);
+            note_resident_locked(key, it->second);
         }
     }
 
-    void Config::load_partial_from_file(const std::string &file_path, const std::vector<std::string> &keys)
+    // Caller must hold mutex_
+    void Config::store_array_locked(const std::string &key, ColumnarArray array)
     {
-        std::ifstream config_file(file_path);
-        if (!config_file.is_open())
+        if (key.empty())
         {
-            std::cerr << "Failed to open config file for reading: " + file_path << std::endl;
-            return;
+            throw std::invalid_argument("Key cannot be empty");
         }
-        try
+        if (!derived_.empty() && derived_.count(key) != 0)
         {
-            std::string extension = file_path.substr(file_path.find_last_of(".") + 1);
-            if (extension == "json")
-            {
-                nlohmann::json j;
-                config_file >> j;
-                for (const auto &key : keys)
-                {
-                    if (j.contains(key))
-                    {
-                        config_map[key] = j[key];
-                    }
-                }
-            }
-            else if (extension == "yaml" || extension == "yml")
-            {
-                YAML::Node yaml_config = YAML::Load(config_file);
-                for (const auto &key : keys)
-                {
-                    if (yaml_config[key])
-                    {
-                    #ifdef FORMAT_MANAGER_INCLUDED
-                    config_map[key] = output_format::yaml_to_json(yaml_config[key]);
-                    #endif
-                    }
-                }
-            }
-            else
-            {
-                throw std::runtime_error("Unsupported config file format: " + extension);
-            }
+            throw std::invalid_argument("Cannot set derived key: " + key);
         }
-        catch (const std::exception &e)
+        bool input_changed = false;
+        if (!derived_dependents_.empty() && derived_dependents_.count(key) != 0)
         {
-            std::cerr << "Error while loading config file: " << e.what() << std::endl;
+            nlohmann::json scratch;
+            const nlohmann::json *current = find_locked(key, scratch);
+            input_changed = current == nullptr || *current != array.to_json();
         }
-    }
-
-    void Config::save_partial_to_file(const std::string &file_path, const std::vector<std::string> &keys) const
-    {
-        std::ofstream config_file(file_path);
-        if (!config_file.is_open())
+        ++generation_;
+        if (budget_.enabled())
         {
-            std::cerr << "Failed to open config file for writing: " + file_path << std::endl;
-            return;
+            forget_resident_locked(key);
         }
-        try
+        typed_cache_.erase(key);
+        query_cache_.erase(key);
+        if (!interpolated_.empty())
         {
-            std::string extension = file_path.substr(file_path.find_last_of(".") + 1);
-            if (extension == "json")
-            {
-                nlohmann::json j;
-                for (const auto &key : keys)
-                {
-                    auto it = config_map.find(key);
-                    if (it != config_map.end())
-                    {
-                        j[key] = it->second;
-                    }
-                }
-                config_file << j.dump(4);
-            }
-            else if (extension == "yaml" || extension == "yml")
-            {
-                YAML::Emitter out;
-                out << YAML::BeginMap;
-                for (const auto &key : keys)
-                {
-                    auto it = config_map.find(key);
-                    if (it != config_map.end())
-                    {
-                        #ifdef FORMAT_MANAGER_INCLUDED
-                        out << YAML::Key << key << YAML::Value << output_format::json_to_yaml(it->second);
-                        #endif
-                    }
-                }
-                out << YAML::EndMap;
-                config_file << out.c_str();
-            }
-            else
-            {
-                throw std::runtime_error("Unsupported config file format: " + extension);
-            }
+            invalidate_interpolation_locked(key);
         }
-        catch (const std::exception &e)
+        auto existing = config_map.find(key);
+        if (existing != config_map.end())
         {
-            std::cerr << "Error while saving config file: " << e.what() << std::endl;
+            unindex_key_locked(key);
+            config_map.erase(existing);
         }
-    }
-
-    void Config::load_from_file(const std::string &file_path, const std::string &version)
-    {
-        std::ifstream config_file(file_path);
-        if (!config_file.is_open())
+        if (shared_.count(key) != 0 || lazy_.count(key) != 0)
         {
-            std::cerr << "Failed to open config file for reading: " << file_path << std::endl;
-            return;
+            unindex_key_locked(key);
+            shared_.erase(key);
+            lazy_.erase(key);
         }
-        try
+        auto it = arrays_.insert_or_assign(key, std::move(array)).first;
+        index_key_locked(it->first, nullptr);
+        if (!change_listeners_.empty())
         {
-            std::string extension = file_path.substr(file_path.find_last_of(".") + 1);
-            if (extension == "json")
-            {
-                nlohmann::json j;
-                config_file >> j;
-                for (auto it = j.begin(); it != j.end(); ++it)
-                {
-                    config_map[it.key()] = it.value();
-                }
-            }
-            else if (extension == "yaml" || extension == "yml")
-            {
-                YAML::Node yaml_config = YAML::Load(config_file);
-                for (auto it = yaml_config.begin(); it != yaml_config.end(); ++it)
-                {
-                    #ifdef FORMAT_MANAGER_INCLUDED
-                    config_map[it->first.as<std::string>()] = output_format::yaml_to_json(it->second);
-                    #endif
-                }
-            }
-            else
+            nlohmann::json value = it->second.to_json();
+            for (const auto &listener : change_listeners_)
             {
-                throw std::runtime_error("Unsupported config file format: " + extension);
+                TraceScope trace("listener", "config.listener");
+                trace.arg("key", key);
+                listener(key, value);
             }
-            version_ = version;
         }
-        catch (const std::exception &e)
+        if (ConfigMetrics *metrics = active_metrics())
+        {
+            metrics->add_writes();
+            metrics->add_listener_invocations(change_listeners_.size());
+        }
+        if (input_changed)
         {
-            std::cerr << "Error while loading config file: " << e.what() << std::endl;
+            propagate_derived_locked({key});
         }
     }
 
-    void Config::save_to_file(const std::string &file_path, const std::string &version) const
+    // Caller must hold mutex_
+    void Config::store_lazy_locked(const std::string &key, LazyValue value)
     {
-        std::ofstream config_file(file_path);
-        if (!config_file.is_open())
+        if (key.empty())
         {
-            std::cerr << "Failed to open config file for writing: " << file_path << std::endl;
-            return;
+            throw std::invalid_argument("Key cannot be empty");
         }
-        try
+        ++generation_;
+        if (budget_.enabled())
         {
-            std::string extension = file_path.substr(file_path.find_last_of(".") + 1);
-            if (extension == "json")
-            {
-                nlohmann::json j(config_map);
-                j["version"] = version;
-                config_file << j.dump(4);
-            }
-            else if (extension == "yaml" || extension == "yml")
-            {
-                YAML::Emitter out;
-                out << YAML::BeginMap;
-                out << YAML::Key << "version" << YAML::Value << version;
-                for (const auto &[key, value] : config_map)
-                {
-                    #ifdef FORMAT_MANAGER_INCLUDED
-                    out << YAML::Key << key << YAML::Value << output_format::json_to_yaml(value);
-                    #endif
-                }
-                out << YAML::EndMap;
-                config_file << out.c_str();
-            }
-            else
-            {
-                throw std::runtime_error("Unsupported config file format: " + extension);
-            }
+            forget_resident_locked(key);
         }
-        catch (const std::exception &e)
+        typed_cache_.erase(key);
+        query_cache_.erase(key);
+        if (!interpolated_.empty())
         {
-            std::cerr << "Error while saving config file: " << e.what() << std::endl;
+            invalidate_interpolation_locked(key);
         }
+        unindex_key_locked(key);
+        config_map.erase(key);
+        arrays_.erase(key);
+        shared_.erase(key);
+        auto it = lazy_.insert_or_assign(key, std::move(value)).first;
+        index_key_locked(it->first, nullptr);
     }
 
-    void Config::load_from_env()
+    // Caller must hold mutex_; columnar arrays are converted into `scratch`, lazily loaded values are parsed
+    const nlohmann::json *Config::find_locked(const std::string &key, nlohmann::json &scratch) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        try
+        auto it = config_map.find(key);
+        if (it != config_map.end())
         {
-            // Load all existing keys in config_map from environment
-            for (const auto &[key, value] : config_map)
+            if (budget_.enabled())
             {
-                const char *env_val = std::getenv(key.c_str());
-                if (env_val)
-                {
-                    config_map[key] = nlohmann::json(env_val);
-                    env_overrides_[key] = env_val;
-                }
+                touch_locked(key);
             }
-
-            // Load all environment variables into config_map
-            for (char **env = environ; *env != 0; env++)
+            return &it->second;
+        }
+        auto shared = shared_.find(key);
+        if (shared != shared_.end())
+        {
+            return shared->second.get();
+        }
+        auto lazy = lazy_.find(key);
+        if (lazy != lazy_.end())
+        {
+            if (budget_.enabled())
             {
-                std::string env_entry = *env;
-                size_t pos = env_entry.find('=');
-                if (pos != std::string::npos)
+                touch_locked(key);
+                if (!lazy->second.value)
                 {
-                    std::string key = env_entry.substr(0, pos);
-                    std::string value = env_entry.substr(pos + 1);
-                    config_map[key] = nlohmann::json(value);
+                    // Unparsed values count zero bytes, so the reload adds its full size
+                    std::size_t bytes = memory::value_heap_bytes(lazy->second.get(key));
+                    resident_[key].bytes = bytes;
+                    resident_estimate_ += bytes;
+                    spill_counters_.reloads += lazy->second.spilled ? 1 : 0;
                 }
             }
+            return &lazy->second.get(key);
         }
-        catch (const std::exception &e)
+        auto array = arrays_.find(key);
+        if (array != arrays_.end())
         {
-            std::cerr << "Error while loading from environment: " << e.what() << std::endl;
+            scratch = array->second.to_json();
+            return &scratch;
         }
+        return nullptr;
     }
 
-    void Config::add_change_listener(const std::function<void(const std::string &, const nlohmann::json &)> &listener)
+    // Caller must hold mutex_; returns config_map itself unless columnar arrays or shared values have to be merged in
+    const std::unordered_map<std::string, nlohmann::json> &Config::materialized_locked(std::unordered_map<std::string, nlohmann::json> &scratch) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        if (arrays_.empty() && shared_.empty() && lazy_.empty())
+        {
+            return config_map;
+        }
+        scratch = config_map;
+        for (const auto &[key, array] : arrays_)
+        {
+            scratch[key] = array.to_json();
+        }
+        for (const auto &[key, value] : shared_)
+        {
+            scratch[key] = *value;
+        }
+        for (const auto &[key, value] : lazy_)
+        {
+            scratch[key] = value.get(key);
+        }
+        return scratch;
+    }
+
+    void Config::set_array_promotion_threshold(std::size_t min_elements)
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        array_promotion_threshold_ = min_elements;
+    }
+
+    bool Config::is_columnar(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        return arrays_.find(key) != arrays_.end();
+    }
+
+    // Caller must hold mutex_
+    bool Config::erase_locked(const std::string &key)
+    {
+        ++generation_;
+        typed_cache_.erase(key);
+        query_cache_.erase(key);
+        if (!interpolated_.empty())
+        {
+            invalidate_interpolation_locked(key);
+        }
+        unindex_key_locked(key);
+        bool erased = arrays_.erase(key) != 0;
+        erased = shared_.erase(key) != 0 || erased;
+        erased = lazy_.erase(key) != 0 || erased;
+        if (budget_.enabled())
+        {
+            forget_resident_locked(key);
+        }
+        return config_map.erase(key) != 0 || erased;
+    }
+
+    // Caller must hold mutex_
+    void Config::clear_locked()
+    {
+        ++generation_;
+        typed_cache_.clear();
+        query_cache_.clear();
+        global_query_cache_.clear();
+        key_index_.clear();
+        interpolated_.clear();
+        interpolation_dependents_.clear();
+        arrays_.clear();
+        shared_.clear();
+        lazy_.clear();
+        resident_.clear();
+        resident_estimate_ = 0;
+        config_map.clear();
+    }
+
+    // Caller must hold mutex_
+    const std::vector<const nlohmann::json *> &Config::resolve_query_locked(const CompiledQuery &compiled, QueryScratch &scratch) const
+    {
+        auto collect = [](std::vector<const nlohmann::json *> &nodes) {
+            return [&nodes](const nlohmann::json &node) { nodes.push_back(&node); };
+        };
+        if (compiled.anchored())
+        {
+            const nlohmann::json *root = nullptr;
+            auto it = config_map.find(compiled.root_key());
+            if (it != config_map.end())
+            {
+                root = &it->second;
+            }
+            else if (auto shared = shared_.find(compiled.root_key()); shared != shared_.end())
+            {
+                root = shared->second.get();
+            }
+            else if (auto lazy = lazy_.find(compiled.root_key()); lazy != lazy_.end())
+            {
+                root = &lazy->second.get(lazy->first);
+            }
+            if (!root)
+            {
+                auto array = arrays_.find(compiled.root_key());
+                if (array != arrays_.end())
+                {
+                    scratch.value = array->second.to_json();
+                    compiled.resolve(scratch.value, 1, collect(scratch.nodes));
+                }
+                return scratch.nodes;
+            }
+            auto &per_key = query_cache_[compiled.root_key()];
+            auto cached = per_key.find(compiled.text());
+            if (cached != per_key.end())
+            {
+                return cached->second;
+            }
+            if (per_key.size() >= kMaxCachedQueries)
+            {
+                per_key.clear();
+            }
+            auto &nodes = per_key[compiled.text()];
+            compiled.resolve(*root, 1, collect(nodes));
+            return nodes;
+        }
+
+        auto cached = global_query_cache_.find(compiled.text());
+        if (cached != global_query_cache_.end())
+        {
+            if (cached->second.generation == generation_)
+            {
+                return cached->second.nodes;
+            }
+            cached->second.nodes.clear();
+        }
+        else
+        {
+            if (global_query_cache_.size() >= kMaxCachedQueries)
+            {
+                global_query_cache_.clear();
+            }
+            cached = global_query_cache_.emplace(compiled.text(), QueryCacheEntry{}).first;
+        }
+        cached->second.generation = generation_;
+        cached->second.arrays.clear();
+        auto out = collect(cached->second.nodes);
+        compiled.resolve_root(config_map, out);
+        // Shared and lazy values are resolved in place; only columnar arrays are converted, and the entry owns them
+        for (const auto &[key, value] : shared_)
+        {
+            compiled.resolve_entry(key, *value, out);
+        }
+        for (const auto &[key, value] : lazy_)
+        {
+            compiled.resolve_entry(key, value.get(key), out);
+        }
+        for (const auto &[key, array] : arrays_)
+        {
+            compiled.resolve_entry(key, cached->second.arrays.emplace(key, array.to_json()).first->second, out);
+        }
+        return cached->second.nodes;
+    }
+
+    std::vector<nlohmann::json> Config::query(const CompiledQuery &compiled) const
+    {
+        std::vector<nlohmann::json> results;
+        query_each(compiled, [&results](const nlohmann::json &node) { results.push_back(node); });
+        return results;
+    }
+
+    std::vector<nlohmann::json> Config::query(const std::string &path) const
+    {
+        return query(CompiledQuery(path));
+    }
+
+    void Config::query_each(const CompiledQuery &compiled, const std::function<void(const nlohmann::json &)> &visit) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        QueryScratch scratch;
+        const auto &nodes = resolve_query_locked(compiled, scratch);
+        if (metrics)
+        {
+            metrics->add_read(!nodes.empty());
+        }
+        for (const nlohmann::json *node : nodes)
+        {
+            visit(*node);
+        }
+    }
+
+    // Caller must hold mutex_
+    void Config::ensure_key_index_locked() const
+    {
+        if (key_index_built_)
+        {
+            return;
+        }
+        for (const auto &[key, value] : config_map)
+        {
+            key_index_.emplace(key, IndexedKey{&key, &value});
+        }
+        for (const auto &[key, array] : arrays_)
+        {
+            key_index_.emplace(key, IndexedKey{&key, nullptr});
+        }
+        for (const auto &[key, value] : shared_)
+        {
+            key_index_.emplace(key, IndexedKey{&key, value.get()});
+        }
+        for (const auto &[key, value] : lazy_)
+        {
+            key_index_.emplace(key, IndexedKey{&key, nullptr});
+        }
+        key_index_built_ = true;
+    }
+
+    // Caller must hold mutex_; `stored_key` must be the key string owned by the map node
+    void Config::index_key_locked(const std::string &stored_key, const nlohmann::json *value) const
+    {
+        if (key_index_built_)
+        {
+            key_index_.insert_or_assign(stored_key, IndexedKey{&stored_key, value});
+        }
+    }
+
+    // Caller must hold mutex_; call before the map node is erased, while the indexed view is still valid
+    void Config::unindex_key_locked(const std::string &key) const
+    {
+        if (key_index_built_)
+        {
+            key_index_.erase(key);
+        }
+    }
+
+    std::vector<std::string> Config::keys_with_prefix(std::string_view prefix) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        if (metrics)
+        {
+            metrics->add_read(true);
+        }
+        ensure_key_index_locked();
+        std::vector<std::string> keys;
+        for (auto it = key_index_.lower_bound(prefix); it != key_index_.end() && it->first.substr(0, prefix.size()) == prefix; ++it)
+        {
+            keys.push_back(*it->second.key);
+        }
+        return keys;
+    }
+
+    void Config::for_each_in_range(std::string_view lo, std::string_view hi, const std::function<void(const std::string &, const nlohmann::json &)> &fn) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        if (metrics)
+        {
+            metrics->add_read(true);
+        }
+        if (!hi.empty() && hi <= lo)
+        {
+            return;
+        }
+        ensure_key_index_locked();
+        auto end = hi.empty() ? key_index_.end() : key_index_.lower_bound(hi);
+        for (auto it = key_index_.lower_bound(lo); it != end; ++it)
+        {
+            if (it->second.value)
+            {
+                fn(*it->second.key, *it->second.value);
+            }
+            else
+            {
+                nlohmann::json scratch;
+                fn(*it->second.key, *find_locked(*it->second.key, scratch));
+            }
+        }
+    }
+
+    std::vector<std::string> Config::find_keys(const KeyMatcher &matcher, const FindOptions &options) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        if (metrics)
+        {
+            metrics->add_read(true);
+        }
+
+        // Candidate keys point into the map nodes and stay valid while the lock is held
+        std::vector<const std::string *> candidates;
+        const std::string &prefix = matcher.literal_prefix();
+        if (!prefix.empty())
+        {
+            ensure_key_index_locked();
+            for (auto it = key_index_.lower_bound(prefix); it != key_index_.end() && it->first.substr(0, prefix.size()) == prefix; ++it)
+            {
+                candidates.push_back(it->second.key);
+            }
+        }
+        else
+        {
+            candidates.reserve(config_map.size() + arrays_.size() + shared_.size() + lazy_.size());
+            for (const auto &[key, value] : config_map)
+            {
+                candidates.push_back(&key);
+            }
+            for (const auto &[key, array] : arrays_)
+            {
+                candidates.push_back(&key);
+            }
+            for (const auto &[key, value] : shared_)
+            {
+                candidates.push_back(&key);
+            }
+            for (const auto &[key, value] : lazy_)
+            {
+                candidates.push_back(&key);
+            }
+        }
+
+        unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::vector<const std::string *>> found(candidates.size() >= options.parallel_threshold ? threads : 1);
+        auto scan = [&](std::size_t part) {
+            std::size_t begin = candidates.size() * part / found.size();
+            std::size_t end = candidates.size() * (part + 1) / found.size();
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                if (matcher.matches(*candidates[i]))
+                {
+                    found[part].push_back(candidates[i]);
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t part = 1; part < found.size(); ++part)
+        {
+            workers.emplace_back(scan, part);
+        }
+        scan(0);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        std::vector<std::string> keys;
+        for (const auto &part : found)
+        {
+            for (const std::string *key : part)
+            {
+                keys.push_back(*key);
+            }
+        }
+        if (prefix.empty())
+        {
+            std::sort(keys.begin(), keys.end());
+        }
+        return keys;
+    }
+
+    std::vector<std::string> Config::find_keys(const std::string &glob) const
+    {
+        return find_keys(KeyMatcher::glob(glob));
+    }
+
+    nlohmann::json Config::get_interpolated(const std::string &key) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        if (metrics)
+        {
+            metrics->add_read(interpolated_.count(key) != 0 || config_map.count(key) != 0 || arrays_.count(key) != 0 || shared_.count(key) != 0 || lazy_.count(key) != 0);
+        }
+        std::vector<std::string> stack;
+        return interpolate_locked(key, stack);
+    }
+
+    void Config::set_interpolation_options(const InterpolationOptions &options)
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        interpolation_options_ = options;
+        interpolated_.clear();
+        interpolation_dependents_.clear();
+    }
+
+    // Caller must hold mutex_
+    const nlohmann::json &Config::interpolate_locked(const std::string &key, std::vector<std::string> &stack) const
+    {
+        auto cached = interpolated_.find(key);
+        if (cached != interpolated_.end())
+        {
+            return cached->second;
+        }
+        if (std::find(stack.begin(), stack.end(), key) != stack.end())
+        {
+            std::string cycle;
+            for (const auto &entry : stack)
+            {
+                cycle += entry + " -> ";
+            }
+            throw std::invalid_argument("Interpolation cycle: " + cycle + key);
+        }
+        if (stack.size() >= interpolation_options_.max_depth)
+        {
+            throw std::invalid_argument("Interpolation nested deeper than " + std::to_string(interpolation_options_.max_depth) + " at key: " + key);
+        }
+        nlohmann::json scratch;
+        const nlohmann::json *raw = find_locked(key, scratch);
+        if (!raw)
+        {
+            throw std::invalid_argument("Unknown configuration key: " + key);
+        }
+        stack.push_back(key);
+        nlohmann::json value = expand_locked(*raw, key, stack);
+        stack.pop_back();
+        return interpolated_.emplace(key, std::move(value)).first->second;
+    }
+
+    // Caller must hold mutex_
+    nlohmann::json Config::expand_locked(const nlohmann::json &value, const std::string &owner, std::vector<std::string> &stack) const
+    {
+        if (value.is_string())
+        {
+            const std::string &text = value.get_ref<const std::string &>();
+            if (!has_references(text))
+            {
+                return value;
+            }
+            std::vector<TemplatePart> parts = parse_template(text);
+            if (parts.size() == 1 && parts[0].kind != TemplatePart::Kind::TEXT)
+            {
+                return resolve_reference_locked(parts[0], owner, stack);
+            }
+            std::string expanded;
+            for (const auto &part : parts)
+            {
+                if (part.kind == TemplatePart::Kind::TEXT)
+                {
+                    expanded += part.text;
+                    continue;
+                }
+                nlohmann::json resolved = resolve_reference_locked(part, owner, stack);
+                expanded += resolved.is_string() ? resolved.get_ref<const std::string &>() : resolved.dump();
+            }
+            return expanded;
+        }
+        if (value.is_structured())
+        {
+            nlohmann::json result = value;
+            for (auto it = result.begin(); it != result.end(); ++it)
+            {
+                *it = expand_locked(*it, owner, stack);
+            }
+            return result;
+        }
+        return value;
+    }
+
+    // Caller must hold mutex_; records `owner` as a dependent of the referenced key
+    nlohmann::json Config::resolve_reference_locked(const TemplatePart &part, const std::string &owner, std::vector<std::string> &stack) const
+    {
+        if (part.kind == TemplatePart::Kind::ENV)
+        {
+            if (!interpolation_options_.allow_env)
+            {
+                throw std::invalid_argument("Environment references are disabled: ${env:" + part.text + "} in key: " + owner);
+            }
+            const char *env_val = std::getenv(part.text.c_str());
+            if (!env_val)
+            {
+                throw std::invalid_argument("Environment variable not set: " + part.text + " (referenced by key: " + owner + ")");
+            }
+            return env_val;
+        }
+        interpolation_dependents_[part.text].insert(owner);
+        return interpolate_locked(part.text, stack);
+    }
+
+    // Caller must hold mutex_; drops the memoized result for `key` and, transitively, for every result that used it
+    void Config::invalidate_interpolation_locked(const std::string &key)
+    {
+        std::vector<std::string> pending{key};
+        while (!pending.empty())
+        {
+            std::string current = std::move(pending.back());
+            pending.pop_back();
+            interpolated_.erase(current);
+            auto dependents = interpolation_dependents_.find(current);
+            if (dependents != interpolation_dependents_.end())
+            {
+                pending.insert(pending.end(), dependents->second.begin(), dependents->second.end());
+                interpolation_dependents_.erase(dependents);
+            }
+        }
+    }
+
+    void Config::define_derived(const std::string &key, const std::vector<std::string> &inputs, DeriveFunction fn)
+    {
+        if (key.empty())
+        {
+            throw std::invalid_argument("Key cannot be empty");
+        }
+        if (!fn)
+        {
+            throw std::invalid_argument("Derived key needs a function: " + key);
+        }
+        MeteredLock lock(mutex_, active_metrics());
+        std::optional<DerivedKey> replaced;
+        auto existing = derived_.find(key);
+        if (existing != derived_.end())
+        {
+            replaced = std::move(existing->second);
+        }
+        derived_[key] = DerivedKey{inputs, std::move(fn), 0, {}};
+        try
+        {
+            rebuild_derived_graph_locked();
+        }
+        catch (...)
+        {
+            if (replaced)
+            {
+                derived_[key] = std::move(*replaced);
+            }
+            else
+            {
+                derived_.erase(key);
+            }
+            rebuild_derived_graph_locked();
+            throw;
+        }
+        recompute_derived_locked({{derived_[key].rank, key}});
+    }
+
+    void Config::remove_derived(const std::string &key)
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        if (derived_.erase(key) != 0)
+        {
+            rebuild_derived_graph_locked();
+        }
+    }
+
+    bool Config::is_derived(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        return derived_.count(key) != 0;
+    }
+
+    std::string Config::derived_error(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        auto derived = derived_.find(key);
+        return derived != derived_.end() ? derived->second.error : std::string();
+    }
+
+    // Existing values are interned too, so enabling after a load shares what is already there
+    void Config::enable_interning(std::shared_ptr<ValueInterner> interner)
+    {
+        if (!interner)
+        {
+            throw std::invalid_argument("Interner cannot be null");
+        }
+        MeteredLock lock(mutex_, active_metrics());
+        interner_ = std::move(interner);
+        std::vector<std::string> keys;
+        for (const auto &[key, value] : config_map)
+        {
+            if (value.is_structured())
+            {
+                keys.push_back(key);
+            }
+        }
+        for (const auto &[key, value] : shared_)
+        {
+            keys.push_back(key);
+        }
+        for (const auto &key : keys)
+        {
+            auto it = config_map.find(key);
+            nlohmann::json value = it != config_map.end() ? std::move(it->second) : *shared_.at(key);
+            store_locked(key, std::move(value));
+        }
+    }
+
+    void Config::disable_interning()
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        interner_.reset();
+    }
+
+    bool Config::is_shared(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        auto resident = resident_.find(key);
+        auto shared = shared_.find(key);
+        return shared != shared_.end() && (resident == resident_.end() || resident->second.spilling != shared->second.get());
+    }
+
+    void Config::set_memory_budget(const MemoryBudget &budget)
+    {
+        std::vector<PendingSpill> spills;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            bool was_enabled = budget_.enabled();
+            budget_ = budget;
+            spill_blocked_ = false;
+            if (!budget_.enabled())
+            {
+                resident_.clear();
+                resident_estimate_ = 0;
+                spill_pending_ = false;
+                return;
+            }
+            if (!was_enabled)
+            {
+                measure_resident_locked();
+            }
+            enforce_memory_budget_locked();
+            spills.swap(spill_queue_);
+        }
+        write_spills(spills);
+    }
+
+    void Config::enforce_memory_budget()
+    {
+        std::vector<PendingSpill> spills;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            enforce_memory_budget_locked();
+            spills.swap(spill_queue_);
+        }
+        write_spills(spills);
+    }
+
+    bool Config::is_spilled(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        auto it = lazy_.find(key);
+        return it != lazy_.end() && it->second.spilled && !it->second.value;
+    }
+
+    SpillStats Config::spill_stats() const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        SpillStats stats = spill_counters_;
+        stats.resident_bytes = resident_estimate_;
+        for (const auto &[key, lazy] : lazy_)
+        {
+            stats.spilled_values += lazy.spilled && !lazy.value ? 1 : 0;
+        }
+        for (const auto &segment : spill_segments_)
+        {
+            if (auto live = segment.lock())
+            {
+                stats.spill_file_bytes += live->contents().size();
+            }
+        }
+        return stats;
+    }
+
+    // Caller must hold mutex_
+    void Config::touch_locked(const std::string &key) const
+    {
+        resident_[key].tick = ++access_clock_;
+    }
+
+    // Caller must hold mutex_; records a newly stored value's size and flags a pass when one could evict something
+    void Config::note_resident_locked(const std::string &key, const nlohmann::json &value)
+    {
+        ResidentValue &resident = resident_[key];
+        resident.spilling = nullptr;
+        resident_estimate_ -= resident.bytes;
+        resident.bytes = memory::value_heap_bytes(value);
+        resident_estimate_ += resident.bytes;
+        bool spillable = resident.bytes >= budget_.min_spill_bytes;
+        if ((budget_.spill_threshold != 0 && resident.bytes >= budget_.spill_threshold) ||
+            (budget_.resident_bytes != 0 && resident_estimate_ > budget_.resident_bytes && (spillable || !spill_blocked_)))
+        {
+            spill_pending_ = true;
+        }
+    }
+
+    // Caller must hold mutex_; the key's value is being replaced or erased
+    void Config::forget_resident_locked(const std::string &key)
+    {
+        auto it = resident_.find(key);
+        if (it != resident_.end())
+        {
+            resident_estimate_ -= it->second.bytes;
+            resident_.erase(it);
+        }
+    }
+
+    // Caller must hold mutex_; measures every parsed value once, when a budget is first set
+    void Config::measure_resident_locked()
+    {
+        resident_estimate_ = 0;
+        for (auto &[key, resident] : resident_)
+        {
+            resident.bytes = 0;
+        }
+        for (const auto &[key, value] : config_map)
+        {
+            std::size_t bytes = memory::value_heap_bytes(value);
+            resident_[key].bytes = bytes;
+            resident_estimate_ += bytes;
+        }
+        for (const auto &[key, lazy] : lazy_)
+        {
+            if (lazy.value)
+            {
+                std::size_t bytes = memory::value_heap_bytes(*lazy.value);
+                resident_[key].bytes = bytes;
+                resident_estimate_ += bytes;
+            }
+        }
+    }
+
+    // Caller must hold mutex_. Evicts values over the threshold and, while over budget, the least recently used
+    // spillable ones, using the sizes recorded per key. Parsed lazy and reloaded values just drop their parse,
+    // since their slice is still valid. Values only in config_map are moved to shared_ and queued in spill_queue_;
+    // the public caller hands the queue to write_spills once it has released the lock
+    void Config::enforce_memory_budget_locked()
+    {
+        spill_pending_ = false;
+        if (!budget_.enabled())
+        {
+            return;
+        }
+        struct Candidate
+        {
+            const std::string *key;
+            std::size_t bytes;
+            std::uint64_t tick;
+            bool in_map;
+        };
+        std::size_t resident = resident_estimate_;
+        std::vector<Candidate> candidates;
+        for (const auto &[key, value] : resident_)
+        {
+            if (value.bytes >= budget_.min_spill_bytes && value.bytes != 0 && value.spilling == nullptr)
+            {
+                candidates.push_back({&key, value.bytes, value.tick, config_map.find(key) != config_map.end()});
+            }
+        }
+
+        std::vector<Candidate> evict;
+        auto keep = candidates.begin();
+        for (auto it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            if (budget_.spill_threshold != 0 && it->bytes >= budget_.spill_threshold)
+            {
+                resident -= it->bytes;
+                evict.push_back(*it);
+            }
+            else
+            {
+                *keep++ = *it;
+            }
+        }
+        candidates.erase(keep, candidates.end());
+        if (budget_.resident_bytes != 0 && resident > budget_.resident_bytes)
+        {
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+                return a.tick != b.tick ? a.tick < b.tick : a.bytes > b.bytes;
+            });
+            for (const auto &candidate : candidates)
+            {
+                if (resident <= budget_.resident_bytes)
+                {
+                    break;
+                }
+                resident -= candidate.bytes;
+                evict.push_back(candidate);
+            }
+        }
+        resident_estimate_ = resident;
+        // Writes of values too small to spill skip the pass until something spillable is stored again
+        spill_blocked_ = budget_.resident_bytes != 0 && resident > budget_.resident_bytes;
+        if (evict.empty())
+        {
+            return;
+        }
+
+        ++generation_;
+        for (const Candidate &candidate : evict)
+        {
+            std::string key = *candidate.key;
+            if (!query_cache_.empty())
+            {
+                query_cache_.erase(key);
+            }
+            ResidentValue &resident = resident_.at(key);
+            resident.bytes = 0;
+            if (!candidate.in_map)
+            {
+                lazy_.at(key).value.reset();
+                continue;
+            }
+            // The index views the map node's key, so unindex before erasing it
+            auto it = config_map.find(key);
+            auto value = std::make_shared<const nlohmann::json>(std::move(it->second));
+            unindex_key_locked(key);
+            config_map.erase(it);
+            auto parked = shared_.insert_or_assign(key, value).first;
+            index_key_locked(parked->first, parked->second.get());
+            resident.spilling = value.get();
+            spill_queue_.push_back({std::move(key), std::move(value)});
+        }
+        ++spill_counters_.passes;
+    }
+
+    // Called without mutex_: serializes and writes the queued values, then swaps in a spilled LazyValue for each
+    // key still holding the queued value. Keys written meanwhile keep their new value; if the write fails the
+    // values go back to config_map and count against the budget again
+    void Config::write_spills(std::vector<PendingSpill> &spills)
+    {
+        if (spills.empty())
+        {
+            return;
+        }
+        std::string segment;
+        std::vector<std::pair<std::size_t, std::size_t>> ranges(spills.size());
+        for (std::size_t i = 0; i < spills.size(); ++i)
+        {
+            ranges[i].first = segment.size();
+            segment += spills[i].value->dump();
+            ranges[i].second = segment.size() - ranges[i].first;
+        }
+        std::string directory;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            directory = budget_.directory;
+        }
+        std::shared_ptr<const MappedDocument> document = write_spill_segment(directory, segment);
+        if (!document)
+        {
+            std::cerr << "Failed to write spill segment in " << directory << "; values stay resident" << std::endl;
+        }
+
+        MeteredLock lock(mutex_, active_metrics());
+        if (document)
+        {
+            spill_segments_.erase(std::remove_if(spill_segments_.begin(), spill_segments_.end(),
+                                                 [](const std::weak_ptr<const MappedDocument> &s) { return s.expired(); }),
+                                  spill_segments_.end());
+            spill_segments_.push_back(document);
+        }
+        ++generation_;
+        for (std::size_t i = 0; i < spills.size(); ++i)
+        {
+            const std::string &key = spills[i].key;
+            auto resident = resident_.find(key);
+            if (resident == resident_.end() || resident->second.spilling != spills[i].value.get())
+            {
+                continue; // Overwritten, erased or cleared while it was being written
+            }
+            resident->second.spilling = nullptr;
+            auto parked = shared_.find(key);
+            if (parked == shared_.end() || parked->second != spills[i].value)
+            {
+                continue;
+            }
+            if (!query_cache_.empty())
+            {
+                query_cache_.erase(key);
+            }
+            unindex_key_locked(key);
+            shared_.erase(parked);
+            if (!document)
+            {
+                auto restored = config_map.emplace(key, *spills[i].value).first;
+                index_key_locked(restored->first, &restored->second);
+                resident->second.bytes = memory::value_heap_bytes(restored->second);
+                resident_estimate_ += resident->second.bytes;
+                spill_blocked_ = true;
+                continue;
+            }
+            auto it = lazy_.insert_or_assign(key, LazyValue{document, ranges[i].first, ranges[i].second, std::nullopt, true}).first;
+            index_key_locked(it->first, nullptr);
+            ++spill_counters_.spills;
+        }
+    }
+
+    void Config::set_lazy_loading(bool enabled)
+    {
+        lazy_loading_.store(enabled);
+    }
+
+    bool Config::is_lazy(const std::string &key) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        auto it = lazy_.find(key);
+        return it != lazy_.end() && !it->second.value && !it->second.spilled;
+    }
+
+    // Caller must hold mutex_; assigns ranks and rebuilds the dependents lists, throwing on a cycle
+    void Config::rebuild_derived_graph_locked()
+    {
+        enum class Mark
+        {
+            VISITING,
+            DONE
+        };
+        std::unordered_map<std::string, Mark> marks;
+        std::vector<std::string> path;
+        std::function<std::size_t(const std::string &)> visit = [&](const std::string &key) -> std::size_t {
+            auto derived = derived_.find(key);
+            if (derived == derived_.end())
+            {
+                return 0;
+            }
+            auto mark = marks.find(key);
+            if (mark != marks.end())
+            {
+                if (mark->second == Mark::DONE)
+                {
+                    return derived->second.rank;
+                }
+                std::string cycle;
+                for (auto it = std::find(path.begin(), path.end(), key); it != path.end(); ++it)
+                {
+                    cycle += *it + " -> ";
+                }
+                throw std::invalid_argument("Derived key cycle: " + cycle + key);
+            }
+            marks.emplace(key, Mark::VISITING);
+            path.push_back(key);
+            std::size_t rank = 1;
+            for (const auto &input : derived->second.inputs)
+            {
+                rank = std::max(rank, visit(input) + 1);
+            }
+            path.pop_back();
+            marks[key] = Mark::DONE;
+            derived->second.rank = rank;
+            return rank;
+        };
+        for (const auto &[key, derived] : derived_)
+        {
+            visit(key);
+        }
+
+        derived_dependents_.clear();
+        for (const auto &[key, derived] : derived_)
+        {
+            for (const auto &input : derived.inputs)
+            {
+                derived_dependents_[input].push_back(key);
+            }
+        }
+    }
+
+    // Caller must hold mutex_
+    void Config::propagate_derived_locked(const std::vector<std::string> &changed)
+    {
+        DerivedQueue queue;
+        for (const auto &key : changed)
+        {
+            auto dependents = derived_dependents_.find(key);
+            if (dependents != derived_dependents_.end())
+            {
+                for (const auto &dependent : dependents->second)
+                {
+                    queue.emplace(derived_.at(dependent).rank, dependent);
+                }
+            }
+        }
+        if (!queue.empty())
+        {
+            recompute_derived_locked(std::move(queue));
+        }
+    }
+
+    // Caller must hold mutex_; each key is computed at most once, after all of its derived inputs
+    void Config::recompute_derived_locked(DerivedQueue queue)
+    {
+        while (!queue.empty())
+        {
+            std::string key = std::move(queue.begin()->second);
+            queue.erase(queue.begin());
+            DerivedKey &derived = derived_.at(key);
+
+            std::vector<nlohmann::json> scratch(derived.inputs.size());
+            std::vector<const nlohmann::json *> values;
+            values.reserve(derived.inputs.size());
+            for (std::size_t i = 0; i < derived.inputs.size(); ++i)
+            {
+                const nlohmann::json *value = find_locked(derived.inputs[i], scratch[i]);
+                if (!value)
+                {
+                    break;
+                }
+                values.push_back(value);
+            }
+
+            bool changed = false;
+            if (values.size() < derived.inputs.size())
+            {
+                derived.error.clear();
+                changed = erase_locked(key);
+            }
+            else
+            {
+                nlohmann::json value;
+                try
+                {
+                    value = derived.fn(DerivedInputs(derived.inputs, values));
+                }
+                catch (const std::exception &e)
+                {
+                    derived.error = e.what();
+                    continue;
+                }
+                catch (...)
+                {
+                    derived.error = "unknown exception";
+                    continue;
+                }
+                derived.error.clear();
+                nlohmann::json current_scratch;
+                const nlohmann::json *current = find_locked(key, current_scratch);
+                if (!current || *current != value)
+                {
+                    store_locked(key, value);
+                    for (const auto &listener : change_listeners_)
+                    {
+                        TraceScope trace("listener", "config.listener");
+                        trace.arg("key", key);
+                        listener(key, value);
+                    }
+                    if (ConfigMetrics *metrics = active_metrics())
+                    {
+                        metrics->add_writes();
+                        metrics->add_listener_invocations(change_listeners_.size());
+                    }
+                    changed = true;
+                }
+            }
+
+            if (changed)
+            {
+                auto dependents = derived_dependents_.find(key);
+                if (dependents != derived_dependents_.end())
+                {
+                    for (const auto &dependent : dependents->second)
+                    {
+                        queue.emplace(derived_.at(dependent).rank, dependent);
+                    }
+                }
+            }
+        }
+    }
+
+    std::chrono::nanoseconds Config::get_duration(const std::string &key) const
+    {
+        return get_as<std::chrono::nanoseconds, DurationParser>(key);
+    }
+
+    std::uint64_t Config::get_bytes(const std::string &key) const
+    {
+        return get_as<std::uint64_t, ByteSizeParser>(key);
+    }
+
+    std::unordered_map<std::string, nlohmann::json> Config::get_all() const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        if (metrics)
+        {
+            metrics->add_read(true);
+        }
+        std::unordered_map<std::string, nlohmann::json> scratch;
+        return materialized_locked(scratch);
+    }
+
+    void Config::validate(const std::unordered_map<std::string, std::function<bool(const nlohmann::json &)>> &validators) const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        try
+        {
+            for (const auto &[key, validate_func] : validators)
+            {
+                nlohmann::json scratch;
+                const nlohmann::json *found = find_locked(key, scratch);
+                if (found)
+                {
+                    if (!validate_func(*found))
+                    {
+                        throw std::invalid_argument("Validation failed for key: " + key + " with value: " + found->dump());
+                    }
+                }
+                else
+                {
+                    throw std::invalid_argument("Validation failed: key not found: " + key);
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error in validate: " << e.what() << std::endl;
+        }
+    }
+
+    IoResult Config::load_from_file(const std::string &file_path)
+    {
+        try
+        {
+            return load_from_file(file_path, "1.0.0");
+        }
+        catch (const std::exception &e)
+        {
+            IoResult result;
+            result.file_path = file_path;
+            return io_failure(result, io_exception_error(e, IoError::READ_FAILED), e.what());
+        }
+    }
+
+    IoResult Config::save_to_file(const std::string &file_path) const
+    {
+        try
+        {
+            return save_to_file(file_path, "1.0.0");
+        }
+        catch (const std::exception &e)
+        {
+            IoResult result;
+            result.file_path = file_path;
+            return io_failure(result, io_exception_error(e, IoError::WRITE_FAILED), e.what());
+        }
+    }
+
+    void Config::remove(const std::string &key)
+    {
+        std::vector<std::function<void()>> reload_listeners;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            try
+            {
+                if (!erase_locked(key))
+                {
+                    throw std::invalid_argument("Unknown configuration key: " + key);
+                }
+                if (!derived_dependents_.empty() && derived_dependents_.count(key) != 0)
+                {
+                    propagate_derived_locked({key});
+                }
+                reload_listeners = reload_listeners_;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error in remove: " << e.what() << std::endl;
+            }
+        }
+        for (const auto &listener : reload_listeners)
+        {
+            listener();
+        }
+    }
+
+    bool Config::exists(const std::string &key) const
+    {
+        ConfigMetrics *metrics = active_metrics();
+        MeteredLock lock(mutex_, metrics);
+        try
+        {
+            bool found = config_map.find(key) != config_map.end() || arrays_.find(key) != arrays_.end() || shared_.find(key) != shared_.end() || lazy_.find(key) != lazy_.end();
+            if (metrics)
+            {
+                metrics->add_read(found);
+            }
+            return found;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error in exists: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    void Config::clear()
+    {
+        std::vector<std::function<void()>> reload_listeners;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            try
+            {
+                clear_locked();
+                reload_listeners = reload_listeners_;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error in clear: " << e.what() << std::endl;
+            }
+        }
+        for (const auto &listener : reload_listeners)
+        {
+            listener();
+        }
+    }
+
+    void Config::display() const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        try
+        {
+            std::unordered_map<std::string, nlohmann::json> scratch;
+            for (const auto &[key, value] : materialized_locked(scratch))
+            {
+                std::cout << key << ": " << value.dump(4) << std::endl;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error in display: " << e.what() << std::endl;
+        }
+    }
+
+    std::vector<nlohmann::json> Config::inspect(const std::vector<std::string> &keys) const
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        std::vector<nlohmann::json> values;
+        values.reserve(keys.size());
+
+        for (const auto &key : keys)
+        {
+            lock.unlock();
+            try
+            {
+                values.push_back(get(key));
+            }
+            catch (const std::invalid_argument &e)
+            {
+                values.push_back(nlohmann::json::object());
+            }
+            lock.lock();
+        }
+
+        return values;
+    }
+
+    void Config::update_multiple(std::unordered_map<std::string, nlohmann::json> &&new_cfg)
+    {
+        std::vector<PendingSpill> spills;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            try
+            {
+                config_map.reserve(config_map.size() + new_cfg.size());
+                for (auto &[key, value] : new_cfg)
+                {
+                    set_locked(key, std::move(value));
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error in update_multiple: " << e.what() << std::endl;
+            }
+            spills.swap(spill_queue_);
+        }
+        write_spills(spills);
+    }
+
+    void Config::update_multiple(const std::unordered_map<std::string, nlohmann::json> &new_cfg)
+    {
+        std::vector<PendingSpill> spills;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            try
+            {
+                config_map.reserve(config_map.size() + new_cfg.size());
+                for (const auto &[key, value] : new_cfg)
+                {
+                    set_locked(key, value);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error in update_multiple: " << e.what() << std::endl;
+            }
+            spills.swap(spill_queue_);
+        }
+        write_spills(spills);
+    }
+
+    std::string Config::file_extension(const std::string &file_path)
+    {
+        return file_path.substr(file_path.find_last_of(".") + 1);
+    }
+
+    bool Config::is_supported_extension(const std::string &extension)
+    {
+        return extension == "json" || extension == "yaml" || extension == "yml";
+    }
+
+    void Config::trace_io_result(TraceScope &trace, const IoResult &result)
+    {
+        if (trace)
+        {
+            trace.arg("file", result.file_path).arg("bytes", result.bytes).arg("keys", result.keys);
+            trace.arg("error", io_error_to_string(result.error));
+        }
+    }
+
+    IoResult &Config::io_failure(IoResult &result, IoError error, const std::string &message)
+    {
+        result.error = error;
+        result.message = message;
+        return result;
+    }
+
+    IoError Config::io_exception_error(const std::exception &e, IoError fallback)
+    {
+        if (dynamic_cast<const nlohmann::json::parse_error *>(&e) || dynamic_cast<const YAML::ParserException *>(&e))
+        {
+            return IoError::PARSE_FAILED;
+        }
+        if (dynamic_cast<const nlohmann::json::type_error *>(&e) || dynamic_cast<const YAML::BadConversion *>(&e))
+        {
+            return IoError::CONVERSION_FAILED;
+        }
+        return fallback;
+    }
+
+    void Config::locate_offset(IoResult &result, std::string_view contents, std::size_t offset)
+    {
+        offset = std::min(offset, contents.size());
+        result.offset = offset;
+        result.line = 1;
+        result.column = 1;
+        for (std::size_t i = 0; i < offset; ++i)
+        {
+            if (contents[i] == '\n')
+            {
+                ++result.line;
+                result.column = 1;
+            }
+            else
+            {
+                ++result.column;
+            }
+        }
+    }
+
+    bool Config::read_file(const std::string &file_path, const std::string &extension, std::string &contents, IoResult &result, IoPhaseClock &clock)
+    {
+        std::ifstream config_file(file_path, std::ios::binary);
+        result.timings.open = clock.lap();
+        if (!config_file.is_open())
+        {
+            io_failure(result, IoError::OPEN_FAILED, "Failed to open config file for reading: " + file_path);
+            return false;
+        }
+        if (!is_supported_extension(extension))
+        {
+            io_failure(result, IoError::UNSUPPORTED_FORMAT, "Error while loading config file: Unsupported config file format: " + extension);
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << config_file.rdbuf();
+        result.timings.read = clock.lap();
+        if (config_file.bad())
+        {
+            io_failure(result, IoError::READ_FAILED, "Error while loading config file: failed to read " + file_path);
+            return false;
+        }
+        contents = std::move(buffer).str();
+        result.bytes = contents.size();
+        return true;
+    }
+
+    bool Config::write_file(const std::string &file_path, const std::string &contents, const std::string &context, IoResult &result,
+                            IoPhaseClock &clock)
+    {
+        static std::atomic<std::uint64_t> next_temp{0};
+        std::string temp_path = file_path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(next_temp.fetch_add(1));
+        std::ofstream file(temp_path, std::ios::binary);
+        result.timings.open = clock.lap();
+        if (!file.is_open())
+        {
+            io_failure(result, IoError::OPEN_FAILED, context + "Failed to open " + temp_path + " for writing");
+            return false;
+        }
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        file.close();
+        bool written = !file.fail() && std::rename(temp_path.c_str(), file_path.c_str()) == 0;
+        result.timings.write = clock.lap();
+        if (!written)
+        {
+            std::remove(temp_path.c_str());
+            io_failure(result, IoError::WRITE_FAILED, context + "failed to write " + file_path);
+            return false;
+        }
+        result.bytes = contents.size();
+        return true;
+    }
+
+    bool Config::parse_document(const std::string &contents, const std::string &extension, const std::vector<std::string> *keys,
+                                std::vector<std::pair<std::string, nlohmann::json>> &entries, IoResult &result, IoPhaseClock &clock)
+    {
+        if (extension == "json")
+        {
+            nlohmann::json j;
+            try
+            {
+                j = nlohmann::json::parse(contents);
+            }
+            catch (const nlohmann::json::parse_error &e)
+            {
+                result.timings.parse = clock.lap();
+                locate_offset(result, contents, e.byte > 0 ? e.byte - 1 : 0);
+                io_failure(result, IoError::PARSE_FAILED, std::string("Error while loading config file: ") + e.what());
+                return false;
+            }
+            result.timings.parse = clock.lap();
+            try
+            {
+                if (keys)
+                {
+                    // Values are moved out, so a key listed twice is only taken once
+                    std::unordered_set<std::string_view> taken;
+                    for (const auto &key : *keys)
+                    {
+                        auto found = j.find(key);
+                        if (found != j.end() && taken.insert(key).second)
+                        {
+                            entries.emplace_back(key, std::move(*found));
+                        }
+                    }
+                }
+                else
+                {
+                    // The parsed document is discarded, so its values are moved out rather than copied
+                    for (auto it = j.begin(); it != j.end(); ++it)
+                    {
+                        entries.emplace_back(it.key(), std::move(it.value()));
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                result.timings.convert = clock.lap();
+                io_failure(result, IoError::CONVERSION_FAILED, std::string("Error while loading config file: ") + e.what());
+                return false;
+            }
+            result.timings.convert = clock.lap();
+            return true;
+        }
+
+        YAML::Node yaml_config;
+        try
+        {
+            yaml_config = YAML::Load(contents);
+        }
+        catch (const YAML::Exception &e)
+        {
+            result.timings.parse = clock.lap();
+            locate_offset(result, contents, e.mark.pos > 0 ? static_cast<std::size_t>(e.mark.pos) : 0);
+            io_failure(result, IoError::PARSE_FAILED, std::string("Error while loading config file: ") + e.what());
+            return false;
+        }
+        result.timings.parse = clock.lap();
+        try
+        {
+#ifdef FORMAT_MANAGER_INCLUDED
+            if (keys)
+            {
+                std::unordered_set<std::string_view> taken;
+                for (const auto &key : *keys)
+                {
+                    if (yaml_config[key] && taken.insert(key).second)
+                    {
+                        entries.emplace_back(key, output_format::yaml_to_json(yaml_config[key]));
+                    }
+                }
+            }
+            else
+            {
+                for (auto it = yaml_config.begin(); it != yaml_config.end(); ++it)
+                {
+                    entries.emplace_back(it->first.as<std::string>(), output_format::yaml_to_json(it->second));
+                }
+            }
+#endif
+        }
+        catch (const std::exception &e)
+        {
+            result.timings.convert = clock.lap();
+            io_failure(result, IoError::CONVERSION_FAILED, std::string("Error while loading config file: ") + e.what());
+            return false;
+        }
+        result.timings.convert = clock.lap();
+        return true;
+    }
+
+    bool Config::scan_document(const std::string &file_path, const std::vector<std::string> *keys,
+                               std::vector<std::pair<std::string, LazyValue>> &entries, IoResult &result, IoPhaseClock &clock)
+    {
+        // A private copy, so rewriting the file cannot change or truncate slices that are still unparsed
+        std::shared_ptr<const MappedDocument> document = MappedDocument::read(file_path);
+        result.timings.open = clock.lap();
+        if (!document)
+        {
+            io_failure(result, IoError::OPEN_FAILED, "Failed to open config file for reading: " + file_path);
+            return false;
+        }
+        result.bytes = document->contents().size();
+        result.timings.read = clock.lap();
+        std::vector<RawSlice> slices;
+        std::size_t error_offset = 0;
+        bool scanned = scan_top_level(document->contents(), slices, error_offset);
+        result.timings.parse = clock.lap();
+        if (!scanned)
+        {
+            locate_offset(result, document->contents(), error_offset);
+            io_failure(result, IoError::PARSE_FAILED, "Error while loading config file: malformed JSON object at byte " + std::to_string(error_offset));
+            return false;
+        }
+        entries.reserve(slices.size());
+        for (auto &slice : slices)
+        {
+            if (!keys || std::find(keys->begin(), keys->end(), slice.key) != keys->end())
+            {
+                entries.emplace_back(std::move(slice.key), LazyValue{document, slice.offset, slice.length, std::nullopt});
+            }
+        }
+        result.timings.convert = clock.lap();
+        return true;
+    }
+
+    bool Config::serialize_document(const std::string &extension, const std::vector<std::string> *keys, const std::string *version,
+                                    std::string &output, IoResult &result) const
+    {
+        try
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            std::unordered_map<std::string, nlohmann::json> scratch;
+            const auto &entries = materialized_locked(scratch);
+            if (extension == "json")
+            {
+                nlohmann::json j;
+                if (keys)
+                {
+                    for (const auto &key : *keys)
+                    {
+                        auto it = entries.find(key);
+                        if (it != entries.end() && !j.contains(key))
+                        {
+                            j[key] = it->second;
+                            ++result.keys;
+                        }
+                    }
+                }
+                else
+                {
+                    j = entries;
+                    result.keys = entries.size();
+                }
+                if (version)
+                {
+                    j["version"] = *version;
+                }
+                output = j.dump(4);
+            }
+            else
+            {
+                YAML::Emitter out;
+                out << YAML::BeginMap;
+                if (version)
+                {
+                    out << YAML::Key << "version" << YAML::Value << *version;
+                }
+                auto emit = [&](const std::string &key, const nlohmann::json &value) {
+#ifdef FORMAT_MANAGER_INCLUDED
+                    out << YAML::Key << key << YAML::Value << output_format::json_to_yaml(value);
+#endif
+                    ++result.keys;
+                };
+                if (keys)
+                {
+                    // A key listed twice is emitted once, since YAML maps cannot repeat keys
+                    std::unordered_set<std::string_view> emitted;
+                    for (const auto &key : *keys)
+                    {
+                        auto it = entries.find(key);
+                        if (it != entries.end() && emitted.insert(key).second)
+                        {
+                            emit(key, it->second);
+                        }
+                    }
+                }
+                else
+                {
+                    for (const auto &[key, value] : entries)
+                    {
+                        emit(key, value);
+                    }
+                }
+                out << YAML::EndMap;
+                output = out.c_str();
+            }
+        }
+        catch (const std::exception &e)
+        {
+            io_failure(result, IoError::CONVERSION_FAILED, std::string("Error while saving config file: ") + e.what());
+            return false;
+        }
+        return true;
+    }
+
+    IoResult Config::load_document(const std::string &file_path, const std::vector<std::string> *keys, const std::string *version)
+    {
+        IoResult result;
+        result.file_path = file_path;
+        IoPhaseClock clock;
+        std::string extension = file_extension(file_path);
+        std::vector<std::pair<std::string, nlohmann::json>> entries;
+        std::vector<std::pair<std::string, LazyValue>> lazy_entries;
+        if (lazy_loading_.load() && extension == "json")
+        {
+            if (!scan_document(file_path, keys, lazy_entries, result, clock))
+            {
+                return result;
+            }
+        }
+        else
+        {
+            std::string contents;
+            if (!read_file(file_path, extension, contents, result, clock))
+            {
+                return result;
+            }
+            if (!parse_document(contents, extension, keys, entries, result, clock))
+            {
+                return result;
+            }
+        }
+        commit_document(file_path, entries, lazy_entries, version, result, clock);
+        return result;
+    }
+
+    void Config::commit_document(const std::string &file_path, std::vector<std::pair<std::string, nlohmann::json>> &entries,
+                                 std::vector<std::pair<std::string, LazyValue>> &lazy_entries, const std::string *version, IoResult &result,
+                                 IoPhaseClock &clock)
+    {
+        std::vector<std::function<void()>> reload_listeners;
+        std::vector<PendingSpill> spills;
+        std::size_t skipped = 0;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            reload_listeners = reload_listeners_;
+            // Keys already present make this an overestimate, which only costs empty buckets
+            if (!entries.empty())
+            {
+                config_map.reserve(config_map.size() + entries.size());
+            }
+            if (!lazy_entries.empty())
+            {
+                lazy_.reserve(lazy_.size() + lazy_entries.size());
+            }
+            // Derived keys are recomputed from their inputs, never loaded; only inputs whose value
+            // changed propagate, and lazy inputs count as changed since comparing them means parsing
+            std::vector<std::string> changed;
+            for (auto &[key, value] : entries)
+            {
+                if (!derived_.empty() && derived_.count(key) != 0)
+                {
+                    ++skipped;
+                    continue;
+                }
+                if (!derived_dependents_.empty() && derived_dependents_.count(key) != 0)
+                {
+                    nlohmann::json scratch;
+                    const nlohmann::json *current = find_locked(key, scratch);
+                    if (current == nullptr || *current != value)
+                    {
+                        changed.push_back(key);
+                    }
+                }
+                store_locked(key, std::move(value));
+            }
+            for (auto &[key, value] : lazy_entries)
+            {
+                if (!derived_.empty() && derived_.count(key) != 0)
+                {
+                    ++skipped;
+                    continue;
+                }
+                if (!derived_dependents_.empty() && derived_dependents_.count(key) != 0)
+                {
+                    changed.push_back(key);
+                }
+                store_lazy_locked(key, std::move(value));
+            }
+            if (!changed.empty())
+            {
+                propagate_derived_locked(changed);
+            }
+            if (spill_pending_)
+            {
+                enforce_memory_budget_locked();
+            }
+            spills.swap(spill_queue_);
+            if (version)
+            {
+                version_ = *version;
+            }
+        }
+        write_spills(spills);
+        if (ConfigMetrics *metrics = active_metrics())
+        {
+            metrics->add_writes(entries.size() + lazy_entries.size() - skipped);
+        }
+        if (WorkloadRecorder *recorder = active_recorder())
+        {
+            recorder->record(WorkloadOpType::LOAD, file_path, result.bytes);
+        }
+        result.keys = entries.size() + lazy_entries.size() - skipped;
+        result.timings.insert = clock.lap();
+        for (const auto &listener : reload_listeners)
+        {
+            listener();
+        }
+    }
+
+    std::vector<IoResult> Config::load_from_files(const std::vector<std::string> &file_paths, const BatchLoadOptions &options, BatchReadStats *stats)
+    {
+        TraceScope trace("load_from_files");
+        std::size_t count = file_paths.size();
+        std::vector<IoResult> results(count);
+        std::vector<std::string> extensions(count);
+        std::vector<std::string> batch_paths;
+        std::vector<std::size_t> batch_slot(count, count);
+        bool lazy = lazy_loading_.load();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            results[i].file_path = file_paths[i];
+            extensions[i] = file_extension(file_paths[i]);
+            // Lazy JSON loads read their own private copies instead of going through the batch
+            if (!(lazy && extensions[i] == "json"))
+            {
+                batch_slot[i] = batch_paths.size();
+                batch_paths.push_back(file_paths[i]);
+            }
+        }
+        BatchReadStats read_stats;
+        std::vector<FileBuffer> buffers = read_files(batch_paths, options, &read_stats);
+
+        // Each file parses on whichever thread claims it; the buffers go to the parsers without a copy
+        std::vector<std::vector<std::pair<std::string, nlohmann::json>>> entries(count);
+        std::vector<std::vector<std::pair<std::string, LazyValue>>> lazy_entries(count);
+        std::vector<IoPhaseClock> clocks(count);
+        std::vector<char> parsed(count, 0);
+        auto parse = [&](std::size_t i) {
+            IoResult &result = results[i];
+            clocks[i] = IoPhaseClock();
+            if (batch_slot[i] == count)
+            {
+                parsed[i] = scan_document(file_paths[i], nullptr, lazy_entries[i], result, clocks[i]);
+                return;
+            }
+            FileBuffer &buffer = buffers[batch_slot[i]];
+            result.timings.open = buffer.open;
+            result.timings.read = buffer.read;
+            if (!buffer.opened)
+            {
+                io_failure(result, IoError::OPEN_FAILED, "Failed to open config file for reading: " + file_paths[i]);
+                return;
+            }
+            if (!is_supported_extension(extensions[i]))
+            {
+                io_failure(result, IoError::UNSUPPORTED_FORMAT, "Error while loading config file: Unsupported config file format: " + extensions[i]);
+                return;
+            }
+            if (buffer.error != 0)
+            {
+                io_failure(result, IoError::READ_FAILED, "Error while loading config file: failed to read " + file_paths[i] + ": " + strerror(buffer.error));
+                return;
+            }
+            result.bytes = buffer.contents.size();
+            parsed[i] = parse_document(buffer.contents, extensions[i], nullptr, entries[i], result, clocks[i]);
+            std::string().swap(buffer.contents);
+        };
+        unsigned threads = options.parse_threads ? options.parse_threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+        if (threads <= 1)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                parse(i);
+            }
+        }
+        else
+        {
+            std::atomic<std::size_t> next{0};
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&] {
+                    for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                    {
+                        parse(i);
+                    }
+                });
+            }
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        // Files are applied in the order given, so later files override earlier ones
+        std::size_t total = 0;
+        std::size_t total_lazy = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            total += entries[i].size();
+            total_lazy += lazy_entries[i].size();
+        }
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            config_map.reserve(config_map.size() + total);
+            lazy_.reserve(lazy_.size() + total_lazy);
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parsed[i])
+            {
+                commit_document(file_paths[i], entries[i], lazy_entries[i], nullptr, results[i], clocks[i]);
+            }
+        }
+        if (trace)
+        {
+            trace.arg("files", count).arg("bytes", read_stats.bytes).arg("backend", file_io_backend_to_string(read_stats.backend));
+            trace.arg("syscalls", read_stats.syscalls);
+        }
+        if (stats)
+        {
+            *stats = read_stats;
+        }
+        return results;
+    }
+
+    IoResult Config::save_document(const std::string &file_path, const std::vector<std::string> *keys, const std::string *version) const
+    {
+        IoResult result;
+        result.file_path = file_path;
+        IoPhaseClock clock;
+        // Checked and serialized before anything touches the file, so a failed save leaves it as it was
+        std::string extension = file_extension(file_path);
+        if (!is_supported_extension(extension))
+        {
+            return io_failure(result, IoError::UNSUPPORTED_FORMAT, "Error while saving config file: Unsupported config file format: " + extension);
+        }
+        std::string output;
+        bool converted = serialize_document(extension, keys, version, output, result);
+        result.timings.convert = clock.lap();
+        if (converted)
+        {
+            write_file(file_path, output, "Error while saving config file: ", result, clock);
+        }
+        return result;
+    }
+
+    IoResult Config::load_partial_from_file(const std::string &file_path, const std::vector<std::string> &keys)
+    {
+        TraceScope trace("load_partial_from_file");
+        IoResult result = load_document(file_path, &keys, nullptr);
+        trace_io_result(trace, result);
+        return result;
+    }
+
+    IoResult Config::save_partial_to_file(const std::string &file_path, const std::vector<std::string> &keys) const
+    {
+        TraceScope trace("save_partial_to_file");
+        IoResult result = save_document(file_path, &keys, nullptr);
+        trace_io_result(trace, result);
+        return result;
+    }
+
+    IoResult Config::load_from_file(const std::string &file_path, const std::string &version)
+    {
+        TraceScope trace("load_from_file");
+        IoResult result = load_document(file_path, nullptr, &version);
+        trace_io_result(trace, result);
+        return result;
+    }
+
+    IoResult Config::save_to_file(const std::string &file_path, const std::string &version) const
+    {
+        TraceScope trace("save_to_file");
+        IoResult result = save_document(file_path, nullptr, &version);
+        trace_io_result(trace, result);
+        return result;
+    }
+
+    void Config::load_from_env()
+    {
+        TraceScope trace("load_from_env");
+        std::vector<std::function<void()>> reload_listeners;
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            try
+            {
+                // Load all existing keys from environment. Storing can move a key between config_map and
+                // the side maps, so the overrides are collected first and applied after the scans
+                std::vector<std::pair<std::string, const char *>> overrides;
+                for (const auto &[key, value] : config_map)
+                {
+                    const char *env_val = std::getenv(key.c_str());
+                    if (env_val && derived_.count(key) == 0)
+                    {
+                        overrides.emplace_back(key, env_val);
+                    }
+                }
+                for (const auto &[key, value] : shared_)
+                {
+                    const char *env_val = std::getenv(key.c_str());
+                    if (env_val && derived_.count(key) == 0)
+                    {
+                        overrides.emplace_back(key, env_val);
+                    }
+                }
+                for (const auto &[key, value] : lazy_)
+                {
+                    const char *env_val = std::getenv(key.c_str());
+                    if (env_val && derived_.count(key) == 0)
+                    {
+                        overrides.emplace_back(key, env_val);
+                    }
+                }
+                for (const auto &[key, env_val] : overrides)
+                {
+                    store_locked(key, nlohmann::json(env_val));
+                    env_overrides_[key] = env_val;
+                }
+
+                // Load all environment variables into config_map, sized for all of them up front
+                std::size_t env_count = 0;
+                for (char **env = environ; *env != 0; env++)
+                {
+                    ++env_count;
+                }
+                config_map.reserve(config_map.size() + env_count);
+                for (char **env = environ; *env != 0; env++)
+                {
+                    std::string env_entry = *env;
+                    size_t pos = env_entry.find('=');
+                    if (pos != std::string::npos)
+                    {
+                        std::string key = env_entry.substr(0, pos);
+                        if (derived_.count(key) != 0)
+                        {
+                            continue;
+                        }
+                        std::string value = env_entry.substr(pos + 1);
+                        store_locked(key, nlohmann::json(value));
+                    }
+                }
+
+                // Any input may have changed; recompute every derived key
+                DerivedQueue queue;
+                for (const auto &[key, derived] : derived_)
+                {
+                    queue.emplace(derived.rank, key);
+                }
+                recompute_derived_locked(std::move(queue));
+                reload_listeners = reload_listeners_;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error while loading from environment: " << e.what() << std::endl;
+            }
+        }
+        for (const auto &listener : reload_listeners)
+        {
+            listener();
+        }
+    }
+
+    void Config::add_change_listener(const std::function<void(const std::string &, const nlohmann::json &)> &listener)
+    {
+        MeteredLock lock(mutex_, active_metrics());
         try
         {
             change_listeners_.push_back(listener);
@@ -1010,24 +3875,246 @@ namespace config
         }
     }
 
-    void Config::backup_to_file(const std::string &backup_file_path) const
+    void Config::add_reload_listener(const std::function<void()> &listener)
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        reload_listeners_.push_back(listener);
+    }
+
+    IoResult Config::backup_to_file(const std::string &backup_file_path) const
+    {
+        TraceScope trace("backup_to_file");
+        IoResult result;
+        result.file_path = backup_file_path;
+        IoPhaseClock clock;
+        std::string output;
+        try
+        {
+            MeteredLock lock(mutex_, active_metrics());
+            std::unordered_map<std::string, nlohmann::json> scratch;
+            const auto &values = materialized_locked(scratch);
+            result.keys = values.size();
+            output = nlohmann::json(values).dump(4);
+        }
+        catch (const std::exception &e)
+        {
+            result.timings.convert = clock.lap();
+            io_failure(result, io_exception_error(e, IoError::CONVERSION_FAILED), std::string("Error in backup_to_file: ") + e.what());
+            trace_io_result(trace, result);
+            return result;
+        }
+        result.timings.convert = clock.lap();
+        write_file(backup_file_path, output, "Error in backup_to_file: ", result, clock);
+        trace_io_result(trace, result);
+        return result;
+    }
+
+    void Config::enable_metrics()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        std::ofstream backup_file(backup_file_path);
-        if (!backup_file.is_open())
+        if (!metrics_storage_)
         {
-            std::cerr << "Error in backup_to_file: Failed to open backup file for writing: " << backup_file_path << std::endl;
-            return;
+            metrics_storage_ = std::make_unique<ConfigMetrics>();
         }
-        try
+        metrics_.store(metrics_storage_.get(), std::memory_order_release);
+    }
+
+    void Config::disable_metrics()
+    {
+        metrics_.store(nullptr, std::memory_order_release);
+    }
+
+    bool Config::metrics_enabled() const
+    {
+        return active_metrics() != nullptr;
+    }
+
+    // Snapshot of the counters; all zero if metrics were never enabled
+    ConfigStats Config::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return metrics_storage_ ? metrics_storage_->snapshot() : ConfigStats{};
+    }
+
+    std::string Config::stats_prometheus(const std::string &instance_label) const
+    {
+        return stats().to_prometheus(instance_label);
+    }
+
+    void Config::reset_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (metrics_storage_)
         {
-            nlohmann::json j(config_map);
-            backup_file << j.dump(4);
+            metrics_storage_->reset();
         }
-        catch (const std::exception &e)
+    }
+
+    void Config::attach_profiler(std::shared_ptr<ConfigProfiler> profiler)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (profiler_storage_)
+        {
+            retired_profilers_.push_back(std::move(profiler_storage_));
+        }
+        profiler_storage_ = std::move(profiler);
+        profiler_.store(profiler_storage_.get(), std::memory_order_release);
+    }
+
+    void Config::detach_profiler()
+    {
+        profiler_.store(nullptr, std::memory_order_release);
+    }
+
+    std::shared_ptr<ConfigProfiler> Config::profiler() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_profiler() ? profiler_storage_ : nullptr;
+    }
+
+    void Config::attach_recorder(std::shared_ptr<WorkloadRecorder> recorder)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (recorder_storage_)
+        {
+            retired_recorders_.push_back(std::move(recorder_storage_));
+        }
+        recorder_storage_ = std::move(recorder);
+        recorder_.store(recorder_storage_.get(), std::memory_order_release);
+    }
+
+    void Config::detach_recorder()
+    {
+        recorder_.store(nullptr, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (recorder_storage_)
+        {
+            recorder_storage_->flush();
+        }
+    }
+
+    // Pointers and references into the maps survive rehashing, so cached query results and the key index stay valid
+    void Config::reserve(std::size_t keys)
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        config_map.reserve(keys);
+    }
+
+    void Config::shrink_to_fit()
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        config_map.rehash(0);
+        arrays_.rehash(0);
+        shared_.rehash(0);
+        lazy_.rehash(0);
+        typed_cache_.rehash(0);
+        query_cache_.rehash(0);
+        resident_.rehash(0);
+        change_listeners_.shrink_to_fit();
+        spill_segments_.erase(std::remove_if(spill_segments_.begin(), spill_segments_.end(),
+                                             [](const std::weak_ptr<const MappedDocument> &s) { return s.expired(); }),
+                              spill_segments_.end());
+        spill_segments_.shrink_to_fit();
+    }
+
+    std::size_t Config::bucket_count() const
+    {
+        MeteredLock lock(mutex_, active_metrics());
+        return config_map.bucket_count();
+    }
+
+    MemoryUsage Config::memory_usage() const
+    {
+        MemoryUsage usage;
+        usage.instance_bytes = sizeof(Config);
+        MeteredLock lock(mutex_, active_metrics());
+        memory::account_map(config_map, usage);
+        for (const auto &[key, array] : arrays_)
+        {
+            KeyMemoryUsage entry;
+            entry.key = key;
+            entry.type = array.type_name();
+            std::size_t node = memory::allocation_size(sizeof(void *) + sizeof(std::pair<const std::string, ColumnarArray>) + sizeof(std::size_t));
+            std::size_t key_heap = memory::string_heap_bytes(key);
+            // Aligned buffer plus the shared_ptr control block
+            std::size_t buffer = memory::allocation_size(array.buffer_bytes() + kArrayAlignment) + memory::allocation_size(sizeof(AlignedBuffer<double>) + 16);
+            entry.bytes = node + key_heap + buffer;
+            usage.table_bytes += node;
+            usage.key_bytes += key_heap;
+            usage.value_bytes += buffer;
+            TypeMemoryUsage &type = usage.types[entry.type];
+            ++type.count;
+            type.bytes += buffer;
+            usage.keys.push_back(std::move(entry));
+        }
+        usage.table_bytes += memory::allocation_size(arrays_.bucket_count() * sizeof(void *));
+        for (const auto &[key, value] : shared_)
+        {
+            // Each instance holding a shared value is charged its share of it
+            KeyMemoryUsage entry;
+            entry.key = key;
+            entry.type = value->type_name();
+            MemoryUsage walk;
+            std::size_t node = memory::allocation_size(sizeof(void *) + sizeof(std::pair<const std::string, std::shared_ptr<const nlohmann::json>>) + sizeof(std::size_t));
+            std::size_t key_heap = memory::string_heap_bytes(key);
+            std::size_t users = static_cast<std::size_t>(std::max(1L, value.use_count()));
+            // make_shared allocation: control block plus the json value
+            std::size_t heap = memory::allocation_size(sizeof(nlohmann::json) + 16) + memory::json_heap_bytes(*value, walk, entry.nodes);
+            std::size_t share = heap / users;
+            entry.bytes = node + key_heap + share;
+            usage.table_bytes += node;
+            usage.key_bytes += key_heap;
+            usage.value_bytes += share;
+            usage.json_nodes += entry.nodes;
+            TypeMemoryUsage &type = usage.types[entry.type];
+            ++type.count;
+            type.bytes += share;
+            usage.keys.push_back(std::move(entry));
+        }
+        usage.table_bytes += memory::allocation_size(shared_.bucket_count() * sizeof(void *));
+        std::set<const MappedDocument *> documents;
+        for (const auto &[key, lazy] : lazy_)
+        {
+            // Unread values cost only their slice record; read ones also own the parsed json
+            KeyMemoryUsage entry;
+            entry.key = key;
+            entry.type = lazy.value ? lazy.value->type_name() : "unparsed";
+            std::size_t node = memory::allocation_size(sizeof(void *) + sizeof(std::pair<const std::string, LazyValue>) + sizeof(std::size_t));
+            std::size_t key_heap = memory::string_heap_bytes(key);
+            std::size_t value_heap = lazy.value ? memory::json_heap_bytes(*lazy.value, usage, entry.nodes) : 0;
+            entry.bytes = node + key_heap + value_heap;
+            usage.table_bytes += node;
+            usage.key_bytes += key_heap;
+            usage.value_bytes += value_heap;
+            usage.json_nodes += entry.nodes;
+            usage.keys.push_back(std::move(entry));
+            // Mapped documents live in the page cache; documents that had to be read are heap memory
+            if (!lazy.document->is_mapped() && documents.insert(lazy.document.get()).second)
+            {
+                usage.other_bytes += memory::allocation_size(lazy.document->contents().size() + 1);
+            }
+        }
+        usage.table_bytes += memory::allocation_size(lazy_.bucket_count() * sizeof(void *));
+        // Red-black tree nodes: three pointers and a color word, then the entry
+        usage.table_bytes += key_index_.size() * memory::allocation_size(4 * sizeof(void *) + sizeof(std::pair<const std::string_view, IndexedKey>));
+        std::sort(usage.keys.begin(), usage.keys.end(), [](const KeyMemoryUsage &a, const KeyMemoryUsage &b) {
+            return a.bytes > b.bytes;
+        });
+        usage.other_bytes += memory::allocation_size(change_listeners_.capacity() * sizeof(change_listeners_[0]));
+        usage.other_bytes += memory::string_heap_bytes(version_);
+        for (const auto &[key, resident] : resident_)
+        {
+            usage.other_bytes += memory::allocation_size(sizeof(void *) + sizeof(std::pair<const std::string, ResidentValue>) + sizeof(std::size_t));
+            usage.other_bytes += memory::string_heap_bytes(key);
+        }
+        usage.other_bytes += memory::allocation_size(env_overrides_.bucket_count() * sizeof(void *));
+        for (const auto &[key, value] : env_overrides_)
         {
-            std::cerr << "Error in backup_to_file: " << e.what() << std::endl;
+            usage.other_bytes += memory::allocation_size(sizeof(void *) + sizeof(std::pair<const std::string, std::string>) + sizeof(std::size_t));
+            usage.other_bytes += memory::string_heap_bytes(key) + memory::string_heap_bytes(value);
         }
+        usage.total_bytes = usage.instance_bytes + usage.table_bytes + usage.key_bytes + usage.value_bytes + usage.other_bytes;
+        return usage;
     }
 
 } // namespace config
@@ -16,8 +16,13 @@
 
 #include "../include/configuration.hpp"
 #include "../include/format_manager.hpp"
+#include "../include/config_flags.hpp"
+#include "../include/config_async.hpp"
 #include <cassert>
 #include <iostream>
+#include <fstream>
+#include <thread>
+#include <condition_variable>
 #include <cstdlib>  // For setenv function
 #include <unistd.h> // For environ declaration
 #include <string.h> // For string operations
@@ -130,6 +135,9 @@ void test_configuration()
     config.clear();
     config.load_partial_from_file(partial_json_file_path, {"complex"});
     custom_assert(config.get("complex") == complex, "config.get('complex') == complex");
+    config.clear();
+    IoResult repeated = config.load_partial_from_file(partial_json_file_path, {"complex", "complex"});
+    custom_assert(repeated.keys == 1 && config.get("complex") == complex, "key listed twice loaded once");
     std::cout << "Test 12 passed: partial save and load (JSON)\n";
 
     // Test 13: Partial save and load (YAML)
@@ -138,6 +146,11 @@ void test_configuration()
     config.clear();
     config.load_partial_from_file(partial_yaml_file_path, {"complex"});
     custom_assert(config.get("complex") == complex, "config.get('complex') == complex");
+    IoResult saved_twice = config.save_partial_to_file(partial_yaml_file_path, {"complex", "complex"});
+    custom_assert(saved_twice.keys == 1, "key listed twice saved once");
+    config.clear();
+    IoResult loaded_twice = config.load_partial_from_file(partial_yaml_file_path, {"complex", "complex"});
+    custom_assert(loaded_twice.keys == 1 && config.get("complex") == complex, "key listed twice loaded once");
     std::cout << "Test 13 passed: partial save and load (YAML)\n";
 
     // Test 14: Output configuration in different formats
@@ -233,9 +246,1522 @@ void test_configfactory()
     std::cout << "Test 7 passed: pooled_config->get('key4') == 'value4'\n";
 }
 
+// Test function for the structured load/save results
+void test_io_results()
+{
+    std::cout << "Starting load/save result tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("io_results");
+    config.set("name", "example");
+    config.set("port", 8080);
+
+    // Test 1: Successful save and load report byte and key counts
+    IoResult saved = config.save_to_file("config_io_results.json");
+    custom_assert(saved.ok() && saved.keys == 2 && saved.bytes > 0, "saved.ok() && saved.keys == 2");
+    config.clear();
+    IoResult loaded = config.load_from_file("config_io_results.json");
+    custom_assert(loaded.ok() && loaded.bytes == saved.bytes, "loaded.ok() && loaded.bytes == saved.bytes");
+    custom_assert(loaded.keys == 3, "loaded.keys == 3"); // name, port and version
+    custom_assert(loaded.timings.total() >= loaded.timings.parse, "loaded.timings.total() >= loaded.timings.parse");
+    std::cout << "Test 1 passed: save and load report bytes, keys and phase timings\n";
+
+    // Test 2: Missing files are reported instead of swallowed
+    IoResult missing = config.load_from_file("config_io_missing.json");
+    custom_assert(missing.error == IoError::OPEN_FAILED && !missing, "missing.error == IoError::OPEN_FAILED");
+    std::cout << "Test 2 passed: missing file reported as OPEN_FAILED\n";
+
+    // Test 3: Parse errors carry their location
+    {
+        std::ofstream broken("config_io_broken.json");
+        broken << "{\n  \"name\": \"example\",\n  \"port\": ,\n}\n";
+    }
+    IoResult broken = config.load_from_file("config_io_broken.json");
+    custom_assert(broken.error == IoError::PARSE_FAILED, "broken.error == IoError::PARSE_FAILED");
+    custom_assert(broken.line == 3, "broken.line == 3");
+    std::cout << "Test 3 passed: parse error reported with line " << broken.line << ", column " << broken.column << "\n";
+
+    // Test 4: Unsupported formats are reported
+    IoResult unsupported = config.save_partial_to_file("config_io_results.txt", {"name"});
+    custom_assert(unsupported.error == IoError::UNSUPPORTED_FORMAT, "unsupported.error == IoError::UNSUPPORTED_FORMAT");
+    std::cout << "Test 4 passed: unsupported format reported\n";
+
+    // Test 5: Backups report their result too
+    IoResult backup = config.backup_to_file("config_io_results_backup.json");
+    custom_assert(backup.ok() && backup.bytes > 0 && backup.keys == 3, "backup.ok()");
+    IoResult unwritable = config.backup_to_file("config_io_missing_dir/backup.json");
+    custom_assert(unwritable.error == IoError::OPEN_FAILED, "unwritable.error == IoError::OPEN_FAILED");
+    std::cout << "Test 5 passed: backup reports its result\n";
+}
+
+void test_metrics()
+{
+    std::cout << "Starting runtime metrics tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("metrics");
+
+    // Test 1: Nothing is counted until metrics are enabled
+    config.set("name", "example");
+    custom_assert(!config.metrics_enabled() && config.stats().reads == 0, "!config.metrics_enabled() && config.stats().reads == 0");
+    std::cout << "Test 1 passed: metrics disabled by default\n";
+
+    // Test 2: Reads, misses, writes and listener calls are counted
+    config.enable_metrics();
+    config.add_change_listener([](const std::string &, const nlohmann::json &) {});
+    config.set("port", 8080);
+    config.get("name");
+    config.exists("missing");
+    try
+    {
+        config.get("missing");
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    ConfigStats stats = config.stats();
+    custom_assert(stats.reads == 3 && stats.misses == 2, "stats.reads == 3 && stats.misses == 2");
+    custom_assert(stats.writes == 1 && stats.listener_invocations == 1, "stats.writes == 1 && stats.listener_invocations == 1");
+    custom_assert(stats.lock_acquisitions >= 4, "stats.lock_acquisitions >= 4");
+    std::cout << "Test 2 passed: " << stats.to_json().dump() << "\n";
+
+    // Test 3: Counts from several threads are summed across shards
+    config.reset_stats();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&config] {
+            for (int i = 0; i < 100; ++i)
+            {
+                config.get("name");
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    custom_assert(config.stats().reads == 400, "config.stats().reads == 400");
+    std::cout << "Test 3 passed: per-thread counters summed\n";
+
+    // Test 4: Prometheus output carries the instance label
+    std::string text = config.stats_prometheus("metrics");
+    custom_assert(text.find("config_reads_total{instance=\"metrics\"} 400") != std::string::npos, "Prometheus reads counter");
+    std::cout << "Test 4 passed: Prometheus text output\n";
+
+    // Test 5: Disabling stops counting but keeps the last values
+    config.disable_metrics();
+    config.get("name");
+    custom_assert(config.stats().reads == 400, "config.stats().reads == 400 after disable");
+    std::cout << "Test 5 passed: metrics disabled\n";
+}
+
+void test_profiler()
+{
+    std::cout << "Starting hot-key profiler tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("profiler");
+    config.set("hot", 1);
+    config.set("warm", 2);
+    config.set("cold", 3);
+
+    // Test 1: Every call is recorded with sample_every = 1 and the hottest key ranks first
+    ProfilerOptions options;
+    options.sample_every = 1;
+    options.top_k = 2;
+    auto profiler = std::make_shared<ConfigProfiler>(options);
+    config.attach_profiler(profiler);
+    {
+        ConfigProfiler::TagScope tag("hot_loop");
+        for (int i = 0; i < 50; ++i)
+        {
+            config.get("hot");
+        }
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        config.get("warm");
+    }
+    config.get("cold");
+    config.set("hot", 4);
+    HotKeyReport report = profiler->report();
+    custom_assert(report.samples == 62 && report.keys.size() == 2, "report.samples == 62 && report.keys.size() == 2");
+    custom_assert(report.keys[0].key == "hot" && report.keys[0].gets == 50 && report.keys[0].sets == 1, "hot key ranked first");
+    custom_assert(report.keys[0].tag == "hot_loop" && report.keys[1].key == "warm", "hot key tagged");
+    std::cout << "Test 1 passed: " << report.keys[0].key << " ~" << report.keys[0].estimated_calls << " calls\n";
+
+    // Test 2: 1-in-N sampling scales the estimate back up
+    ProfilerOptions every_eighth;
+    every_eighth.sample_every = 8;
+    auto sampled = std::make_shared<ConfigProfiler>(every_eighth);
+    config.attach_profiler(sampled);
+    for (int i = 0; i < 800; ++i)
+    {
+        config.get("hot");
+    }
+    HotKeyReport sampled_report = sampled->report();
+    custom_assert(sampled_report.samples == 100 && sampled_report.keys[0].estimated_calls == 800, "sampled estimate == 800");
+    std::cout << "Test 2 passed: sampled 1 in " << sampled_report.sample_every << "\n";
+
+    // Test 3: Periodic reports are delivered on the background thread
+    std::mutex reports_mutex;
+    std::condition_variable reports_cv;
+    int reports = 0;
+    ProfilerOptions periodic;
+    periodic.sample_every = 1;
+    periodic.report_interval = std::chrono::milliseconds(5);
+    periodic.on_report = [&](const HotKeyReport &) {
+        std::lock_guard<std::mutex> lock(reports_mutex);
+        ++reports;
+        reports_cv.notify_all();
+    };
+    {
+        ConfigProfiler reporter(periodic);
+        std::unique_lock<std::mutex> lock(reports_mutex);
+        reports_cv.wait_for(lock, std::chrono::seconds(5), [&] { return reports > 0; });
+    }
+    custom_assert(reports > 0, "reports > 0");
+    std::cout << "Test 3 passed: periodic report delivered\n";
+
+    // Test 4: Profilers used from the same thread keep separate sampling countdowns
+    ProfilerOptions every_second;
+    every_second.sample_every = 2;
+    ProfilerOptions every_third;
+    every_third.sample_every = 3;
+    auto halves = std::make_shared<ConfigProfiler>(every_second);
+    auto thirds = std::make_shared<ConfigProfiler>(every_third);
+    Config first;
+    Config second;
+    first.set("key", 1);
+    second.set("key", 2);
+    first.attach_profiler(halves);
+    second.attach_profiler(thirds);
+    for (int i = 0; i < 600; ++i)
+    {
+        first.get("key");
+        second.get("key");
+    }
+    custom_assert(halves->report().samples == 300 && thirds->report().samples == 200, "per-instance sampling rates");
+    std::cout << "Test 4 passed: per-instance sampling\n";
+
+    // Test 5: A full counter table replaces its least counted key
+    ProfilerOptions small;
+    small.sample_every = 1;
+    small.top_k = 1;
+    small.counters = 2;
+    ConfigProfiler counting(small);
+    auto feed = [&counting](const std::string &key, int times) {
+        for (int i = 0; i < times; ++i)
+        {
+            counting.record(ProfiledOp::GET, key, std::chrono::nanoseconds(1));
+        }
+    };
+    feed("a", 5);
+    feed("b", 1);
+    feed("c", 1); // Replaces b: 2, error 1
+    feed("d", 1); // Replaces c: 3, error 2
+    custom_assert(counting.report().keys[0].key == "a", "a ranks first");
+    feed("e", 3); // Replaces d: 4, then 6
+    HotKeyReport replaced = counting.report();
+    custom_assert(replaced.keys[0].key == "e" && replaced.keys[0].samples == 6 && replaced.keys[0].error == 3, "minimum replaced");
+    std::cout << "Test 5 passed: space-saving replacement\n";
+
+    config.detach_profiler();
+    custom_assert(config.profiler() == nullptr, "config.profiler() == nullptr");
+}
+
+void test_tracing()
+{
+    std::cout << "Starting trace output tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("tracing");
+    config.add_change_listener([](const std::string &, const nlohmann::json &) {});
+
+    // Test 1: Nothing is recorded while tracing is off
+    config.set("name", "example");
+    custom_assert(ConfigTracer::global().events().empty(), "ConfigTracer::global().events().empty()");
+    std::cout << "Test 1 passed: tracing disabled by default\n";
+
+    // Test 2: Loads, saves and listener calls become complete events
+    TraceOptions options;
+    options.file_path = "config_trace.json";
+    ConfigTracer::global().start(options);
+    config.save_to_file("config_tracing.json");
+    config.load_from_file("config_tracing.json");
+    config.set("name", "traced");
+    std::vector<TraceEvent> events = ConfigTracer::global().events();
+    custom_assert(events.size() == 3, "events.size() == 3");
+    custom_assert(events[0].name == "save_to_file" && events[1].name == "load_from_file", "save and load traced");
+    custom_assert(events[1].args["keys"] == 2 && events[1].args["error"] == "none", "load arguments recorded");
+    custom_assert(events[2].name == "listener" && events[2].args["key"] == "name", "listener traced");
+    std::cout << "Test 2 passed: " << events.size() << " events recorded\n";
+
+    // Test 3: stop() writes Chrome trace-event JSON
+    custom_assert(ConfigTracer::global().stop(), "ConfigTracer::global().stop()");
+    std::ifstream trace_file("config_trace.json");
+    nlohmann::json trace = nlohmann::json::parse(trace_file);
+    custom_assert(trace["traceEvents"].size() == 3 && trace["traceEvents"][0]["ph"] == "X", "trace file written");
+    std::cout << "Test 3 passed: trace written to config_trace.json\n";
+
+    // Test 4: The ring buffer keeps the newest events
+    ConfigTracer::global().start(TraceOptions{"", 2});
+    for (int i = 0; i < 3; ++i)
+    {
+        config.set("name", i);
+    }
+    ConfigTracer::global().stop();
+    custom_assert(ConfigTracer::global().events().size() == 2 && ConfigTracer::global().dropped() == 1, "ring buffer wraps");
+    std::cout << "Test 4 passed: ring buffer keeps the newest events\n";
+}
+
+void test_memory_usage()
+{
+    std::cout << "Starting memory accounting tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("memory");
+    config.set("small", 1);
+    config.set("large", std::string(4096, 'x'));
+    config.set("nested", {{"servers", {"alpha", "beta", "gamma"}}, {"port", 8080}});
+
+    // Test 1: The largest key ranks first and covers its string allocation
+    MemoryUsage usage = config.memory_usage();
+    custom_assert(usage.keys.size() == 3 && usage.keys[0].key == "large", "usage.keys[0].key == large");
+    custom_assert(usage.keys[0].bytes > 4096, "usage.keys[0].bytes > 4096");
+    std::cout << "Test 1 passed: largest key " << usage.keys[0].key << " uses " << usage.keys[0].bytes << " bytes\n";
+
+    // Test 2: Totals add up and nested values are counted per type
+    custom_assert(usage.total_bytes == usage.instance_bytes + usage.table_bytes + usage.key_bytes + usage.value_bytes + usage.other_bytes,
+                  "total_bytes adds up");
+    custom_assert(usage.json_nodes == 8, "usage.json_nodes == 8");
+    custom_assert(usage.types["string"].count == 4 && usage.types["object"].count == 1 && usage.types["array"].count == 1, "types counted");
+    std::cout << "Test 2 passed: " << usage.json_nodes << " json nodes, " << usage.total_bytes << " bytes\n";
+
+    // Test 3: The registry report covers named instances
+    std::vector<std::string> names = Config::instance_names();
+    custom_assert(std::find(names.begin(), names.end(), "memory") != names.end(), "instance_names() contains memory");
+    RegistryMemoryUsage registry = Config::registry_memory_usage();
+    custom_assert(registry.instances.size() == names.size() && registry.total_bytes >= usage.total_bytes, "registry report");
+    std::cout << "Test 3 passed: " << registry.instances.size() << " instances, " << registry.total_bytes << " bytes\n";
+}
+
+void test_workload_replay()
+{
+    std::cout << "Starting workload record and replay tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("workload");
+    config.set("name", "example");
+    config.save_to_file("config_workload.json");
+
+    // Test 1: get, set and load calls are recorded with their sizes
+    auto recorder = std::make_shared<WorkloadRecorder>("config_workload.bin");
+    custom_assert(recorder->is_open(), "recorder->is_open()");
+    config.attach_recorder(recorder);
+    config.get("name");
+    config.set("port", 8080);
+    try
+    {
+        config.get("missing");
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    config.load_from_file("config_workload.json");
+    config.detach_recorder();
+    config.get("name"); // Not recorded
+    custom_assert(recorder->records() == 4, "recorder->records() == 4");
+    std::cout << "Test 1 passed: " << recorder->records() << " calls recorded\n";
+
+    // Test 2: The recording decodes back to the same calls
+    std::vector<WorkloadOp> ops;
+    custom_assert(read_workload("config_workload.bin", ops) && ops.size() == 4, "read_workload() returns 4 ops");
+    custom_assert(ops[0].type == WorkloadOpType::GET && ops[0].key == "name" && ops[0].size == 7, "get recorded");
+    custom_assert(ops[1].type == WorkloadOpType::SET && ops[1].size == 4, "set recorded");
+    custom_assert(ops[2].miss && ops[3].type == WorkloadOpType::LOAD && ops[3].size > 0, "miss and load recorded");
+    custom_assert(ops[3].timestamp_ns >= ops[0].timestamp_ns, "timestamps ordered");
+    std::vector<WorkloadOp> none;
+    std::string error;
+    custom_assert(!read_workload("config_workload.json", none, &error) && error.find("Not a workload recording") == 0, "reason returned");
+    std::cout << "Test 2 passed: recording decoded\n";
+
+    // Test 3: Replay against a fresh storage reproduces hits and misses
+    Config replayed;
+    ReplayResult result = replay_workload(ops, replayed);
+    custom_assert(result.ops == 4 && result.gets == 2 && result.misses == 1, "replay ops and misses");
+    custom_assert(replayed.get("name").get<std::string>().size() == 7, "replayed.get(name) has the recorded size");
+    std::cout << "Test 3 passed: replayed " << result.ops << " ops\n";
+
+    // Test 4: Per-thread buffers keep every call and each thread's order
+    {
+        WorkloadRecorder threaded("config_workload.bin", 256);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&threaded, t]() {
+                for (int i = 0; i < 500; ++i)
+                {
+                    threaded.record(WorkloadOpType::SET, "thread" + std::to_string(t), static_cast<std::uint64_t>(i));
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        threaded.flush();
+        custom_assert(threaded.records() == 2000, "threaded.records() == 2000");
+    }
+    ops.clear();
+    custom_assert(read_workload("config_workload.bin", ops) && ops.size() == 2000, "read_workload() returns 2000 ops");
+    std::unordered_map<std::string, std::uint64_t> next_size;
+    bool ordered = std::is_sorted(ops.begin(), ops.end(), [](const WorkloadOp &a, const WorkloadOp &b) { return a.timestamp_ns < b.timestamp_ns; });
+    for (const auto &op : ops)
+    {
+        ordered = ordered && op.size == next_size[op.key]++;
+    }
+    custom_assert(ordered, "ops sorted by time and in per-thread order");
+    custom_assert(workload::value_size(nlohmann::json{{"a", 1}, {"b", {true, nullptr, "x"}}}) == nlohmann::json{{"a", 1}, {"b", {true, nullptr, "x"}}}.dump().size(), "value_size() matches the compact JSON length");
+    std::cout << "Test 4 passed: " << ops.size() << " calls from 4 threads decoded in order\n";
+}
+
+struct CountingParser
+{
+    static int calls;
+    int operator()(const nlohmann::json &value) const
+    {
+        ++calls;
+        return std::stoi(value.get<std::string>());
+    }
+};
+int CountingParser::calls = 0;
+
+void test_typed_reads()
+{
+    std::cout << "Starting typed read tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("typed");
+    config.set("timeout", "250ms");
+    config.set("interval", "1h30m");
+    config.set("retry_delay", 1500);
+    config.set("cache_size", "64MiB");
+    config.set("disk_quota", "1.5GB");
+    config.set("workers", "8");
+
+    // Test 1: Durations and byte sizes are parsed
+    custom_assert(config.get_duration("timeout") == std::chrono::milliseconds(250), "get_duration(timeout) == 250ms");
+    custom_assert(config.get_duration("interval") == std::chrono::minutes(90), "get_duration(interval) == 90min");
+    custom_assert(config.get_duration("retry_delay") == std::chrono::milliseconds(1500), "get_duration(retry_delay) == 1500ms");
+    custom_assert(config.get_bytes("cache_size") == 64ull * 1024 * 1024, "get_bytes(cache_size) == 64MiB");
+    custom_assert(config.get_bytes("disk_quota") == 1500000000ull, "get_bytes(disk_quota) == 1.5GB");
+    std::cout << "Test 1 passed: durations and byte sizes parsed\n";
+
+    // Test 2: The parser runs once until the key is written again
+    CountingParser::calls = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        custom_assert(config.get_as<int, CountingParser>("workers") == 8, "get_as<int, CountingParser>(workers) == 8");
+    }
+    custom_assert(CountingParser::calls == 1, "CountingParser::calls == 1");
+    config.set("workers", "16");
+    custom_assert(config.get_as<int, CountingParser>("workers") == 16 && CountingParser::calls == 2, "cache invalidated on set");
+    std::cout << "Test 2 passed: converted value cached until set\n";
+
+    // Test 3: Malformed values and missing keys throw
+    config.set("timeout", "soon");
+    bool threw = false;
+    try
+    {
+        config.get_duration("timeout");
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    custom_assert(threw, "get_duration(soon) throws");
+    threw = false;
+    try
+    {
+        config.get_bytes("missing");
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    custom_assert(threw, "get_bytes(missing) throws");
+    std::cout << "Test 3 passed: conversion errors reported\n";
+
+    // Test 4: Large byte sizes are exact and overflow throws
+    custom_assert(parse_byte_size("9007199254740993") == 9007199254740993ull, "integers above 2^53 exact");
+    custom_assert(parse_byte_size("18446744073709551615") == std::numeric_limits<std::uint64_t>::max(), "largest byte size");
+    custom_assert(parse_byte_size(".5K") == 512 && parse_byte_size("1.5GiB") == 1610612736ull, "fractions scaled");
+    for (const char *huge : {"18446744073709551616", "16777216TiB", "18446744073709551615.5"})
+    {
+        bool overflow = false;
+        try
+        {
+            parse_byte_size(huge);
+        }
+        catch (const std::out_of_range &)
+        {
+            overflow = true;
+        }
+        custom_assert(overflow, "overflowing byte size throws");
+    }
+    std::cout << "Test 4 passed: byte sizes exact up to 2^64 - 1\n";
+}
+
+void test_columnar_arrays()
+{
+    std::cout << "Starting columnar array tests\n";
+
+    using namespace config;
+
+    Config &config = Config::instance("columnar");
+
+    // Test 1: Views share the stored, aligned buffer
+    std::vector<double> rates(1000);
+    for (std::size_t i = 0; i < rates.size(); ++i)
+    {
+        rates[i] = static_cast<double>(i) * 0.5;
+    }
+    config.set_array("rates", rates);
+    ArrayView<double> first = config.get_array<double>("rates");
+    ArrayView<double> second = config.get_array<double>("rates");
+    custom_assert(first.data() == second.data() && first.size() == 1000 && first[10] == 5.0, "views share the buffer");
+    custom_assert(reinterpret_cast<std::uintptr_t>(first.data()) % kArrayAlignment == 0, "buffer is 64-byte aligned");
+    std::cout << "Test 1 passed: zero-copy aligned view\n";
+
+    // Test 2: Columnar keys still behave like json arrays elsewhere
+    custom_assert(config.exists("rates") && config.get("rates").size() == 1000 && config.get("rates")[10] == 5.0, "get() converts");
+    custom_assert(config.get_all().count("rates") == 1, "get_all() includes rates");
+    config.save_to_file("config_columnar.json");
+    Config reloaded;
+    reloaded.load_from_file("config_columnar.json");
+    custom_assert(reloaded.get("rates").size() == 1000, "saved and reloaded");
+    std::cout << "Test 2 passed: json view preserved\n";
+
+    // Test 3: Views outlive overwrites; set() replaces the columnar value
+    config.set("rates", "disabled");
+    custom_assert(!config.is_columnar("rates") && first.size() == 1000 && first[999] == 499.5, "view outlives overwrite");
+    std::cout << "Test 3 passed: view kept alive after overwrite\n";
+
+    // Test 4: Large numeric json arrays are promoted automatically, including on load
+    reloaded.set_array_promotion_threshold(100);
+    reloaded.load_from_file("config_columnar.json");
+    reloaded.set("small", {1, 2, 3});
+    reloaded.set("ids", nlohmann::json(std::vector<int>(200, 7)));
+    custom_assert(reloaded.is_columnar("rates") && !reloaded.is_columnar("small") && reloaded.is_columnar("ids"), "promotion threshold");
+    custom_assert(reloaded.get_array<std::int64_t>("ids")[199] == 7, "int64 promotion");
+    custom_assert(reloaded.get_array<double>("small").size() == 3, "get_array converts plain json arrays");
+    std::cout << "Test 4 passed: arrays promoted at the threshold\n";
+
+    // Test 5: Only lossless arrays are promoted, and doubles are never truncated to integers
+    nlohmann::json mixed = nlohmann::json::array();
+    nlohmann::json large = nlohmann::json::array();
+    for (int i = 0; i < 200; ++i)
+    {
+        mixed.push_back(i % 2 ? nlohmann::json(i + 0.5) : nlohmann::json(i));
+        large.push_back(std::numeric_limits<std::uint64_t>::max() - static_cast<std::uint64_t>(i));
+    }
+    reloaded.set("mixed", mixed);
+    reloaded.set("large", large);
+    custom_assert(!reloaded.is_columnar("mixed") && reloaded.get("mixed").dump() == mixed.dump(), "mixed array kept as json");
+    custom_assert(!reloaded.is_columnar("large") && reloaded.get("large") == large, "large unsigned integers kept exact");
+    custom_assert(reloaded.get_array<double>("mixed")[1] == 1.5, "mixed array readable as double");
+    int rejected = 0;
+    for (const char *key : {"rates", "mixed"})
+    {
+        try
+        {
+            reloaded.get_array<std::int64_t>(key);
+        }
+        catch (const std::invalid_argument &)
+        {
+            ++rejected;
+        }
+    }
+    custom_assert(rejected == 2, "doubles not read as int64");
+    std::cout << "Test 5 passed: promotion is lossless\n";
+}
+
+void test_query()
+{
+    std::cout << "Starting query tests\n";
+
+    using namespace config;
+
+    Config config;
+    config.set("routes", nlohmann::json::parse(R"([
+        {"name": "api", "backends": [{"host": "a", "port": 80}, {"host": "b", "port": 81}]},
+        {"name": "web", "backends": [{"host": "c", "port": 8080}]}
+    ])"));
+    config.set("db", {{"primary", {{"port", 5432}}}, {"a/b", 1}});
+
+    // Test 1: JSON Pointer and JSONPath select the same nodes
+    custom_assert(config.query("/routes/0/backends/1/port") == std::vector<nlohmann::json>{81}, "JSON Pointer");
+    custom_assert(config.query("$.routes[0].backends[1].port") == std::vector<nlohmann::json>{81}, "JSONPath");
+    custom_assert(config.query("/db/a~1b") == std::vector<nlohmann::json>{1}, "escaped pointer token");
+    custom_assert(config.query("$.routes[-1]['name']") == std::vector<nlohmann::json>{"web"}, "negative index and quoted name");
+    custom_assert(config.query("/routes/7").empty() && config.query("/missing/x").empty(), "no match is empty");
+    std::cout << "Test 1 passed: pointer and path queries\n";
+
+    // Test 2: Wildcards and recursive descent
+    custom_assert(config.query("$.routes[*].name") == std::vector<nlohmann::json>({"api", "web"}), "wildcard");
+    custom_assert(config.query("$.routes..port").size() == 3, "descent below a key");
+    custom_assert(config.query("$..port").size() == 4, "descent across keys");
+    std::cout << "Test 2 passed: wildcard and descent\n";
+
+    // Test 3: Cached locations follow writes to the queried key
+    CompiledQuery ports("$.routes[*].backends[*].port");
+    std::size_t visited = 0;
+    config.query_each(ports, [&visited](const nlohmann::json &) { ++visited; });
+    custom_assert(visited == 3, "query_each visits every match");
+    config.set("routes", nlohmann::json::parse(R"([{"backends": [{"port": 9000}]}])"));
+    custom_assert(config.query(ports) == std::vector<nlohmann::json>{9000}, "cache invalidated by set");
+    config.set("other", 1);
+    custom_assert(config.query("$..port").size() == 2, "global query sees new generation");
+    config.remove("routes");
+    custom_assert(config.query(ports).empty(), "cache invalidated by remove");
+    std::cout << "Test 3 passed: cache invalidated on write\n";
+
+    // Test 4: Columnar arrays and malformed queries
+    config.set_array("weights", std::vector<double>{0.25, 0.5});
+    custom_assert(config.query("/weights/1") == std::vector<nlohmann::json>{0.5}, "columnar array query");
+    bool threw = false;
+    try
+    {
+        CompiledQuery bad("$.routes[abc]");
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    custom_assert(threw, "malformed query throws");
+    std::cout << "Test 4 passed: columnar arrays and errors\n";
+
+    // Test 5: $.* and $.. queries over arrays, shared and lazy values are cached per generation
+    config.enable_interning();
+    config.set("pools", {{"a", {{"port", 1}}}});
+    {
+        std::ofstream file("config_query.json");
+        file << R"({"lazy": {"port": 2}})";
+    }
+    config.set_lazy_loading(true);
+    config.load_from_file("config_query.json");
+    custom_assert(config.query("$..port").size() == 3 && config.query("$.weights[*]").size() == 2, "side maps resolved");
+    std::vector<const nlohmann::json *> first;
+    std::vector<const nlohmann::json *> second;
+    config.query_each(CompiledQuery("$.*"), [&first](const nlohmann::json &node) { first.push_back(&node); });
+    config.query_each(CompiledQuery("$.*"), [&second](const nlohmann::json &node) { second.push_back(&node); });
+    custom_assert(first.size() == 5 && first == second, "unanchored query cached");
+    config.set_array("weights", std::vector<double>{1.0});
+    custom_assert(config.query("$.weights[*]") == std::vector<nlohmann::json>{1.0}, "cache follows array writes");
+    bool range = false;
+    try
+    {
+        CompiledQuery huge("$.routes[99999999999999999999]");
+    }
+    catch (const std::invalid_argument &)
+    {
+        range = true;
+    }
+    custom_assert(range && config.query("/weights/99999999999999999999").empty(), "oversized indexes");
+    std::cout << "Test 5 passed: unanchored queries cached\n";
+}
+
+void test_key_index()
+{
+    std::cout << "Starting key index tests\n";
+
+    using namespace config;
+
+    Config config;
+    config.set("db.host", "localhost");
+    config.set("db.port", 5432);
+    config.set("cache.size", "64MiB");
+
+    // Test 1: Prefix scans return sorted keys
+    custom_assert(config.keys_with_prefix("db.") == std::vector<std::string>({"db.host", "db.port"}), "prefix scan");
+    custom_assert(config.keys_with_prefix("queue.").empty(), "empty prefix scan");
+    std::cout << "Test 1 passed: keys by prefix\n";
+
+    // Test 2: The index follows writes made after it was built, including columnar keys
+    config.set("db.pool", 8);
+    config.remove("db.host");
+    config.set_array("db.weights", std::vector<double>{1.0, 2.0});
+    config.set("cache.size", "128MiB");
+    custom_assert(config.keys_with_prefix("db.") == std::vector<std::string>({"db.pool", "db.port", "db.weights"}), "index maintained");
+    std::cout << "Test 2 passed: index kept in sync\n";
+
+    // Test 3: Half-open range scans see current values
+    std::vector<std::string> keys;
+    nlohmann::json values = nlohmann::json::array();
+    config.for_each_in_range("cache.", "db.port", [&](const std::string &key, const nlohmann::json &value) {
+        keys.push_back(key);
+        values.push_back(value);
+    });
+    custom_assert(keys == std::vector<std::string>({"cache.size", "db.pool"}) && values[0] == "128MiB", "range scan");
+    std::size_t tail = 0;
+    config.for_each_in_range("db.w", "", [&tail](const std::string &, const nlohmann::json &value) { tail += value.size(); });
+    custom_assert(tail == 2, "open-ended range includes columnar key");
+    config.clear();
+    config.set("db.host", "db2");
+    custom_assert(config.keys_with_prefix("") == std::vector<std::string>({"db.host"}), "index cleared");
+    std::cout << "Test 3 passed: range scans\n";
+}
+
+void test_find_keys()
+{
+    std::cout << "Starting key search tests\n";
+
+    using namespace config;
+
+    Config config;
+    for (const char *key : {"db.primary.port", "db.replica.port", "db.replica.host", "cache.a1", "cache.b2", "cache.c3", "queue*"})
+    {
+        config.set(key, 1);
+    }
+
+    // Test 1: Globs match whole keys
+    custom_assert(config.find_keys("db.*.port") == std::vector<std::string>({"db.primary.port", "db.replica.port"}), "star glob");
+    custom_assert(config.find_keys("cache.[ab]?") == std::vector<std::string>({"cache.a1", "cache.b2"}), "set glob");
+    custom_assert(config.find_keys("cache.[!ab]*") == std::vector<std::string>({"cache.c3"}), "negated set glob");
+    custom_assert(config.find_keys("queue\\*") == std::vector<std::string>({"queue*"}) && config.find_keys("db").empty(), "escape and whole-key match");
+    custom_assert(KeyMatcher::glob("db.*.port").literal_prefix() == "db.", "glob literal prefix");
+    std::cout << "Test 1 passed: glob matching\n";
+
+    // Test 2: Regexes search, and anchored literals become a prefix
+    KeyMatcher replica = KeyMatcher::regex("^db\\.replica\\.");
+    custom_assert(replica.literal_prefix() == "db.replica.", "regex literal prefix");
+    custom_assert(config.find_keys(replica) == std::vector<std::string>({"db.replica.host", "db.replica.port"}), "anchored regex");
+    custom_assert(config.find_keys(KeyMatcher::regex("port$")).size() == 2, "unanchored regex");
+    custom_assert(KeyMatcher::regex("^dbx?").literal_prefix() == "db", "optional character dropped from prefix");
+    KeyMatcher upper = KeyMatcher::regex("^DB\\.PRIMARY", std::regex::icase);
+    custom_assert(upper.literal_prefix().empty() && config.find_keys(upper) == std::vector<std::string>({"db.primary.port"}), "icase disables the prefix");
+    std::cout << "Test 2 passed: regex matching\n";
+
+    // Test 3: Parallel scans return the same sorted keys
+    Config large;
+    for (int i = 0; i < 2000; ++i)
+    {
+        large.set("svc" + std::to_string(i % 10) + ".key" + std::to_string(i), i);
+    }
+    FindOptions parallel;
+    parallel.parallel_threshold = 100;
+    parallel.threads = 4;
+    KeyMatcher sevens = KeyMatcher::glob("*7");
+    std::vector<std::string> serial_keys = large.find_keys(sevens);
+    custom_assert(serial_keys.size() == 200 && large.find_keys(sevens, parallel) == serial_keys, "parallel scan");
+    custom_assert(std::is_sorted(serial_keys.begin(), serial_keys.end()), "sorted result");
+    std::cout << "Test 3 passed: parallel scan\n";
+}
+
+void test_interpolation()
+{
+    std::cout << "Starting interpolation tests\n";
+
+    using namespace config;
+
+    Config config;
+    config.set("db_host", "db.internal");
+    config.set("db_port", 5432);
+    config.set("db_url", "postgres://${db_host}:${db_port}/app");
+    config.set("port_copy", "${db_port}");
+    config.set("service", {{"url", "${db_url}"}, {"backup", "${db_host}-backup"}, {"price", "$${literal}"}});
+    config.set("unrelated", "${db_host}");
+
+    // Test 1: References expand recursively; a lone reference keeps its type
+    custom_assert(config.get_interpolated("db_url") == "postgres://db.internal:5432/app", "string splice");
+    custom_assert(config.get_interpolated("port_copy") == 5432, "typed reference");
+    nlohmann::json service = config.get_interpolated("service");
+    custom_assert(service["url"] == "postgres://db.internal:5432/app" && service["backup"] == "db.internal-backup", "nested expansion");
+    custom_assert(service["price"] == "${literal}" && config.get("db_url") == "postgres://${db_host}:${db_port}/app", "escape and raw value");
+    std::cout << "Test 1 passed: references expanded\n";
+
+    // Test 2: A write invalidates only the results that depend on it
+    config.get_interpolated("unrelated");
+    config.set("db_port", 6432);
+    custom_assert(config.get_interpolated("service")["url"] == "postgres://db.internal:6432/app", "transitive invalidation");
+    custom_assert(config.get_interpolated("port_copy") == 6432, "direct invalidation");
+    config.set("db_host", "db2");
+    custom_assert(config.get_interpolated("unrelated") == "db2" && config.get_interpolated("db_url") == "postgres://db2:6432/app", "host change");
+    std::cout << "Test 2 passed: dependents invalidated\n";
+
+    // Test 3: Cycles, unknown keys and environment references
+    config.set("a", "${b}");
+    config.set("b", "x${a}");
+    config.set("missing", "${nope}");
+    config.set("home", "${env:CONFIG_INTERPOLATION_TEST}");
+    auto throws = [&config](const std::string &key) {
+        try
+        {
+            config.get_interpolated(key);
+        }
+        catch (const std::invalid_argument &)
+        {
+            return true;
+        }
+        return false;
+    };
+    custom_assert(throws("a") && throws("missing") && throws("home"), "errors reported");
+    setenv("CONFIG_INTERPOLATION_TEST", "/srv", 1);
+    InterpolationOptions options;
+    options.allow_env = true;
+    config.set_interpolation_options(options);
+    custom_assert(config.get_interpolated("home") == "/srv", "environment reference");
+    config.set("b", "fixed");
+    custom_assert(config.get_interpolated("a") == "fixed", "cycle broken");
+    std::cout << "Test 3 passed: cycles and environment\n";
+}
+
+void test_derived_keys()
+{
+    std::cout << "Starting derived key tests\n";
+
+    using namespace config;
+
+    Config config;
+    config.set("cores", 4);
+    config.set("per_core", 8);
+    int pool_computations = 0;
+    int limit_computations = 0;
+    config.define_derived("pool_size", {"cores", "per_core"}, [&pool_computations](const DerivedInputs &in) {
+        ++pool_computations;
+        return in["cores"].get<int>() * in["per_core"].get<int>();
+    });
+    config.define_derived("queue_limit", {"pool_size"}, [&limit_computations](const DerivedInputs &in) {
+        ++limit_computations;
+        return in[0].get<int>() * 10;
+    });
+    config.set("unrelated", 1);
+
+    // Test 1: Derived values are stored like ordinary entries
+    custom_assert(config.get("pool_size") == 32 && config.get("queue_limit") == 320, "initial values");
+    custom_assert(pool_computations == 1 && limit_computations == 1 && config.is_derived("pool_size"), "computed once");
+    std::cout << "Test 1 passed: derived values computed\n";
+
+    // Test 2: Only changed inputs trigger recomputation, in topological order
+    std::vector<std::string> notified;
+    config.add_change_listener([&notified](const std::string &key, const nlohmann::json &) { notified.push_back(key); });
+    config.set("cores", 8);
+    custom_assert(config.get("queue_limit") == 640, "chain recomputed");
+    custom_assert(notified == std::vector<std::string>({"cores", "pool_size", "queue_limit"}), "topological order");
+    config.set("cores", 8);
+    custom_assert(pool_computations == 2 && limit_computations == 2, "unchanged input skips recomputation");
+    config.set("per_core", 0);
+    config.set("cores", 4);
+    custom_assert(pool_computations == 4 && limit_computations == 3, "unchanged result stops propagation");
+    config.set("cores", 8);
+    config.set("per_core", 8);
+    config.set("unrelated", 2);
+    custom_assert(pool_computations == 6, "unrelated key ignored");
+    std::cout << "Test 2 passed: incremental recomputation\n";
+
+    // Test 3: Cycles, direct writes and missing inputs
+    bool cycle = false;
+    try
+    {
+        config.define_derived("cores", {"queue_limit"}, [](const DerivedInputs &in) { return in[0]; });
+    }
+    catch (const std::invalid_argument &)
+    {
+        cycle = true;
+    }
+    custom_assert(cycle && !config.is_derived("cores"), "cycle rejected");
+    bool direct = false;
+    try
+    {
+        config.set("pool_size", 1);
+    }
+    catch (const std::invalid_argument &)
+    {
+        direct = true;
+    }
+    custom_assert(direct, "derived keys are read-only");
+    config.remove("per_core");
+    custom_assert(!config.exists("pool_size") && !config.exists("queue_limit"), "removed with an input");
+    config.set("per_core", 2);
+    custom_assert(config.get("queue_limit") == 160, "restored when the input returns");
+    std::cout << "Test 3 passed: cycles and missing inputs\n";
+
+    // Test 4: An unchanged load recomputes nothing; loads, the environment and set_array never write derived keys
+    int computations = pool_computations;
+    {
+        std::ofstream file("config_derived.json");
+        file << R"({"cores": 8, "per_core": 2, "pool_size": 999})";
+    }
+    IoResult loaded = config.load_from_file("config_derived.json");
+    custom_assert(loaded && loaded.keys == 2, "derived key skipped on load");
+    custom_assert(config.get("pool_size") == 16 && pool_computations == computations, "unchanged load skips recomputation");
+    setenv("pool_size", "999", 1);
+    config.load_from_env();
+    unsetenv("pool_size");
+    custom_assert(config.get("pool_size") == 16, "derived key skipped from the environment");
+    bool array = false;
+    try
+    {
+        config.set_array("pool_size", std::vector<std::int64_t>{1, 2});
+    }
+    catch (const std::invalid_argument &)
+    {
+        array = true;
+    }
+    custom_assert(array && config.get("pool_size") == 16, "set_array rejects derived keys");
+    std::cout << "Test 4 passed: derived keys only written by their function\n";
+
+    // Test 5: A throwing function keeps the old value and leaves its error for the caller
+    config.define_derived("per_worker", {"pool_size", "workers"}, [](const DerivedInputs &in) {
+        if (in["workers"].get<int>() == 0)
+        {
+            throw std::domain_error("no workers");
+        }
+        return in["pool_size"].get<int>() / in["workers"].get<int>();
+    });
+    config.set("workers", 4);
+    custom_assert(config.get("per_worker") == 4 && config.derived_error("per_worker").empty(), "computed without error");
+    config.set("workers", 0);
+    custom_assert(config.get("per_worker") == 4 && config.derived_error("per_worker") == "no workers", "error kept, value kept");
+    config.set("workers", 2);
+    custom_assert(config.get("per_worker") == 8 && config.derived_error("per_worker").empty(), "error cleared on success");
+    std::cout << "Test 5 passed: derive errors surfaced\n";
+}
+
+void test_feature_flags()
+{
+    std::cout << "Starting feature flag tests\n";
+
+    using namespace config;
+
+    Config config;
+    config.set("feature_flags", nlohmann::json::parse(R"({
+        "feature_x": true,
+        "killed": {"enabled": false},
+        "checkout_v2": {
+            "rules": [
+                {"attribute": "tenant", "in": ["acme"], "serve": true},
+                {"attribute": "country", "in": ["DE"], "serve": false}
+            ],
+            "rollout": 25
+        }
+    })"));
+    auto flags = FeatureFlags::bind(config);
+    FlagHandle checkout = flags->handle("checkout_v2");
+
+    // Test 1: Booleans, kill switches and targeting rules
+    FlagAttribute acme[] = {{"tenant", "acme"}, {"country", "DE"}};
+    FlagAttribute german[] = {{"tenant", "initech"}, {"country", "DE"}};
+    custom_assert(flags->enabled("feature_x") && !flags->enabled("killed") && !flags->enabled("unknown"), "plain flags");
+    custom_assert(flags->enabled(checkout, FlagContext("user-1", acme)), "first matching rule serves true");
+    custom_assert(!flags->enabled(checkout, FlagContext("user-1", german)), "second rule serves false");
+    std::cout << "Test 1 passed: rules evaluated\n";
+
+    // Test 2: Rollouts are consistent per entity and close to the percentage
+    int on = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        std::string id = "user-" + std::to_string(i);
+        bool first = flags->enabled(checkout, FlagContext(id));
+        custom_assert(first == flags->enabled("checkout_v2", FlagContext(id)), "handle and name agree");
+        on += first ? 1 : 0;
+    }
+    custom_assert(on > 2300 && on < 2700, "25% rollout");
+    std::cout << "Test 2 passed: rollout of " << on << " / 10000\n";
+
+    // Test 3: Setting the backing key swaps the flag set; bad definitions keep the old one
+    config.set("feature_flags", {{"checkout_v2", true}});
+    custom_assert(flags->enabled(checkout, FlagContext("user-1", german)) && !flags->enabled("feature_x"), "rebuilt on set");
+    config.set("feature_flags", {{"checkout_v2", {{"rollout", 400}}}});
+    custom_assert(flags->enabled(checkout, FlagContext("user-1")), "malformed definitions rejected");
+    auto env = ConfigFactory::create_env_config("flags_production", "production");
+    custom_assert(!FeatureFlags::bind(*env)->enabled("feature_x"), "environment flags");
+    std::cout << "Test 3 passed: rebuilt atomically\n";
+
+    // Test 4: Loads, clear and remove rebuild the set; replaced sets are released
+    {
+        std::ofstream file("config_flags.json");
+        file << R"({"feature_flags": {"feature_x": true, "loaded": true}})";
+    }
+    std::weak_ptr<const FlagSet> replaced = flags->snapshot();
+    config.load_from_file("config_flags.json");
+    custom_assert(flags->enabled("loaded") && flags->enabled(checkout, FlagContext("user-1")) == false, "rebuilt after load");
+    config.remove("feature_flags");
+    custom_assert(!flags->enabled("loaded") && flags->flag_count() == 0, "rebuilt after remove");
+    config.load_from_file("config_flags.json");
+    config.clear();
+    custom_assert(!flags->enabled("feature_x"), "rebuilt after clear");
+    for (int i = 0; i < 1000; ++i)
+    {
+        config.set("feature_flags", {{"flag_" + std::to_string(i % 3), true}});
+        custom_assert(flags->enabled("flag_" + std::to_string(i % 3)), "rebuilt on every set");
+    }
+    custom_assert(replaced.expired(), "replaced sets released");
+    std::cout << "Test 4 passed: rebuilt after loads, clear and remove\n";
+}
+
+void test_interning()
+{
+    std::cout << "Starting interning tests\n";
+
+    using namespace config;
+
+    auto interner = std::make_shared<ValueInterner>();
+    nlohmann::json limits = nlohmann::json::object();
+    for (int i = 0; i < 32; ++i)
+    {
+        limits["route_" + std::to_string(i)] = {{"rps", 100 + i}, {"burst", 200}};
+    }
+    Config tenant_a;
+    Config tenant_b;
+    tenant_a.enable_interning(interner);
+    tenant_b.enable_interning(interner);
+    tenant_a.set("limits", limits);
+    tenant_b.set("limits", limits);
+    tenant_a.set("name", "a");
+
+    // Test 1: Identical large values are stored once and still read normally
+    InternStats stats = interner->stats();
+    custom_assert(stats.values == 1 && stats.references == 2 && stats.hits == 1, "one shared value");
+    custom_assert(stats.saved_bytes == stats.unique_bytes && stats.saved_bytes > 0, "bytes saved reported");
+    custom_assert(tenant_a.is_shared("limits") && !tenant_a.is_shared("name"), "small values stay unshared");
+    custom_assert(tenant_b.get("limits") == limits && tenant_b.query("/limits/route_3/rps").at(0) == 103, "shared value readable");
+    custom_assert(tenant_a.keys_with_prefix("li") == std::vector<std::string>{"limits"}, "shared key indexed");
+    custom_assert(tenant_a.memory_usage().value_bytes < tenant_b.memory_usage().value_bytes + stats.unique_bytes / 2, "usage amortized");
+    std::cout << "Test 1 passed: " << stats.saved_bytes << " bytes saved\n";
+
+    // Test 2: Writing one instance leaves the other's value untouched
+    nlohmann::json changed = limits;
+    changed["route_0"]["rps"] = 1;
+    tenant_a.set("limits", changed);
+    custom_assert(tenant_b.get("limits") == limits && tenant_a.get("limits") == changed, "copy on write");
+    custom_assert(interner->stats().saved_bytes == 0 && interner->stats().values == 2, "nothing shared after diverging");
+    tenant_a.set("limits", limits);
+    custom_assert(interner->stats().references == 2 && interner->stats().saved_bytes > 0, "shared again");
+    std::cout << "Test 2 passed: copy on write\n";
+
+    // Test 3: Values loaded before enabling are interned, erased values are released
+    Config late;
+    late.set("limits", limits);
+    late.enable_interning(interner);
+    custom_assert(late.is_shared("limits") && interner->stats().references == 3, "existing values interned");
+    late.remove("limits");
+    tenant_a.clear();
+    tenant_b.disable_interning();
+    tenant_b.set("limits", changed);
+    interner->prune();
+    custom_assert(!tenant_b.is_shared("limits") && interner->stats().values == 0, "released values pruned");
+    std::cout << "Test 3 passed: enable after load and release\n";
+
+    // Test 4: Overwriting indexed keys with interned or promoted values keeps the index valid
+    Config indexed;
+    indexed.set("route.a", 1);
+    indexed.set("route.b", 2);
+    custom_assert(indexed.keys_with_prefix("route.").size() == 2, "index built");
+    indexed.enable_interning(interner);
+    indexed.set("route.a", limits);
+    custom_assert(indexed.is_shared("route.a"), "plain value replaced by an interned one");
+    indexed.set_array_promotion_threshold(16);
+    nlohmann::json large = nlohmann::json::array();
+    for (int i = 0; i < 64; ++i)
+    {
+        large.push_back(i);
+    }
+    indexed.set("route.a", large);
+    indexed.set("route.b", large);
+    custom_assert(indexed.keys_with_prefix("route.") == std::vector<std::string>({"route.a", "route.b"}), "index intact after overwrites");
+    custom_assert(indexed.get("route.a") == large && indexed.get("route.b") == large, "overwritten values readable");
+    std::cout << "Test 4 passed: index survives interned and columnar overwrites\n";
+
+    // Test 5: Environment overrides replace plain, shared and columnar keys alike
+    setenv("route.a", "from_env_a", 1);
+    setenv("route.b", "from_env_b", 1);
+    indexed.set("route.a", limits);
+    indexed.load_from_env();
+    unsetenv("route.a");
+    unsetenv("route.b");
+    custom_assert(indexed.get("route.a") == "from_env_a" && indexed.get("route.b") == "from_env_b", "overrides applied");
+    custom_assert(!indexed.is_shared("route.a") && !indexed.is_columnar("route.b"), "side maps left behind");
+    custom_assert(indexed.keys_with_prefix("route.") == std::vector<std::string>({"route.a", "route.b"}), "index intact after overrides");
+    indexed.define_derived("route.limits", {"route.b"}, [&limits](const DerivedInputs &) { return limits; });
+    custom_assert(indexed.is_shared("route.limits"), "derived value interned");
+    int rewrites = 0;
+    indexed.add_change_listener([&rewrites](const std::string &key, const nlohmann::json &) { rewrites += key == "route.limits" ? 1 : 0; });
+    setenv("route.limits", "from_env", 1);
+    indexed.load_from_env();
+    unsetenv("route.limits");
+    custom_assert(rewrites == 0 && indexed.get("route.limits") == limits, "shared derived key not overridden");
+    std::cout << "Test 5 passed: environment overrides side-map keys\n";
+}
+
+void test_lazy_loading()
+{
+    std::cout << "Starting lazy loading tests\n";
+
+    using namespace config;
+
+    {
+        std::ofstream file("config_lazy.json");
+        file << "{\n  \"db\": {\"host\": \"db.internal\", \"ports\": [5432, 5433], \"note\": \"} not a brace\"},\n"
+             << "  \"name\": \"lazy\",\n  \"esc\\\"aped\": true,\n  \"broken\": [1, tru],\n  \"name\": \"last\"\n}\n";
+    }
+    Config config;
+    config.set_lazy_loading(true);
+    IoResult result = config.load_from_file("config_lazy.json");
+
+    // Test 1: Loading only records slices; values are parsed on first read
+    custom_assert(result.ok() && result.keys == 5, "lazy load succeeded");
+    custom_assert(config.is_lazy("db") && config.is_lazy("name") && config.is_lazy("esc\"aped"), "nothing parsed yet");
+    custom_assert(config.get("db")["ports"][1] == 5433 && config.get("db")["note"] == "} not a brace", "value parsed on read");
+    custom_assert(!config.is_lazy("db") && config.is_lazy("name"), "only the read key parsed");
+    custom_assert(config.get("name") == "last" && config.get("esc\"aped") == true, "duplicates and escaped keys");
+    custom_assert(config.query("/db/host").at(0) == "db.internal" && config.exists("broken"), "query and exists");
+    std::cout << "Test 1 passed: parsed on first read\n";
+
+    // Test 2: Malformed values surface when read; writes replace slices
+    bool threw = false;
+    try
+    {
+        config.get("broken");
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    custom_assert(threw && config.is_lazy("broken"), "malformed value reported on read");
+    config.set("broken", 1);
+    custom_assert(config.get("broken") == 1 && !config.is_lazy("broken"), "write replaces slice");
+    custom_assert(config.keys_with_prefix("") == std::vector<std::string>({"broken", "db", "esc\"aped", "name"}), "lazy keys indexed");
+    std::cout << "Test 2 passed: malformed values and writes\n";
+
+    // Test 3: Structural errors fail the load; partial loads only index the requested keys
+    {
+        std::ofstream file("config_lazy_broken.json");
+        file << "{\n  \"a\": 1,\n  \"b\" 2\n}\n";
+    }
+    Config broken;
+    broken.set_lazy_loading(true);
+    IoResult failed = broken.load_from_file("config_lazy_broken.json");
+    custom_assert(failed.error == IoError::PARSE_FAILED && failed.line == 3, "structural error located");
+    Config partial;
+    partial.set_lazy_loading(true);
+    partial.load_partial_from_file("config_lazy.json", {"db"});
+    custom_assert(partial.is_lazy("db") && !partial.exists("name"), "partial lazy load");
+    std::cout << "Test 3 passed: structural errors and partial loads\n";
+
+    // Test 4: Saving over the lazy source or truncating it leaves unparsed keys readable
+    Config source;
+    Config reader;
+    source.set_lazy_loading(true);
+    reader.set_lazy_loading(true);
+    source.load_partial_from_file("config_lazy.json", {"db", "name"});
+    reader.load_partial_from_file("config_lazy.json", {"db", "name"});
+    IoResult saved = source.save_to_file("config_lazy.json");
+    custom_assert(saved.ok() && saved.keys == 2 && source.get("name") == "last", "saved over the lazy source");
+    std::ofstream("config_lazy.json", std::ios::trunc).close();
+    custom_assert(reader.is_lazy("name") && reader.get("name") == "last" && reader.get("db")["ports"][0] == 5432, "unparsed keys survive truncation");
+    IoResult unsupported = source.save_to_file("config_lazy.txt");
+    custom_assert(unsupported.error == IoError::UNSUPPORTED_FORMAT && !std::ifstream("config_lazy.txt").is_open(), "unsupported extension creates no file");
+    std::cout << "Test 4 passed: saves and rewrites of the source\n";
+}
+
+void test_memory_budget()
+{
+    std::cout << "Starting memory budget tests\n";
+
+    using namespace config;
+
+    // Test 1: Values over the threshold are spilled after the write and reloaded on access
+    Config tiered;
+    MemoryBudget threshold;
+    threshold.spill_threshold = 8192;
+    tiered.set_memory_budget(threshold);
+    std::string certificate(20000, 'c');
+    tiered.set("certificate", certificate);
+    tiered.set("port", 443);
+    custom_assert(tiered.is_spilled("certificate") && !tiered.is_spilled("port"), "large value spilled");
+    SpillStats stats = tiered.spill_stats();
+    custom_assert(stats.spills == 1 && stats.spilled_values == 1 && stats.spill_file_bytes >= certificate.size(), "spill recorded");
+    custom_assert(tiered.get("certificate") == certificate && !tiered.is_spilled("certificate"), "reloaded on access");
+    custom_assert(tiered.spill_stats().reloads == 1 && tiered.spill_stats().resident_bytes >= certificate.size(), "reload counted");
+    tiered.enforce_memory_budget();
+    custom_assert(tiered.is_spilled("certificate") && tiered.spill_stats().spills == 1, "re-evicted without rewriting");
+    std::cout << "Test 1 passed: threshold spills\n";
+
+    // Test 2: Over budget, the least recently used values go first
+    Config bounded;
+    MemoryBudget budget;
+    budget.resident_bytes = 6000;
+    bounded.set_memory_budget(budget);
+    std::vector<std::string> values;
+    for (int i = 0; i < 10; ++i)
+    {
+        values.push_back(std::string(1500, static_cast<char>('a' + i)));
+        bounded.set("table_" + std::to_string(i), values.back());
+    }
+    custom_assert(bounded.get("table_0") == values[0], "spilled value readable");
+    bounded.set("table_10", std::string(1500, 'z'));
+    custom_assert(bounded.spill_stats().resident_bytes <= budget.resident_bytes, "within budget");
+    custom_assert(!bounded.is_spilled("table_0") && !bounded.is_spilled("table_10") && bounded.is_spilled("table_1"), "coldest evicted");
+    custom_assert(bounded.get_all().size() == 11 && bounded.keys_with_prefix("table_").size() == 11, "all keys visible");
+    bounded.set("table_1", 1);
+    custom_assert(!bounded.is_spilled("table_1") && bounded.get("table_1") == 1, "write replaces spilled value");
+    std::cout << "Test 2 passed: LRU eviction under budget\n";
+
+    // Test 3: Turning the budget off stops eviction; spilled values stay readable
+    bounded.set_memory_budget(MemoryBudget{});
+    bounded.set("table_11", std::string(50000, 'y'));
+    custom_assert(!bounded.is_spilled("table_11") && bounded.get("table_2") == values[2], "budget off");
+    std::cout << "Test 3 passed: budget disabled\n";
+
+    // Test 4: Small values over budget skip the pass until something spillable arrives; sizes stay exact
+    Config small;
+    MemoryBudget tight;
+    tight.resident_bytes = 2000;
+    small.set_memory_budget(tight);
+    for (int i = 0; i < 100; ++i)
+    {
+        small.set("small_" + std::to_string(i), std::string(100, 's'));
+    }
+    std::size_t over = small.spill_stats().resident_bytes;
+    custom_assert(over > tight.resident_bytes && small.spill_stats().passes == 0, "nothing spillable");
+    small.set("large", std::string(5000, 'l'));
+    custom_assert(small.is_spilled("large") && !small.is_lazy("large") && small.spill_stats().resident_bytes == over, "spillable value evicted");
+    for (int i = 0; i < 100; ++i)
+    {
+        small.remove("small_" + std::to_string(i));
+    }
+    custom_assert(small.get("large").get<std::string>().size() == 5000 && small.spill_stats().resident_bytes > 5000, "reload counted");
+    small.remove("large");
+    custom_assert(small.spill_stats().resident_bytes == 0, "erased values subtracted");
+    std::cout << "Test 4 passed: incremental sizes and blocked passes\n";
+
+    // Test 5: Spill writes run outside the lock; readers and writers racing them see whole values
+    Config racing;
+    racing.set_memory_budget(threshold);
+    for (int i = 0; i < 4; ++i)
+    {
+        racing.set("blob_" + std::to_string(i), std::string(10000, 'a'));
+    }
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&] {
+        while (!done.load())
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                torn += racing.get("blob_" + std::to_string(i)).get<std::string>().size() == 10000 ? 0 : 1;
+            }
+        }
+    });
+    for (int round = 0; round < 50; ++round)
+    {
+        racing.set("blob_" + std::to_string(round % 4), std::string(10000, static_cast<char>('a' + round % 26)));
+    }
+    done = true;
+    reader.join();
+    custom_assert(torn == 0 && racing.get("blob_1") == std::string(10000, static_cast<char>('a' + 49 % 26)), "last write wins");
+    racing.enforce_memory_budget(); // The reader's last gets reloaded some blobs
+    custom_assert(racing.is_spilled("blob_0") && !racing.is_shared("blob_0"), "spilled, not left parked");
+    MemoryBudget unwritable = threshold;
+    unwritable.directory = "/nonexistent_spill_directory";
+    Config failing;
+    failing.set_memory_budget(unwritable);
+    failing.set("blob", certificate);
+    custom_assert(!failing.is_spilled("blob") && !failing.is_shared("blob") && failing.get("blob") == certificate, "failed write restores");
+    std::cout << "Test 5 passed: spills written outside the lock\n";
+}
+
+void test_move_semantics()
+{
+    using namespace config;
+
+    std::cout << "Starting move semantics tests\n";
+
+    auto stored_data = [](const Config &config, const std::string &pointer) {
+        const char *data = nullptr;
+        config.query_each(CompiledQuery(pointer), [&data](const nlohmann::json &node) { data = node.get_ref<const std::string &>().data(); });
+        return data;
+    };
+
+    // Test 1: Rvalue set and emplace store the caller's buffers without copying them
+    Config config;
+    nlohmann::json certificate = std::string(4096, 'c');
+    const char *buffer = certificate.get_ref<const std::string &>().data();
+    std::string seen;
+    config.add_change_listener([&seen](const std::string &, const nlohmann::json &value) { seen = value.dump().substr(0, 3); });
+    config.set("certificate", std::move(certificate));
+    custom_assert(stored_data(config, "/certificate") == buffer && certificate.is_null(), "set moved the value");
+    custom_assert(seen == "\"cc", "listener sees stored value");
+    std::string pem(2048, 'p');
+    const char *pem_buffer = pem.data();
+    config.emplace("pem", std::move(pem));
+    custom_assert(stored_data(config, "/pem") == pem_buffer, "emplace moved the string");
+    std::cout << "Test 1 passed: set and emplace move\n";
+
+    // Test 2: update_multiple and create_config_with_defaults move rvalue maps
+    std::unordered_map<std::string, nlohmann::json> batch = {{"template", std::string(1024, 't')}};
+    const char *template_buffer = batch["template"].get_ref<const std::string &>().data();
+    config.update_multiple(std::move(batch));
+    custom_assert(stored_data(config, "/template") == template_buffer, "update_multiple moved");
+    std::unordered_map<std::string, nlohmann::json> defaults = {{"banner", std::string(1024, 'b')}};
+    const char *banner_buffer = defaults["banner"].get_ref<const std::string &>().data();
+    auto created = ConfigFactory::create_config_with_defaults("move_defaults", std::move(defaults));
+    custom_assert(stored_data(*created, "/banner") == banner_buffer, "defaults moved");
+    nlohmann::json kept = {{"a", 1}};
+    config.set("kept", kept);
+    custom_assert(kept == nlohmann::json({{"a", 1}}) && config.get("kept") == kept, "lvalue set still copies");
+    std::cout << "Test 2 passed: batch moves\n";
+}
+
+void test_capacity()
+{
+    using namespace config;
+
+    std::cout << "Starting capacity tests\n";
+
+    // Test 1: reserve sizes the table once; inserts up to that count do not rehash
+    Config config;
+    config.reserve(10000);
+    std::size_t reserved = config.bucket_count();
+    for (int i = 0; i < 10000; ++i)
+    {
+        config.set("key_" + std::to_string(i), i);
+    }
+    custom_assert(reserved >= 10000 && config.bucket_count() == reserved, "no rehash after reserve");
+    std::cout << "Test 1 passed: reserve\n";
+
+    // Test 2: shrink_to_fit releases buckets after bulk removals
+    for (int i = 1; i < 10000; ++i)
+    {
+        config.remove("key_" + std::to_string(i));
+    }
+    config.shrink_to_fit();
+    custom_assert(config.bucket_count() < 100 && config.get("key_0") == 0, "buckets released");
+    std::cout << "Test 2 passed: shrink_to_fit\n";
+
+    // Test 3: Loads reserve for the whole document before inserting
+    {
+        nlohmann::json document = nlohmann::json::object();
+        for (int i = 0; i < 3000; ++i)
+        {
+            document["key_" + std::to_string(i)] = i;
+        }
+        std::ofstream file("config_capacity.json");
+        file << document.dump();
+    }
+    Config loaded;
+    custom_assert(loaded.load_from_file("config_capacity.json").ok(), "load succeeded");
+    std::unordered_map<std::string, nlohmann::json> expected;
+    expected.reserve(3000); // Growing one insert at a time would end at 5087 buckets
+    custom_assert(loaded.bucket_count() == expected.bucket_count(), "sized in one step");
+    std::cout << "Test 3 passed: loads pre-size the table\n";
+}
+
+void test_async_io()
+{
+    using namespace config;
+
+    std::cout << "Starting async I/O tests\n";
+
+    // Test 1: async_save and async_load round-trip through futures
+    Config source;
+    source.set("service", {{"port", 8080}});
+    IoResult saved = async_save(source, "config_async.json").get();
+    custom_assert(saved.ok() && saved.bytes > 0, "async save succeeded");
+    Config target;
+    IoResult loaded = async_load(target, "config_async.json").get();
+    custom_assert(loaded.ok() && target.get("service")["port"] == 8080, "async load succeeded");
+    custom_assert(!async_load(target, "config_async_missing.json").get().ok(), "errors are reported");
+    std::cout << "Test 1 passed: futures\n";
+
+    // Test 2: Queued requests start by priority, FIFO within a priority
+    auto executor = std::make_shared<ThreadPoolExecutor>(1);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::promise<void> blocked;
+    executor->submit(AsyncPriority::NORMAL, [opened, &blocked] {
+        blocked.set_value();
+        opened.wait();
+    });
+    blocked.get_future().wait(); // The only worker is now busy
+    std::vector<std::string> order;
+    std::mutex order_mutex;
+    auto record = [&order, &order_mutex](const std::string &name) {
+        return [&order, &order_mutex, name](const IoResult &) {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(name);
+        };
+    };
+    async_load(target, "config_async.json", record("low"), AsyncOptions{AsyncPriority::LOW, nullptr, executor});
+    async_load(target, "config_async.json", record("normal_1"), AsyncOptions{AsyncPriority::NORMAL, nullptr, executor});
+    async_load(target, "config_async.json", record("high"), AsyncOptions{AsyncPriority::HIGH, nullptr, executor});
+    async_load(target, "config_async.json", record("normal_2"), AsyncOptions{AsyncPriority::NORMAL, nullptr, executor});
+    custom_assert(executor->pending() == 4, "requests queued behind the gate");
+
+    // Test 3: Cancelling a queued request skips the operation
+    auto cancel = std::make_shared<CancellationToken>();
+    Config untouched;
+    std::future<IoResult> cancelled = async_load(untouched, "config_async.json", AsyncOptions{AsyncPriority::HIGH, cancel, executor});
+    cancel->cancel();
+    gate.set_value();
+    IoResult skipped = cancelled.get();
+    custom_assert(skipped.error == IoError::CANCELLED && !untouched.exists("service"), "cancelled request did not run");
+    executor.reset(); // Drains the queue and joins
+    custom_assert((order == std::vector<std::string>{"high", "normal_1", "normal_2", "low"}), "priority order");
+    std::cout << "Test 2 passed: priorities\n";
+    std::cout << "Test 3 passed: cancellation\n";
+
+    // Test 4: async_backup reports the written size through a completion handler
+    std::promise<IoResult> backed_up;
+    async_backup(source, "config_async_backup.json", [&backed_up](const IoResult &result) { backed_up.set_value(result); });
+    IoResult backup = backed_up.get_future().get();
+    custom_assert(backup.ok() && backup.bytes > 0 && backup.keys == 1, "backup written");
+    IoResult failed = async_backup(source, "config_async_missing_dir/backup.json").get();
+    custom_assert(failed.error == IoError::OPEN_FAILED, "backup failure forwarded");
+    std::cout << "Test 4 passed: backup\n";
+
+    // Test 5: A handler throwing something other than std::exception does not take the worker down
+    std::promise<void> thrown;
+    async_load(target, "config_async.json", [&thrown](const IoResult &) {
+        thrown.set_value();
+        throw 42;
+    });
+    thrown.get_future().wait();
+    custom_assert(async_load(target, "config_async.json").get().ok(), "executor still runs after a throwing handler");
+    std::cout << "Test 5 passed: handler exceptions contained\n";
+}
+
+void test_batch_loading()
+{
+    using namespace config;
+
+    std::cout << "Starting batch loading tests\n";
+
+    std::vector<std::string> paths = {"config_batch_1.json", "config_batch_2.yaml", "config_batch_missing.json", "config_batch_3.json",
+                                      "config_batch_broken.json"};
+    std::ofstream("config_batch_1.json") << R"({"a": 1, "shared": "first"})";
+    std::ofstream("config_batch_2.yaml") << "b: 2\nshared: second\n";
+    std::ofstream("config_batch_3.json") << R"({"c": [1, 2, 3], "text": ")" << std::string(100000, 'x') << R"("})";
+    std::ofstream("config_batch_broken.json") << R"({"d": )";
+
+    // Test 1: Every file gets its own result; later files override earlier ones
+    Config config;
+    BatchReadStats stats;
+    std::vector<IoResult> results = config.load_from_files(paths, BatchLoadOptions{}, &stats);
+    custom_assert(results.size() == 5 && results[0].ok() && results[1].ok() && results[3].ok(), "good files loaded");
+    custom_assert(results[2].error == IoError::OPEN_FAILED && results[4].error == IoError::PARSE_FAILED, "failures reported per file");
+    custom_assert(config.get("a") == 1 && config.get("b") == 2 && config.get("shared") == "second", "values merged in order");
+    custom_assert(config.get("c")[2] == 3 && !config.exists("d") && results[3].keys == 2, "large file read whole");
+    custom_assert(stats.files == 5 && stats.bytes == results[0].bytes + results[1].bytes + results[3].bytes + results[4].bytes, "stats");
+    std::cout << "Test 1 passed: multi-file load\n";
+
+    // Test 2: Both backends, with and without registered buffers, load the same thing
+    auto load_with = [&paths](BatchLoadOptions options, BatchReadStats &stats) {
+        Config loaded;
+        loaded.load_from_files(paths, options, &stats);
+        return loaded.get_all();
+    };
+    BatchReadStats posix_stats, uring_stats, plain_stats;
+    auto posix = load_with(BatchLoadOptions{FileIoBackend::POSIX, true, 1}, posix_stats);
+    auto uring = load_with(BatchLoadOptions{FileIoBackend::IO_URING, true, 2}, uring_stats);
+    auto plain = load_with(BatchLoadOptions{FileIoBackend::IO_URING, false, 0}, plain_stats);
+    custom_assert(posix == config.get_all() && uring == posix && plain == posix, "backends agree");
+    custom_assert(posix_stats.backend == FileIoBackend::POSIX && !posix_stats.registered_buffers, "posix backend used");
+    if (uring_stats.backend == FileIoBackend::IO_URING)
+    {
+        custom_assert(uring_stats.syscalls < posix_stats.syscalls && !plain_stats.registered_buffers, "io_uring batches system calls");
+    }
+    std::cout << "Test 2 passed: backends (" << file_io_backend_to_string(uring_stats.backend) << ")\n";
+
+    // Test 3: Files without a known size are read to the end
+    std::ifstream cmdline("/proc/self/cmdline", std::ios::binary);
+    std::string expected((std::istreambuf_iterator<char>(cmdline)), std::istreambuf_iterator<char>());
+    for (FileIoBackend backend : {FileIoBackend::POSIX, FileIoBackend::IO_URING})
+    {
+        std::vector<FileBuffer> files = read_files({"/proc/self/cmdline", "config_batch_missing.json"}, BatchLoadOptions{backend, true, 0});
+        custom_assert(files[0].error == 0 && files[0].contents == expected, "proc file read");
+        custom_assert(!files[1].opened && files[1].error == ENOENT, "missing file errno");
+    }
+    // Procfs files report size 0 and return a page per read; larger ones must not stop at the first page
+    std::ifstream symbols("/proc/kallsyms", std::ios::binary);
+    std::string whole((std::istreambuf_iterator<char>(symbols)), std::istreambuf_iterator<char>());
+    if (whole.size() > 4096)
+    {
+        for (FileIoBackend backend : {FileIoBackend::POSIX, FileIoBackend::IO_URING})
+        {
+            std::vector<FileBuffer> files = read_files({"/proc/kallsyms"}, BatchLoadOptions{backend, false, 0});
+            custom_assert(files[0].error == 0 && files[0].contents.size() > 4096, "multi-page proc file read whole");
+        }
+    }
+    std::cout << "Test 3 passed: unsized files\n";
+
+    // Test 4: With lazy loading on, JSON files are read into private copies and scanned
+    Config lazy;
+    lazy.set_lazy_loading(true);
+    results = lazy.load_from_files(paths);
+    custom_assert(results[0].ok() && lazy.is_lazy("a") && !lazy.is_lazy("b") && lazy.get("shared") == "second", "lazy batch load");
+    std::cout << "Test 4 passed: lazy batch load\n";
+
+    // Test 5: Results carry their own file's times, and the stats say which backend read how many files
+    for (FileIoBackend backend : {FileIoBackend::POSIX, FileIoBackend::IO_URING})
+    {
+        Config timed;
+        BatchReadStats batch;
+        results = timed.load_from_files(paths, BatchLoadOptions{backend, false, 1}, &batch);
+        std::chrono::nanoseconds open{0};
+        std::chrono::nanoseconds read{0};
+        for (const IoResult &result : results)
+        {
+            open += result.timings.open;
+            read += result.timings.read;
+        }
+        if (batch.backend == FileIoBackend::POSIX)
+        {
+            custom_assert(batch.uring_files < batch.files && results[3].timings.read > std::chrono::nanoseconds(0), "posix timings per file");
+            custom_assert(batch.uring_files != 0 || (open == batch.open && read == batch.read), "per-file times add up");
+        }
+        else
+        {
+            custom_assert(batch.uring_files == batch.files && open.count() == 0 && read.count() == 0, "no per-file times for io_uring");
+        }
+    }
+    std::cout << "Test 5 passed: per-file timings\n";
+}
+
 int main()
 {
     test_configuration();
     test_configfactory();
+    test_io_results();
+    test_metrics();
+    test_profiler();
+    test_tracing();
+    test_memory_usage();
+    test_workload_replay();
+    test_typed_reads();
+    test_columnar_arrays();
+    test_query();
+    test_key_index();
+    test_find_keys();
+    test_interpolation();
+    test_derived_keys();
+    test_feature_flags();
+    test_interning();
+    test_lazy_loading();
+    test_memory_budget();
+    test_move_semantics();
+    test_capacity();
+    test_async_io();
+    test_batch_loading();
     return 0;
 }
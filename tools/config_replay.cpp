@@ -0,0 +1,136 @@
+/*  File: config_replay.cpp
+
+    * External Dependencies:
+    * - nlohmann/json
+    * - yaml-cpp
+    *
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Workload replay tool.
+    * Re-runs a recording made with WorkloadRecorder (see config_workload.hpp) against a fresh Config,
+    * one thread per recorded thread, and prints per-operation timings.
+    *
+    * Usage: config_replay <recording> [--preserve-timing] [--speed 1.0] [--skip-loads] [--no-seed]
+    *                      [--repeat 1] [--json]
+    *
+    * By default operations run as fast as possible; --preserve-timing waits for each recorded
+    * timestamp (divided by --speed). Keys that were read successfully are seeded with values of
+    * their recorded size first, so reads hit as they did in production.
+    *
+*/
+
+#include "../include/configuration.hpp"
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    void print_usage()
+    {
+        std::cerr << "Usage: config_replay <recording> [--preserve-timing] [--speed 1.0] [--skip-loads] [--no-seed]\n"
+                  << "                     [--repeat 1] [--json]\n";
+    }
+
+    double per_op_ns(std::chrono::nanoseconds total, std::uint64_t count)
+    {
+        return count == 0 ? 0.0 : static_cast<double>(total.count()) / static_cast<double>(count);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string path;
+    config::ReplayOptions options;
+    unsigned repeat = 1;
+    bool json = false;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--preserve-timing")
+            {
+                options.preserve_timing = true;
+            }
+            else if (arg == "--speed" && i + 1 < argc)
+            {
+                options.speed = std::stod(argv[++i]);
+                if (options.speed <= 0.0)
+                {
+                    throw std::invalid_argument("--speed must be positive");
+                }
+            }
+            else if (arg == "--skip-loads")
+            {
+                options.replay_loads = false;
+            }
+            else if (arg == "--no-seed")
+            {
+                options.seed = false;
+            }
+            else if (arg == "--repeat" && i + 1 < argc)
+            {
+                repeat = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i])));
+            }
+            else if (arg == "--json")
+            {
+                json = true;
+            }
+            else if (path.empty() && arg.rfind("--", 0) != 0)
+            {
+                path = arg;
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+        if (path.empty())
+        {
+            throw std::invalid_argument("A recording is required");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        print_usage();
+        return 1;
+    }
+
+    std::vector<config::WorkloadOp> ops;
+    std::string error;
+    if (!config::read_workload(path, ops, &error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    nlohmann::json runs = nlohmann::json::array();
+    for (unsigned run = 0; run < repeat; ++run)
+    {
+        config::Config storage;
+        config::ReplayResult result = config::replay_workload(ops, storage, options);
+        if (json)
+        {
+            runs.push_back(result.to_json());
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(result.wall).count();
+        std::cout << "run " << run + 1 << ": " << result.ops << " ops on " << result.threads << " threads in "
+                  << std::fixed << std::setprecision(3) << seconds * 1000.0 << " ms ("
+                  << std::setprecision(0) << (seconds > 0.0 ? static_cast<double>(result.ops) / seconds : 0.0) << " ops/s)\n"
+                  << std::setprecision(1)
+                  << "  get:  " << result.gets << " (" << result.misses << " misses), " << per_op_ns(result.get_time, result.gets) << " ns/op\n"
+                  << "  set:  " << result.sets << ", " << per_op_ns(result.set_time, result.sets) << " ns/op\n"
+                  << "  load: " << result.loads << ", " << per_op_ns(result.load_time, result.loads) << " ns/op\n";
+    }
+    if (json)
+    {
+        std::cout << runs.dump(2) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*  File: gen_config.cpp
+
+    * (c) 2024, Benjamin Gorlick | github.com/bgorlick/config_manager/
+    * Distributed under the Boost Software License, Version 1.0.
+    * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+    *
+    * Synthetic configuration generator.
+    * Writes realistic JSON or YAML configuration files of a given size, key count, depth and
+    * string/number mix, for load benchmarks and startup regression testing.
+    *
+    * Usage: gen_config --out <path> [--format json|yaml] [--size 16MB] [--keys N] [--depth 2]
+    *                   [--fanout 4] [--leaves 8] [--string-ratio 0.5] [--string-length 24] [--seed 42]
+    *
+    * The format defaults to the extension of --out. Sizes accept B, KB, MB and GB suffixes.
+    *
+*/
+
+#include "../bench/config_generator.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    bench::GeneratorOptions options;
+    std::string out_path;
+    bool format_given = false;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            std::string value = argv[++i];
+            if (arg == "--out")
+            {
+                out_path = value;
+            }
+            else if (arg == "--format")
+            {
+                options.format = value == "yaml" || value == "yml" ? bench::GeneratedFormat::YAML : bench::GeneratedFormat::JSON;
+                format_given = true;
+            }
+            else if (arg == "--size")
+            {
+                options.target_bytes = bench::parse_size(value);
+            }
+            else if (arg == "--keys")
+            {
+                options.keys = std::stoull(value);
+            }
+            else if (arg == "--depth")
+            {
+                options.depth = static_cast<unsigned>(std::stoul(value));
+            }
+            else if (arg == "--fanout")
+            {
+                options.fanout = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            }
+            else if (arg == "--leaves")
+            {
+                options.leaves = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            }
+            else if (arg == "--string-ratio")
+            {
+                options.string_ratio = std::stod(value);
+            }
+            else if (arg == "--string-length")
+            {
+                options.string_length = static_cast<unsigned>(std::stoul(value));
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::stoull(value);
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+        if (out_path.empty())
+        {
+            throw std::invalid_argument("--out is required");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: gen_config --out <path> [--format json|yaml] [--size 16MB] [--keys N] [--depth 2]\n"
+                  << "                  [--fanout 4] [--leaves 8] [--string-ratio 0.5] [--string-length 24] [--seed 42]\n";
+        return 1;
+    }
+
+    if (!format_given)
+    {
+        std::string extension = out_path.substr(out_path.find_last_of(".") + 1);
+        options.format = extension == "yaml" || extension == "yml" ? bench::GeneratedFormat::YAML : bench::GeneratedFormat::JSON;
+    }
+
+    std::ofstream out(out_path, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "Failed to open output file for writing: " << out_path << std::endl;
+        return 1;
+    }
+    bench::GeneratorStats stats = bench::generate_config(out, options);
+    std::cout << "Wrote " << out_path << ": " << stats.bytes << " bytes, "
+              << stats.top_level_keys << " top-level keys, " << stats.leaves << " leaves\n";
+    return out ? 0 : 1;
+}